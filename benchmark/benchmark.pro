@@ -0,0 +1,12 @@
+QT -= gui
+QT += serialport
+
+TEMPLATE = app
+TARGET = benchmark
+CONFIG += console
+CONFIG += c++11
+
+include(../qt-serial_communicator.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,185 @@
+#include "pcd/qt-serial_communicator/communicator.h"
+#include "pcd/qt-serial_communicator/emulated_link.h"
+#include "pcd/qt-serial_communicator/latency_histogram.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using namespace serial_communicator;
+
+///
+/// \brief Stores the link and run settings shared by all scenarios.
+///
+struct settings
+{
+    uint32_t baud = 115200;         ///< The emulated baud rate.
+    uint32_t latency = 1000;        ///< The one way latency in microseconds.
+    double bit_error_rate = 0;      ///< The emulated bit error rate.
+    double drop_rate = 0;           ///< The emulated byte drop rate.
+    double burst_enter = 0;         ///< The per byte probability of entering a loss burst.
+    double burst_exit = 0.1;        ///< The per byte probability of leaving a loss burst.
+    uint32_t count = 500;           ///< The number of messages sent per scenario.
+    double timeout = 60;            ///< The maximum duration of a scenario in seconds.
+    uint32_t seed = 1;              ///< The seed of the link's impairment generator.
+};
+
+///
+/// \brief Stores the measured results of one scenario.
+///
+struct results
+{
+    uint32_t sent = 0;              ///< The number of messages accepted by send().
+    uint32_t delivered = 0;         ///< The number of messages taken from the receiver's queue.
+    double elapsed = 0;             ///< The wall time of the scenario in seconds.
+    double cpu = 0;                 ///< The process CPU time of the scenario in seconds.
+    uint64_t payload_bytes = 0;     ///< The number of payload bytes delivered.
+    uint64_t retransmissions = 0;   ///< The number of retransmissions by the sender.
+    uint64_t not_received = 0;      ///< The number of messages the sender gave up on.
+};
+
+uint64_t now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+results run(const settings& settings, uint16_t payload_size, bool receipt_required, bool mixed_priority, latency_histogram& latency_low, latency_histogram& latency_high)
+{
+    results output;
+
+    // Set up the emulated link and a communicator on each end.
+    emulated_link link(settings.seed);
+    link.p_baud(settings.baud);
+    link.p_latency(settings.latency);
+    link.p_bit_error_rate(settings.bit_error_rate);
+    link.p_drop_rate(settings.drop_rate);
+    link.p_burst(settings.burst_enter, settings.burst_exit);
+    communicator sender(link.p_a());
+    communicator receiver(link.p_b());
+
+    std::clock_t cpu_start = std::clock();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last_progress = start;
+    while(output.delivered < settings.count)
+    {
+        // Keep the transmit queue full.
+        while(output.sent < settings.count)
+        {
+            message* outgoing = new message(1, payload_size);
+            outgoing->set_field<uint64_t>(0, now_ns());
+            // Mixed traffic sends every fourth message at the highest priority.
+            if(mixed_priority && output.sent % 4 == 0)
+            {
+                outgoing->p_priority(255);
+            }
+            if(!sender.send(outgoing, receipt_required))
+            {
+                break;
+            }
+            output.sent++;
+        }
+
+        // Run the event loop, blocking until there is work so that CPU time is not spent polling, then drain the receiver.
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        while(message* incoming = receiver.receive())
+        {
+            latency_histogram& latency = incoming->p_priority() > 0 ? latency_high : latency_low;
+            latency.record((now_ns() - incoming->get_field<uint64_t>(0)) / 1000);
+            output.payload_bytes += incoming->p_data_length();
+            output.delivered++;
+            last_progress = std::chrono::steady_clock::now();
+            delete incoming;
+        }
+
+        // Stop once everything has been sent and nothing has arrived for a while, or on timeout.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(output.sent == settings.count && now - last_progress > std::chrono::seconds(2))
+        {
+            break;
+        }
+        if(now - start > std::chrono::duration<double>(settings.timeout))
+        {
+            break;
+        }
+    }
+    // Rates are measured up to the last delivery, excluding the idle wait at the end.
+    output.elapsed = std::chrono::duration<double>(last_progress - start).count();
+    output.cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    statistics sender_statistics = sender.p_statistics();
+    output.retransmissions = sender_statistics.tx_retransmissions;
+    output.not_received = sender_statistics.tx_not_received;
+
+    return output;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication application(argc, argv);
+
+    // Parse arguments.
+    settings settings;
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* option = argv[i];
+        const char* value = argv[i + 1];
+        if(std::strcmp(option, "--baud") == 0) settings.baud = static_cast<uint32_t>(std::atol(value));
+        else if(std::strcmp(option, "--latency") == 0) settings.latency = static_cast<uint32_t>(std::atol(value));
+        else if(std::strcmp(option, "--ber") == 0) settings.bit_error_rate = std::atof(value);
+        else if(std::strcmp(option, "--drop") == 0) settings.drop_rate = std::atof(value);
+        else if(std::strcmp(option, "--burst-enter") == 0) settings.burst_enter = std::atof(value);
+        else if(std::strcmp(option, "--burst-exit") == 0) settings.burst_exit = std::atof(value);
+        else if(std::strcmp(option, "--count") == 0) settings.count = static_cast<uint32_t>(std::atol(value));
+        else if(std::strcmp(option, "--timeout") == 0) settings.timeout = std::atof(value);
+        else if(std::strcmp(option, "--seed") == 0) settings.seed = static_cast<uint32_t>(std::atol(value));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--baud N] [--latency us] [--ber p] [--drop p] [--burst-enter p] [--burst-exit p] [--count N] [--timeout s] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("baud %u, latency %u us, ber %g, drop %g, burst %g/%g, %u messages per scenario\n\n",
+                settings.baud, settings.latency, settings.bit_error_rate, settings.drop_rate, settings.burst_enter, settings.burst_exit, settings.count);
+    std::printf("%8s %8s %9s %9s %9s %11s %12s %10s %10s %12s %8s %8s\n",
+                "payload", "receipt", "priority", "sent", "delivered", "msg/s", "goodput B/s", "p50 us", "p99 us", "cpu us/msg", "retx", "lost");
+
+    // Run every combination of payload size, receipt mode, and priority mix.
+    // Mixed scenarios report the latency of the high and low priority messages on separate rows.
+    const uint16_t payload_sizes[] = {8, 64, 256, 1024};
+    const bool receipt_modes[] = {false, true};
+    const bool priority_mixes[] = {false, true};
+    for(uint16_t payload_size : payload_sizes)
+    {
+        for(bool receipt_required : receipt_modes)
+        {
+            for(bool mixed_priority : priority_mixes)
+            {
+                latency_histogram latency_low;
+                latency_histogram latency_high;
+                results outcome = run(settings, payload_size, receipt_required, mixed_priority, latency_low, latency_high);
+                double elapsed = outcome.elapsed > 0 ? outcome.elapsed : 1e-9;
+                double per_message = outcome.delivered > 0 ? outcome.cpu / outcome.delivered * 1e6 : 0;
+                std::printf("%8u %8s %9s %9u %9u %11.1f %12.1f %10llu %10llu %12.1f %8llu %8llu\n",
+                            payload_size, receipt_required ? "yes" : "no", mixed_priority ? "low" : "uniform", outcome.sent, outcome.delivered,
+                            outcome.delivered / elapsed, outcome.payload_bytes / elapsed,
+                            static_cast<unsigned long long>(latency_low.percentile(50)), static_cast<unsigned long long>(latency_low.percentile(99)),
+                            per_message, static_cast<unsigned long long>(outcome.retransmissions), static_cast<unsigned long long>(outcome.not_received));
+                if(mixed_priority)
+                {
+                    std::printf("%8s %8s %9s %9s %9s %11s %12s %10llu %10llu %12s %8s %8s\n",
+                                "", "", "high", "", "", "", "",
+                                static_cast<unsigned long long>(latency_high.percentile(50)), static_cast<unsigned long long>(latency_high.percentile(99)),
+                                "", "", "");
+                }
+            }
+        }
+    }
+
+    return 0;
+}
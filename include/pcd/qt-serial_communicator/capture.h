@@ -0,0 +1,121 @@
+/// \file capture.h
+/// \brief Defines the serial_communicator::capture class.
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace serial_communicator {
+///
+/// \brief Records the raw serial byte stream of a communicator to a capture file.
+/// \details A capture file begins with an 8 byte file header of "SCCP", a 16 bit version, and 16
+/// reserved bits.  It is followed by records of a 1 byte direction, a varint nanosecond delta from
+/// the previous record, a varint length, and the raw bytes.  Records are encoded into a memory
+/// buffer by the calling thread and written to disk by a background thread, so recording never
+/// waits on file I/O.
+///
+class capture
+{
+public:
+    // ENUMERATIONS
+    ///
+    /// \brief Enumerates the directions of captured data.
+    ///
+    enum class direction
+    {
+        RX = 0,     ///< Bytes read from the serial port.
+        TX = 1      ///< Bytes written to the serial port.
+    };
+
+    // CONSTRUCTORS
+    ///
+    /// \brief capture Creates a new capture that writes to the specified file.
+    /// \param path The path of the capture file.  An existing file is overwritten.
+    /// \param max_pending OPTIONAL The maximum number of bytes that may wait for the background writer.
+    /// Records arriving while this many bytes are pending are dropped and counted.
+    ///
+    capture(const std::string& path, uint32_t max_pending = 16777216);
+    ~capture();
+
+    // METHODS
+    ///
+    /// \brief record Records a block of raw serial bytes.
+    /// \param direction The direction the bytes travelled.
+    /// \param data The raw bytes.
+    /// \param length The number of raw bytes.
+    ///
+    void record(direction direction, const uint8_t* data, uint32_t length);
+
+    // PROPERTIES
+    ///
+    /// \brief p_is_open Gets if the capture file was opened successfully.
+    /// \return TRUE if the file is open, otherwise FALSE.
+    ///
+    bool p_is_open() const;
+    ///
+    /// \brief p_dropped Gets the number of records dropped because the background writer fell behind.
+    /// \return The number of dropped records.
+    ///
+    uint64_t p_dropped() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_file Stores the capture file.
+    ///
+    std::FILE* m_file;
+    ///
+    /// \brief m_max_pending Stores the maximum number of bytes that may wait for the background writer.
+    ///
+    uint32_t m_max_pending;
+    ///
+    /// \brief m_pending Stores encoded records waiting for the background writer.
+    ///
+    std::vector<uint8_t> m_pending;
+    ///
+    /// \brief m_last_timestamp Stores the time of the previous record.
+    ///
+    std::chrono::steady_clock::time_point m_last_timestamp;
+    ///
+    /// \brief m_mutex Protects the pending buffer and timestamp.
+    ///
+    std::mutex m_mutex;
+    ///
+    /// \brief m_condition Wakes the background writer when records are pending.
+    ///
+    std::condition_variable m_condition;
+    ///
+    /// \brief m_stop Instructs the background writer to flush and exit.
+    ///
+    bool m_stop;
+    ///
+    /// \brief m_dropped Stores the number of records dropped.
+    ///
+    std::atomic<uint64_t> m_dropped;
+    ///
+    /// \brief m_writer The background writer thread.
+    ///
+    std::thread m_writer;
+
+    // METHODS
+    ///
+    /// \brief write_varint Appends a varint to the pending buffer.
+    /// \param value The value to append.
+    ///
+    void write_varint(uint64_t value);
+    ///
+    /// \brief writer Runs the background writer loop.
+    ///
+    void writer();
+};
+}
+
+#endif // CAPTURE_H
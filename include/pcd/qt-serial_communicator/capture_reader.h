@@ -0,0 +1,65 @@
+/// \file capture_reader.h
+/// \brief Defines the serial_communicator::capture_reader class.
+#ifndef CAPTURE_READER_H
+#define CAPTURE_READER_H
+
+#include "capture.h"
+
+namespace serial_communicator {
+///
+/// \brief Reads the records of a capture file written by serial_communicator::capture.
+///
+class capture_reader
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief capture_reader Opens a capture file for reading.
+    /// \param path The path of the capture file.
+    ///
+    capture_reader(const std::string& path);
+    ~capture_reader();
+
+    // METHODS
+    ///
+    /// \brief next Reads the next record in the file.
+    /// \param direction The direction of the record's bytes.
+    /// \param timestamp_ns The time of the record in nanoseconds since the first record.
+    /// \param data The record's raw bytes.
+    /// \return TRUE if a record was read, or FALSE at the end of the file.
+    ///
+    bool next(capture::direction& direction, uint64_t& timestamp_ns, std::vector<uint8_t>& data);
+
+    // PROPERTIES
+    ///
+    /// \brief p_is_open Gets if the capture file was opened and has a valid file header.
+    /// \return TRUE if the file is readable, otherwise FALSE.
+    ///
+    bool p_is_open() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_file Stores the capture file.
+    ///
+    std::FILE* m_file;
+    ///
+    /// \brief m_timestamp Stores the accumulated time of the most recently read record.
+    ///
+    uint64_t m_timestamp;
+    ///
+    /// \brief m_first Indicates if the next record is the first in the file.
+    ///
+    bool m_first;
+
+    // METHODS
+    ///
+    /// \brief read_varint Reads a varint from the file.
+    /// \param value The value read.
+    /// \return TRUE if a complete varint was read, otherwise FALSE.
+    ///
+    bool read_varint(uint64_t& value);
+};
+}
+
+#endif // CAPTURE_READER_H
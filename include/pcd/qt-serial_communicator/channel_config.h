@@ -0,0 +1,25 @@
+/// \file channel_config.h
+/// \brief Defines the serial_communicator::channel_config structure.
+#ifndef CHANNEL_CONFIG_H
+#define CHANNEL_CONFIG_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+///
+/// \brief The settings of one logical channel of a communicator.
+/// \details Fields left at 0 use the communicator's own setting, so a default channel_config
+/// behaves exactly like a communicator without channels.
+///
+struct channel_config
+{
+    uint16_t queue_size = 0;            ///< The channel's transmit and receive queue size in messages, used in FIXED queue mode.
+    uint32_t queue_memory_limit = 0;    ///< The channel's transmit and receive queue limit in bytes, used in ELASTIC queue mode.
+    uint32_t receipt_timeout = 0;       ///< The time to wait for a receipt before retransmitting, in milliseconds.
+    uint8_t max_transmissions = 0;      ///< The maximum number of transmissions of a receipt-required message.
+    uint16_t window = 0;                ///< The maximum number of receipt-required messages awaiting a receipt at once, or 0 for no limit.
+    uint16_t weight = 1;                ///< The channel's share of the link relative to other busy channels.  The minimum is 1.
+};
+}
+
+#endif // CHANNEL_CONFIG_H
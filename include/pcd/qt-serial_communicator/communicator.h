@@ -3,16 +3,33 @@
 #ifndef COMMUNICATOR_H
 #define COMMUNICATOR_H
 
+#include "capture.h"
+#include "channel_config.h"
 #include "message.h"
 #include "message_status.h"
-#include "utility/outbound.h"
-#include "utility/inbound.h"
+#include "overflow_policy.h"
+#include "queue_mode.h"
+#include "delivery.h"
+#include "decode_pool.h"
+#include "reply.h"
+#include "spool.h"
+#include "statistics.h"
+#include "latency_histogram.h"
+#include "latency_metric.h"
+#include "link_quality.h"
+#include "utility/protocol_engine.h"
 
 #include <QObject>
 #include <QTimer>
+#include <QIODevice>
 #include <QtSerialPort/QSerialPort>
 
-#include <deque>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 ///
 /// \brief Includes all software for implementing the serial_communicator.
@@ -20,6 +37,8 @@
 namespace serial_communicator {
 ///
 /// \brief A communicator for transmitting and receiving messages via serial.
+/// \details The protocol itself runs in a utility::protocol_engine, which does not depend on Qt.  The
+/// communicator connects the engine to a QIODevice, polls it from Qt timers, and publishes its events as signals.
 ///
 class communicator
     : public QObject
@@ -29,10 +48,12 @@ public:
     // CONSTRUCTORS
     ///
     /// \brief communicator Creates a new communicator instance.
-    /// \param port The serial port to communicate over.
-    /// \param baud The baud rate of the serial connection.
+    /// \param device The open device to communicate over.
+    /// \details Any open, sequential QIODevice may be used as the transport, such as a QSerialPort
+    /// (including a pseudo-terminal), a QTcpSocket, or one end of a serial_communicator::loopback.
+    /// The communicator does not take ownership of the device.
     ///
-    communicator(QSerialPort* serial_port);
+    communicator(QIODevice* device);
     ~communicator();
 
     // METHODS
@@ -44,16 +65,75 @@ public:
     /// \param tracker OPTIONAL A pointer that allows external code to monitor the status of a message in real time.
     /// \return Returns TRUE if the message was successfully placed in the transmit queue, otherwise FALSE.
     /// \details This places a message into the TX queue for sending.  The communicator sends messages from the queue
-    /// based on highest priority, followed by oldest.  The calling code can keep track of the message's status
+    /// based on highest priority, followed by oldest, within the message's p_channel.  The calling code can keep track of the message's status
     /// using the Tracker parameter.  The Communicator will update the Tracker pointer as the message's status
     /// changes.  Once placed in the queue, the message's status is set to QUEUED.
+    /// \note The tracker must outlive the message's time in the queue.  Use send_async() for a handle with shared lifetime.
     ///
     bool send(message* message, bool receipt_required = false, message_status* tracker = nullptr);
     ///
+    /// \brief send_async Sends a message and returns a handle that completes when the message is delivered.
+    /// \param message The message to send. The communicator takes ownership of the pointer.
+    /// \param receipt_required OPTIONAL Indicates that the message should be retransmitted until a receipt is
+    /// received from the receiver, or the maximum amount of transmissions has been reached.
+    /// \return The delivery handle, or nullptr if the transmit queue was full.
+    /// \details The handle is shared with the communicator, so it may be released at any time without
+    /// affecting the message.  It completes on SENT, RECEIVED, NOTRECEIVED, CANCELLED, or DROPPED, and offers a signal,
+    /// a completion callback, a std::shared_future, and, when compiled as C++20, co_await.
+    ///
+    std::shared_ptr<delivery> send_async(message* message, bool receipt_required = false);
+    ///
+    /// \brief call Sends a request and returns a handle that completes when the matching response arrives.
+    /// \param request The request message. The communicator takes ownership of the pointer.
+    /// \param timeout The time to wait for the response, in milliseconds.
+    /// \param receipt_required OPTIONAL Indicates that the request, and its response, should be retransmitted until receipted.
+    /// \return The reply handle.  If the transmit queue was full, or extension blocks are not in use, the reply has already completed as NOT_DELIVERED.
+    /// \details The request carries a correlation ID in its extension block, and the remote
+    /// communicator's handler for the request's ID answers with the same correlation ID.  Responses
+    /// are routed directly to their reply through a table of pending calls, and never enter the
+    /// receive queue.  Any number of calls may be outstanding at once.  Timeouts are checked every
+    /// 20ms spin.  Both communicators must support extension blocks, so when negotiating, calls fail
+    /// right away until the hello exchange has completed with a peer that offers them.
+    ///
+    std::shared_ptr<reply> call(message* request, uint32_t timeout, bool receipt_required = false);
+    ///
+    /// \brief serve Registers a handler that answers requests of a message ID.
+    /// \param id The message ID of the requests.
+    /// \param handler The handler, which returns the response message or nullptr to send none.  The
+    /// communicator takes ownership of the response.  An empty handler unregisters the ID.
+    /// \details Handlers are invoked on the communicator's thread as requests are parsed.  Requests
+    /// of IDs without a handler, and messages sent with send(), are placed in the receive queue as usual.
+    ///
+    void serve(uint16_t id, std::function<message*(const message& request)> handler);
+    ///
+    /// \brief cancel Withdraws a message from the transmit queue.
+    /// \param handle The delivery handle returned by send_async().
+    /// \return TRUE if the message was withdrawn, or FALSE if it had already left the transmit queue.
+    /// \details A message that is still queued is never sent.  A message awaiting a receipt is not
+    /// retransmitted, and any receipt that later arrives for it is ignored.  The delivery completes as
+    /// CANCELLED.  Cancelling the request of a call() completes its reply as NOT_DELIVERED.
+    ///
+    bool cancel(const delivery& handle);
+    ///
+    /// \brief set_priority Changes the priority of a message in the transmit queue.
+    /// \param handle The delivery handle returned by send_async().
+    /// \param priority The new priority.
+    /// \return TRUE if the message's priority was changed, or FALSE if it had already left the transmit queue.
+    /// \details The message is reordered among queued messages immediately.  A message awaiting a
+    /// receipt keeps its new priority for any retransmissions.
+    ///
+    bool set_priority(const delivery& handle, uint8_t priority);
+    ///
     /// \brief messages_available Gets the total number of messages available to read from the receive queue.
     /// \return The number of available messages to read.
     ///
-    uint16_t messages_available() const;
+    uint32_t messages_available() const;
+    ///
+    /// \brief messages_available Gets the number of messages available to read from one channel's receive queue.
+    /// \param channel The logical channel.
+    /// \return The number of available messages to read.
+    ///
+    uint32_t messages_available(uint8_t channel) const;
     ///
     /// \brief receive Grabs a message from the receive queue.
     /// \param id OPTIONAL The ID of the message to read. Defaults to 0xFFFF, which will grab the next available message.
@@ -61,27 +141,111 @@ public:
     /// \details Messages are always returned by highest priority, followed by oldest in age.
     ///
     message* receive(uint16_t id = 0xFFFF);
+    ///
+    /// \brief receive Grabs a message from one channel's receive queue.
+    /// \param channel The logical channel to read from.
+    /// \param id The ID of the message to read, or 0xFFFF to grab the next available message.
+    /// \return A pointer to the received message. The calling code takes ownership of the message pointer.
+    /// \details Messages are always returned by highest priority, followed by oldest in age.
+    ///
+    message* receive(uint8_t channel, uint16_t id);
+    ///
+    /// \brief latency Gets the latency histogram of a metric across all messages.
+    /// \param metric The latency metric to get.
+    /// \return The histogram of the metric.  The pointer remains owned by the communicator.
+    ///
+    const latency_histogram* latency(latency_metric metric) const;
+    ///
+    /// \brief latency Gets the latency histogram of a metric for messages of one priority.
+    /// \param metric The latency metric to get.
+    /// \param priority The message priority to get.
+    /// \return The histogram, or nullptr if nothing has been recorded at the priority.  The pointer remains owned by the communicator.
+    ///
+    const latency_histogram* latency(latency_metric metric, uint8_t priority) const;
+    ///
+    /// \brief latency_by_id Gets the latency histogram of a metric for messages of one ID.
+    /// \param metric The latency metric to get.
+    /// \param id The message ID to get.
+    /// \return The histogram, or nullptr if nothing has been recorded for the ID.  The pointer remains owned by the communicator.
+    /// \note Per-ID histograms are only kept while p_latency_by_id is enabled.
+    ///
+    const latency_histogram* latency_by_id(latency_metric metric, uint16_t id) const;
+    ///
+    /// \brief reset_delta Forgets all delta encoding bases, so that the next message of every ID is sent in full.
+    /// \details Call this when either end of the link has been restarted.  Stale bases are otherwise
+    /// detected by the receiver and recovered with one retransmission.
+    ///
+    void reset_delta();
 
     // PROPERTIES
     ///
     /// \brief p_queue_size Gets the size of the transmit and receive buffers, in number of messages.
     /// \return The size of the transmit and receive buffers, in number of messages.
     /// \note The default size is 10 messages for each buffer.
-    /// \details If the internal transmit or receive queues become full, they will not allow any more
-    /// messages to be enqueued until space opens up from a spin() call.  These queue sizes ensure that
-    /// the system's memory does not fill up.
+    /// \details In FIXED queue mode, if the internal transmit or receive queues become full, the
+    /// p_overflow_policy decides what happens to new messages.  These queue sizes ensure that
+    /// the system's memory does not fill up.  The size is not used in ELASTIC queue mode.
     ///
     uint16_t p_queue_size();
     ///
     /// \brief p_queue_size Sets the size of the transmit and receive buffers, in number of messages.
     /// \param value The size of the transmit and receive buffers, in number of messages.
     /// \note The default size is 10 messages for each buffer.
-    /// \details If the internal transmit or receive queues become full, they will not allow any more
-    /// messages to be enqueued until space opens up from a spin() call.  These queue sizes ensure that
-    /// the system's memory does not fill up.
+    /// \details In FIXED queue mode, if the internal transmit or receive queues become full, the
+    /// p_overflow_policy decides what happens to new messages.  These queue sizes ensure that
+    /// the system's memory does not fill up.  The size is not used in ELASTIC queue mode.
+    /// Resizing never moves or drops queued messages.  A queue that holds more messages than the
+    /// new size accepts no more until it has drained below it.
     ///
     void p_queue_size(uint16_t value);
     ///
+    /// \brief p_queue_mode Gets how the transmit and receive queues are bounded.
+    /// \return The queue mode.
+    /// \note The default value is FIXED.
+    ///
+    serial_communicator::queue_mode p_queue_mode() const;
+    ///
+    /// \brief p_queue_mode Sets how the transmit and receive queues are bounded.
+    /// \param value The queue mode.
+    /// \details Both modes store messages in slots that grow in chunks of 16, so growing a queue never
+    /// copies the messages already in it.  FIXED bounds each queue by p_queue_size messages.  ELASTIC
+    /// bounds each queue by p_queue_memory_limit bytes of serialized messages instead, which suits
+    /// traffic that mixes many small messages with occasional large ones.
+    /// \note The default value is FIXED.
+    ///
+    void p_queue_mode(serial_communicator::queue_mode value);
+    ///
+    /// \brief p_queue_memory_limit Gets the most message bytes each queue may hold in ELASTIC queue mode.
+    /// \return The memory limit in bytes.
+    /// \note The default value is 1048576 bytes.
+    ///
+    uint32_t p_queue_memory_limit() const;
+    ///
+    /// \brief p_queue_memory_limit Sets the most message bytes each queue may hold in ELASTIC queue mode.
+    /// \param value The memory limit in bytes.
+    /// \details Each message counts as its ID, priority, data length, and data.  The limit is not used in FIXED queue mode.
+    /// \note The default value is 1048576 bytes.
+    ///
+    void p_queue_memory_limit(uint32_t value);
+    ///
+    /// \brief p_overflow_policy Gets what happens when a message arrives at a full queue.
+    /// \return The overflow policy.
+    /// \note The default value is REJECT.
+    ///
+    serial_communicator::overflow_policy p_overflow_policy() const;
+    ///
+    /// \brief p_overflow_policy Sets what happens when a message arrives at a full queue.
+    /// \param value The overflow policy.
+    /// \details The policy applies to both queues.  REJECT refuses the new message: send() returns
+    /// FALSE, and a received message is counted in rx_dropped.  DROP_OLDEST drops the oldest queued
+    /// messages until the new message fits.  DROP_LOWEST_PRIORITY drops queued messages of lower
+    /// priority than the new message, newest first, and refuses the new message if that does not make
+    /// room.  A transmit message awaiting a receipt is only dropped by DROP_OLDEST.  Dropped transmit
+    /// messages complete as DROPPED.  Drops are counted in tx_evicted and rx_evicted.
+    /// \note The default value is REJECT.
+    ///
+    void p_overflow_policy(serial_communicator::overflow_policy value);
+    ///
     /// \brief p_receipt_timeout Gets the receipt timeout in milliseconds.
     /// \return The receipt timeout in milliseconds.
     /// \details When a message is sent with receipt required, the transmittnig communicator will
@@ -125,103 +289,559 @@ public:
     /// \note The default value is 5 transmissions.
     ///
     void p_max_transmissions(uint8_t value);
+    ///
+    /// \brief p_channel Gets the settings of a logical channel.
+    /// \param channel The logical channel.
+    /// \return The settings of the channel.
+    ///
+    serial_communicator::channel_config p_channel(uint8_t channel) const;
+    ///
+    /// \brief p_channel Sets the settings of a logical channel.
+    /// \param channel The logical channel.
+    /// \param value The settings of the channel.
+    /// \details Messages are assigned to a channel with message::p_channel.  Each channel has its own
+    /// transmit and receive queue limits, receipt timeout, maximum transmissions, and window of messages
+    /// awaiting a receipt, and applies the p_overflow_policy among its own messages only.  Channels with
+    /// messages to send share the link by deficit round robin in proportion to their weights, so a busy
+    /// channel cannot starve the others.  Sequence numbers and credits for the default channel are
+    /// shared with communicators that do not support channels.  Messages on other channels carry their
+    /// channel in an extension block, so both communicators must support extension blocks.  While
+    /// extension blocks are not in use, such as before negotiation completes, send() rejects messages
+    /// on other channels, and messages already queued on them are sent on the default channel.
+    /// \note Channels that are never configured use the default channel_config.
+    ///
+    void p_channel(uint8_t channel, const serial_communicator::channel_config& value);
+    ///
+    /// \brief p_header_checksum Gets if frames carry a header checksum.
+    /// \return TRUE if frames carry a header checksum, otherwise FALSE.
+    /// \details When enabled, a CRC-8 of the frame header is inserted after the receipt field, and
+    /// received headers are validated before their data length is trusted.  A corrupted length is
+    /// then discarded immediately instead of waiting for a bogus payload to arrive.  Both
+    /// communicators must use the same setting.
+    /// \note The default value is FALSE, which is compatible with communicators that do not support header checksums.
+    ///
+    bool p_header_checksum() const;
+    ///
+    /// \brief p_header_checksum Sets if frames carry a header checksum.
+    /// \param value TRUE if frames carry a header checksum, otherwise FALSE.
+    /// \details When enabled, a CRC-8 of the frame header is inserted after the receipt field, and
+    /// received headers are validated before their data length is trusted.  A corrupted length is
+    /// then discarded immediately instead of waiting for a bogus payload to arrive.  Both
+    /// communicators must use the same setting, unless p_negotiation is enabled, in which case header
+    /// checksums are only used once both communicators have offered them.
+    /// \note The default value is FALSE, which is compatible with communicators that do not support header checksums.
+    ///
+    void p_header_checksum(bool value);
+    ///
+    /// \brief p_max_data_length Gets the largest data length accepted in a received frame.
+    /// \return The largest accepted data length in bytes.
+    /// \details Received frames that declare a longer data length are discarded as soon as their
+    /// header is read, and parsing resumes at the next header.
+    /// \note The default value is 65535 bytes.
+    ///
+    uint16_t p_max_data_length() const;
+    ///
+    /// \brief p_max_data_length Sets the largest data length accepted in a received frame.
+    /// \param value The largest accepted data length in bytes.
+    /// \details Received frames that declare a longer data length are discarded as soon as their
+    /// header is read, and parsing resumes at the next header.
+    /// \note The default value is 65535 bytes.
+    ///
+    void p_max_data_length(uint16_t value);
+    ///
+    /// \brief p_compression Gets if payloads of a message ID are compressed before transmission.
+    /// \param id The message ID.
+    /// \return TRUE if payloads of the ID are compressed, otherwise FALSE.
+    /// \note The default value is FALSE for every ID.
+    ///
+    bool p_compression(uint16_t id) const;
+    ///
+    /// \brief p_compression Sets if payloads of a message ID are compressed before transmission.
+    /// \param id The message ID.
+    /// \param value TRUE to compress payloads of the ID, otherwise FALSE.
+    /// \details Compressed frames are marked by a flag in the receipt field and carry the uncompressed
+    /// data length ahead of an LZ77 block.  A payload is only sent compressed if it is at least
+    /// p_compression_threshold bytes long and compression makes it smaller; otherwise it is sent as is.
+    /// Compression suits repetitive payloads such as text, tables, or sparse arrays; it is wasted
+    /// effort on payloads that are already dense.  The receiving communicator must also support
+    /// compression, although it does not need to enable it for the ID.
+    /// \note The default value is FALSE for every ID, which is compatible with communicators that do not support compression.
+    ///
+    void p_compression(uint16_t id, bool value);
+    ///
+    /// \brief p_compression_threshold Gets the smallest data length that is considered for compression.
+    /// \return The compression threshold in bytes.
+    /// \note The default value is 32 bytes.
+    ///
+    uint16_t p_compression_threshold() const;
+    ///
+    /// \brief p_compression_threshold Sets the smallest data length that is considered for compression.
+    /// \param value The compression threshold in bytes.
+    /// \details Tiny payloads rarely shrink, so skipping them saves the cost of trying.
+    /// \note The default value is 32 bytes.
+    ///
+    void p_compression_threshold(uint16_t value);
+    ///
+    /// \brief p_delta Gets if payloads of a message ID are delta encoded before transmission.
+    /// \param id The message ID.
+    /// \return TRUE if payloads of the ID are delta encoded, otherwise FALSE.
+    /// \note The default value is FALSE for every ID.
+    ///
+    bool p_delta(uint16_t id) const;
+    ///
+    /// \brief p_delta Sets if payloads of a message ID are delta encoded before transmission.
+    /// \param id The message ID.
+    /// \param value TRUE to delta encode payloads of the ID, otherwise FALSE.
+    /// \details A delta encoded frame carries an XOR run-length diff against the last payload of the
+    /// same ID that the receiver acknowledged, along with that payload's sequence number.  Only
+    /// messages sent with a receipt required are delta encoded, and only once an earlier message of
+    /// the ID has been acknowledged.  If the receiver no longer holds the base, it answers with a
+    /// checksum mismatch and the message is retransmitted in full.  The receiving communicator must
+    /// support delta encoding and extension blocks, but needs no configuration: full payloads of the
+    /// ID are marked as bases in their extension block, so the receiver caches them before the first
+    /// delta frame arrives.  Delta encoding is applied before compression.
+    /// \note The default value is FALSE for every ID, which is compatible with communicators that do not support delta encoding.
+    ///
+    void p_delta(uint16_t id, bool value);
+    ///
+    /// \brief p_receive_filter Gets if received messages of unsubscribed IDs are discarded.
+    /// \return TRUE if the receive filter is enabled, otherwise FALSE.
+    /// \note The default value is FALSE.
+    ///
+    bool p_receive_filter() const;
+    ///
+    /// \brief p_receive_filter Sets if received messages of unsubscribed IDs are discarded.
+    /// \param value TRUE to only store messages of subscribed IDs, otherwise FALSE.
+    /// \details Frames of unsubscribed IDs are discarded as soon as they are parsed, without entering
+    /// the receive queue, and are still acknowledged so that the sender does not retransmit them.
+    /// Requests served by a handler and responses to calls are never filtered.  Discarded frames are
+    /// counted in rx_filtered.
+    ///
+    void p_receive_filter(bool value);
+    ///
+    /// \brief p_subscribed Gets if received messages of an ID pass the receive filter.
+    /// \param id The message ID.
+    /// \return TRUE if the ID is subscribed, otherwise FALSE.
+    /// \note The default value is FALSE for every ID.
+    ///
+    bool p_subscribed(uint16_t id) const;
+    ///
+    /// \brief p_subscribed Sets if received messages of an ID pass the receive filter.
+    /// \param id The message ID.
+    /// \param value TRUE to subscribe to the ID, otherwise FALSE.
+    ///
+    void p_subscribed(uint16_t id, bool value);
+    ///
+    /// \brief p_ack_delay Gets how long receipts are held waiting for an outbound frame to carry them.
+    /// \return The acknowledgement delay in milliseconds.
+    /// \note The default value is 0ms.
+    ///
+    uint32_t p_ack_delay() const;
+    ///
+    /// \brief p_ack_delay Sets how long receipts are held waiting for an outbound frame to carry them.
+    /// \param value The acknowledgement delay in milliseconds.  A value of 0 sends every receipt immediately in its own frame.
+    /// \details While receipts are pending, every outbound frame carries them in an extension block
+    /// after its data.  Receipts still pending when the delay expires are sent together, in one
+    /// receipt frame per 52 receipts.  Outbound messages are sent once per 20ms spin, so shorter
+    /// delays rarely find a frame to ride on.  The delay adds to the sender's round trip, so keep it
+    /// well below the sender's p_receipt_timeout.  The sending communicator must support extension blocks.
+    /// \note The default value is 0ms, which is compatible with communicators that do not support extension blocks.
+    ///
+    void p_ack_delay(uint32_t value);
+    ///
+    /// \brief p_flow_control Gets if the free receive queue capacity is advertised to the sender.
+    /// \return TRUE if credits are advertised, otherwise FALSE.
+    /// \note The default value is FALSE.
+    ///
+    bool p_flow_control() const;
+    ///
+    /// \brief p_flow_control Sets if the free receive queue capacity is advertised to the sender.
+    /// \param value TRUE to advertise credits, otherwise FALSE.
+    /// \details Every receipt sent carries the receive queue's free capacity as credits: free messages
+    /// in FIXED queue mode, or free bytes in ELASTIC queue mode.  Once a sender has heard credits, it
+    /// holds back the first transmission of receipt-required messages while its unacknowledged
+    /// messages would exceed them, and sends other messages in the meantime.  Messages sent without a
+    /// receipt are never held back.  When the receive queue has been advertised as full and
+    /// receive() frees space, the new credits are sent within one 20ms spin, and sent again every
+    /// receipt timeout until a receipt-required frame arrives on the channel, since a sender stalled
+    /// without credits sends nothing that would be acknowledged.  The sending communicator must
+    /// support extension blocks.
+    /// \note The default value is FALSE, which is compatible with communicators that do not support flow control.
+    ///
+    void p_flow_control(bool value);
+    ///
+    /// \brief p_heartbeat_interval Gets the interval at which heartbeats are sent to the peer.
+    /// \return The heartbeat interval in milliseconds.
+    /// \note The default value is 0ms, which disables heartbeats.
+    ///
+    uint32_t p_heartbeat_interval() const;
+    ///
+    /// \brief p_heartbeat_interval Sets the interval at which heartbeats are sent to the peer.
+    /// \param value The heartbeat interval in milliseconds.  A value of 0 disables heartbeats.
+    /// \details Every interval, a heartbeat control frame is sent, and the peer answers it at once.
+    /// The answers measure the round trip time.  The link is declared down once no valid frame of
+    /// any kind has been heard for three intervals, and up again as soon as one is.  While the link
+    /// is down, receipt-required messages are neither transmitted nor retransmitted; see
+    /// p_fail_on_link_down.  The peer must support control frames, but does not need heartbeats enabled.
+    /// \note The default value is 0ms, which disables heartbeats and keeps the link up.
+    ///
+    void p_heartbeat_interval(uint32_t value);
+    ///
+    /// \brief p_fail_on_link_down Gets if receipt-required messages fail when the link goes down.
+    /// \return TRUE if the messages fail, or FALSE if they are parked until the link comes back up.
+    /// \note The default value is FALSE.
+    ///
+    bool p_fail_on_link_down() const;
+    ///
+    /// \brief p_fail_on_link_down Sets if receipt-required messages fail when the link goes down.
+    /// \param value TRUE to fail the messages, or FALSE to park them until the link comes back up.
+    /// \details Failed messages complete as NOTRECEIVED, including those queued while the link is
+    /// down.  Parked messages keep their place and transmission count, and resume when the link
+    /// comes back up.  Messages sent without a receipt are unaffected.
+    /// \note The default value is FALSE.
+    ///
+    void p_fail_on_link_down(bool value);
+    ///
+    /// \brief p_link_quality Gets the communicator's current estimate of its link to the peer.
+    /// \return The current link quality.
+    ///
+    serial_communicator::link_quality p_link_quality() const;
+    ///
+    /// \brief p_negotiation Gets if protocol features are negotiated with the peer.
+    /// \return TRUE if features are negotiated, otherwise FALSE.
+    /// \note The default value is FALSE.
+    ///
+    bool p_negotiation() const;
+    ///
+    /// \brief p_negotiation Sets if protocol features are negotiated with the peer.
+    /// \param value TRUE to negotiate features, otherwise FALSE.
+    /// \details When enabled, the communicator exchanges a versioned hello control frame with the peer,
+    /// on enabling and whenever the link comes back up, offering the features it supports and its
+    /// p_max_data_length.  Header checksums are offered only if p_header_checksum is set.  Until the
+    /// peer answers, frames use the legacy format: no header checksum, compression, delta encoding, piggybacked
+    /// receipts, or credits, whatever the local settings.  Once it answers, each of those is used
+    /// only if both ends offered it, and send() rejects messages with more data than the peer accepts.
+    /// A peer that never answers stays on the legacy format.  Frames carrying a header checksum are
+    /// flagged, so that frames already in flight when the format changes are still parsed.  Both
+    /// communicators should enable negotiation.  A communicator that does not support control
+    /// frames places each hello in its receive queue as a message, so hellos are only retried three times.
+    /// \note The default value is FALSE, which is compatible with communicators that do not support negotiation.
+    ///
+    void p_negotiation(bool value);
+    ///
+    /// \brief p_negotiated Gets if the peer has answered the negotiation.
+    /// \return TRUE if the negotiated features are in use, otherwise FALSE.
+    ///
+    bool p_negotiated() const;
+    ///
+    /// \brief p_statistics Gets a snapshot of the communicator's runtime statistics.
+    /// \return The current statistics.
+    /// \details Counters are cumulative since construction.  Per-second rates are those measured
+    /// over the most recent statistics interval.
+    ///
+    statistics p_statistics() const;
+    ///
+    /// \brief p_statistics_interval Gets the interval at which statistics are sampled and published.
+    /// \return The statistics interval in milliseconds.
+    /// \details Every interval, the per-second rates are recomputed and the statistics_updated
+    /// signal is emitted.
+    /// \note The default value is 1000ms.
+    ///
+    uint32_t p_statistics_interval();
+    ///
+    /// \brief p_statistics_interval Sets the interval at which statistics are sampled and published.
+    /// \param value The statistics interval in milliseconds.  A value of 0 disables sampling and publishing.
+    /// \details Every interval, the per-second rates are recomputed and the statistics_updated
+    /// signal is emitted.
+    /// \note The default value is 1000ms.
+    ///
+    void p_statistics_interval(uint32_t value);
+    ///
+    /// \brief p_latency_by_id Gets if latency histograms are also kept per message ID.
+    /// \return TRUE if per-ID histograms are kept, otherwise FALSE.
+    /// \note The default value is FALSE.
+    ///
+    bool p_latency_by_id() const;
+    ///
+    /// \brief p_latency_by_id Sets if latency histograms are also kept per message ID.
+    /// \param value TRUE to keep per-ID histograms, otherwise FALSE.
+    /// \note The default value is FALSE.
+    ///
+    void p_latency_by_id(bool value);
+    ///
+    /// \brief p_capture Gets the capture that records the raw serial byte stream.
+    /// \return The capture, or nullptr if capturing is disabled.
+    ///
+    capture* p_capture() const;
+    ///
+    /// \brief p_capture Sets a capture to record the raw serial byte stream.
+    /// \param value The capture to record to, or nullptr to disable capturing.  The communicator does not take ownership.
+    /// \details Every block read in data_ready() and every buffer written to the serial port is recorded
+    /// with its direction and a monotonic timestamp.
+    ///
+    void p_capture(capture* value);
+    ///
+    /// \brief p_spool Gets the spool that stores outbound messages across link outages and restarts.
+    /// \return The spool, or nullptr if spooling is disabled.
+    ///
+    spool* p_spool() const;
+    ///
+    /// \brief p_spool Sets a spool to store outbound messages across link outages and restarts.
+    /// \param value The spool to use, or nullptr to disable spooling.  The communicator does not take ownership.
+    /// \details Messages that do not fit in their channel's transmit queue are appended to the spool
+    /// instead of being rejected or evicting others, and are moved into the queue in priority order as
+    /// it empties.  Receipt-required messages are also written to the spool when queued, and released
+    /// once they finish, so that any still pending after a restart are recovered and sent again with
+    /// no delivery handle.  Requests and responses of calls are never spooled.  Messages waiting in a
+    /// previous spool stay in its file, and their trackers and deliveries finish as DROPPED.
+    ///
+    void p_spool(spool* value);
+    ///
+    /// \brief p_decode_pool Gets the pool that validates and expands received frames.
+    /// \return The decode pool, or nullptr if frames are decoded on the communicator's thread.
+    ///
+    std::shared_ptr<decode_pool> p_decode_pool() const;
+    ///
+    /// \brief p_decode_pool Sets a pool to validate and expand received frames.
+    /// \param value The decode pool to use, or nullptr to decode on the communicator's thread.  The communicator shares ownership of the pool.
+    /// \details Framing stays on the communicator's thread, and each complete frame's checksum and
+    /// decompression are handed to the pool.  Frames are finished on the communicator's thread strictly
+    /// in the order they arrived, so receipts, sequencing, and delivery order are unchanged.  If the
+    /// pool's queue is full, the frame is decoded on the communicator's thread instead.
+    ///
+    void p_decode_pool(std::shared_ptr<decode_pool> value);
+
+signals:
+    // SIGNALS
+    ///
+    /// \brief statistics_updated Emitted every statistics interval with the latest statistics.
+    /// \param statistics The latest statistics snapshot.
+    ///
+    void statistics_updated(serial_communicator::statistics statistics);
+    ///
+    /// \brief link_changed Emitted when the link goes up or down.
+    /// \param up TRUE if the link is now up, otherwise FALSE.
+    ///
+    void link_changed(bool up);
+    ///
+    /// \brief link_quality_updated Emitted when the link goes up or down, and whenever a heartbeat is answered.
+    /// \param quality The latest link quality.
+    ///
+    void link_quality_updated(serial_communicator::link_quality quality);
 
 private:
-    // ENUMERATIONS
+    // FRIENDS
+    friend class replayer;
+
+    // TYPES
+    ///
+    /// \brief The clock that drives the protocol engine, timestamps received bytes, and times calls.
+    ///
+    typedef std::chrono::steady_clock clock;
+
+    // STRUCTURES
+    ///
+    /// \brief A call waiting for its response.
+    ///
+    struct pending_call
+    {
+        std::shared_ptr<serial_communicator::reply> reply;                                         ///< The reply to complete.
+        std::multimap<clock::time_point, uint32_t>::iterator deadline;  ///< The call's entry in the deadline map.
+    };
+    ///
+    /// \brief The caller's handles of a message that overflowed into the spool.
+    ///
+    struct spooled_message
+    {
+        uint32_t sequence_number;                                   ///< The sequence number reserved for the message.
+        message_status* tracker;                                    ///< The caller's status tracker, or nullptr.
+        std::shared_ptr<serial_communicator::delivery> delivery;    ///< The delivery handle, or nullptr.
+    };
     ///
-    /// \brief Enumerates the types of the message's receipt field.
+    /// \brief The protocol engine's host, which connects the engine to the communicator's device, timers, signals, spool, and calls.
     ///
-    enum class receipt_type
+    struct engine_host
     {
-        NOT_REQUIRED = 0,       ///< In a transmitted message, indicates that no receipt is required from the receiver.
-        REQUIRED = 1,           ///< In a transmitted message, indicates that a receipt is required from the receiver.
-        RECEIVED = 2,           ///< In a receipt message, indicates that the message was properly received.
-        CHECKSUM_MISMATCH = 3   ///< In a receipt message, indicates that the message was received, but the checksum did not match.
+        communicator* owner;    ///< The communicator that hosts the engine.
+        ///
+        /// \brief write Writes an escaped packet to the device, and captures it.
+        /// \param data The escaped packet.
+        /// \param length The length of the escaped packet.
+        ///
+        void write(const uint8_t* data, uint32_t length);
+        ///
+        /// \brief wake Makes sure the engine is polled again within a time.
+        /// \param milliseconds The longest time until the next poll.
+        ///
+        void wake(uint32_t milliseconds);
+        ///
+        /// \brief link_changed Publishes that the link went up or down.
+        /// \param quality The latest link quality.
+        ///
+        void link_changed(const serial_communicator::link_quality& quality);
+        ///
+        /// \brief link_quality_updated Publishes a new link quality measurement.
+        /// \param quality The latest link quality.
+        ///
+        void link_quality_updated(const serial_communicator::link_quality& quality);
+        ///
+        /// \brief correlated Routes a response to its waiting call, or a request to its handler.
+        /// \param response TRUE if the message is a response, or FALSE if it is a request.
+        /// \param correlation The correlation ID of the call.
+        /// \param bytes The serialized message.
+        /// \param channel The logical channel of the message.
+        /// \param receipt_required Indicates that the message required a receipt.
+        /// \param arrival The time at which the message was received.
+        /// \return TRUE if the message was routed, or FALSE if it should be queued like any other message.
+        ///
+        bool correlated(bool response, uint32_t correlation, const uint8_t* bytes, uint8_t channel, bool receipt_required, clock::time_point arrival);
+        ///
+        /// \brief retired Releases the spool record of a message that left the transmit queue.
+        /// \param sequence_number The sequence number of the message.
+        ///
+        void retired(uint32_t sequence_number);
+        ///
+        /// \brief offloads Checks if a decode pool is attached.
+        /// \return TRUE if received frames may be validated by the decode pool, otherwise FALSE.
+        ///
+        bool offloads() const;        ///
+        /// \brief submit Hands a received frame's validation to the decode pool.
+        /// \param work The validation.
+        /// \return TRUE if the pool took the work, or FALSE if it must be done in place.
+        ///
+        bool submit(std::function<void()> work);
+        ///
+        /// \brief decoded Notifies the communicator's thread that a decode pool worker has finished a frame.
+        ///
+        void decoded();
     };
+    ///
+    /// \brief The protocol engine hosted by the communicator.
+    ///
+    typedef utility::protocol_engine<engine_host, clock> engine;
 
     // CONSTANTS
     ///
-    /// \brief m_header_byte Stores the message header byte.
+    /// \brief m_write_backlog Stores the serial output backlog in bytes above which writes wait for the port to drain.
     ///
-    const uint8_t m_header_byte = 0xAA;
+    static const qint64 m_write_backlog = 4096;
     ///
-    /// \brief m_escape_byte Stores the message escape byte.
+    /// \brief m_write_timeout Stores the longest a write waits for a backlogged serial port, in milliseconds.
     ///
-    const uint8_t m_escape_byte = 0x1B;
+    static const int m_write_timeout = 10;
 
     // PARAMETERS
     ///
-    /// \brief m_queue_size Stores the size of the transmit/receive queues, in messages.
+    /// \brief m_statistics_interval Stores the statistics sampling interval in milliseconds.
     ///
-    uint16_t m_queue_size;
+    uint32_t m_statistics_interval;
+
+    // VARIABLES
     ///
-    /// \brief m_receipt_timeout Stores the receipt timeout in milliseconds.
+    /// \brief m_device The communicator's transport device.
     ///
-    uint32_t m_receipt_timeout;
+    QIODevice* m_device;
     ///
-    /// \brief m_max_transmissions Stores the maximum amount of transmissions for one message.
+    /// \brief m_correlation_counter Stores the next correlation ID for remote calls.
     ///
-    uint8_t m_max_transmissions;
-
-    // VARIABLES
+    uint32_t m_correlation_counter;
     ///
-    /// \brief m_serial_port The communicator's serial port.
+    /// \brief m_pending_calls Stores the calls waiting for a response, by correlation ID.
     ///
-    QSerialPort* m_serial_port;
+    std::unordered_map<uint32_t, pending_call> m_pending_calls;
     ///
-    /// \brief m_sequence_counter Stores the current sequence number for assigning unique and monotonic sequence IDs to messages.
+    /// \brief m_call_deadlines Stores the correlation IDs of pending calls, by deadline.
     ///
-    uint32_t m_sequence_counter;
+    std::multimap<clock::time_point, uint32_t> m_call_deadlines;
+    ///
+    /// \brief m_handlers Stores the request handlers, by message ID.
+    ///
+    std::unordered_map<uint16_t, std::function<message*(const message&)>> m_handlers;
     ///
     /// \brief m_timer The background timer for spinning send events.
     ///
     QTimer* m_timer;
     ///
-    /// \brief m_serial_buffer Stores newly received bytes from the serial port.
+    /// \brief m_wake_timer The single shot timer for polling the engine when it asks to be woken before the next spin.
     ///
-    std::deque<uint8_t> m_serial_buffer;
+    QTimer* m_wake_timer;
     ///
-    /// \brief m_escape_next Indicates if the next read byte is escaped.
+    /// \brief m_statistics_timer The background timer for sampling and publishing statistics.
     ///
-    bool m_escape_next;
-
-    // QUEUES
+    QTimer* m_statistics_timer;
+    ///
+    /// \brief m_capture Stores the capture that records the raw serial byte stream.
+    ///
+    capture* m_capture;
+    ///
+    /// \brief m_spool Stores the spool that stores outbound messages across link outages and restarts.
+    ///
+    spool* m_spool;
     ///
-    /// \brief m_tx_queue The internal transmit queue.
+    /// \brief m_decode_pool Stores the pool that validates and expands received frames.
     ///
-    utility::outbound** m_tx_queue;
+    std::shared_ptr<decode_pool> m_decode_pool;
     ///
-    /// \brief m_rx_queue The internal receive queue.
+    /// \brief m_collect_pending Indicates that a decode pool worker has asked the communicator's thread to collect frames.
     ///
-    utility::inbound** m_rx_queue;
+    std::atomic<bool> m_collect_pending;
+    ///
+    /// \brief m_spooled Stores the handles of messages waiting in the spool, by spool record.
+    ///
+    std::unordered_map<uint64_t, spooled_message> m_spooled;
+    ///
+    /// \brief m_spool_records Stores the spool record of each queued message that was written to the spool, by sequence number.
+    ///
+    std::unordered_map<uint32_t, uint64_t> m_spool_records;
+    ///
+    /// \brief m_engine Runs the protocol: queues, scheduling, receipts, retransmission, and flow control.
+    /// \details Declared last, so that it is destroyed first, while the hooks it calls can still reach the rest of the communicator.
+    ///
+    engine m_engine;
 
     // METHODS
     ///
-    /// \brief spin_tx Conducts the transmit duties during a spin cycle.
+    /// \brief spin_rx Handles the next received frame.
+    /// \return TRUE if a complete packet was consumed from the serial buffer, otherwise FALSE.
+    ///
+    bool spin_rx();
     ///
-    void spin_tx();
+    /// \brief ingest Adds raw bytes read from the serial port to the engine.
+    /// \param data The raw bytes.
+    /// \param length The number of raw bytes.
+    /// \param timestamp The time at which the bytes were read.
     ///
-    /// \brief spin_rx Conducts the receive duties during a spin cycle.
+    void ingest(const uint8_t* data, uint32_t length, clock::time_point timestamp);
     ///
-    void spin_rx();
+    /// \brief enqueue Places a message in the transmit queue, or in the spool if the queue is full.
+    /// \param message The message to send. The communicator takes ownership of the pointer.
+    /// \param receipt_required Indicates that the message requires a receipt.
+    /// \param tracker The caller's status tracker, or nullptr.
+    /// \param delivery The delivery handle, or nullptr.
+    /// \param extensions The extension entries to carry with the message.
+    /// \return TRUE if the message was queued, otherwise FALSE.
+    ///
+    bool enqueue(message* message, bool receipt_required, message_status* tracker, std::shared_ptr<delivery> delivery, std::vector<uint8_t> extensions);
+    ///
+    /// \brief drain_spool Moves waiting spool records into their channels' transmit queues while there is room.
+    ///
+    void drain_spool();
     ///
-    /// \brief tx Serializes a message and writes it to the serial buffer.
-    /// \param message The message to write.
+    /// \brief drop_spooled Reports the messages waiting in the spool as dropped, and stops following them.
     ///
-    void tx(utility::outbound* message);
+    void drop_spooled();
     ///
-    /// \brief tx Writes data to a serial buffer with proper escapement.
-    /// \param buffer The buffer of unescaped packet bytes to escape and send.
-    /// \param length The length of the unescaped packet buffer.
+    /// \brief finish_call Completes a pending call.
+    /// \param correlation The correlation ID of the call.
+    /// \param status The final status of the call.
+    /// \param response The response message, or nullptr.  Ownership is taken even if the call is not found.
+    /// \return TRUE if the call was pending, otherwise FALSE.
     ///
-    void tx(uint8_t* buffer, uint32_t length);
+    bool finish_call(uint32_t correlation, reply_status status, message* response);
     ///
-    /// \brief checksum Calculates the XOR checksum of the provided data array.
-    /// \param data The data to calculate the checksum for.
-    /// \param length The length of the data array.
-    /// \return The XOR checksum of the data.
+    /// \brief expire_calls Completes pending calls whose deadline has passed.
     ///
-    uint8_t checksum(uint8_t* data, uint32_t length);
+    void expire_calls();
     ///
     /// \brief serial_read Conducts a read operation on the serial port.
     /// \param buffer The buffer to read the data into.
@@ -241,8 +861,15 @@ private slots:
     /// \brief data_ready Handles the serial port's readyread signal.
     ///
     void data_ready();
+    ///
+    /// \brief statistics_timer Handles the statistics timer signal.
+    ///
+    void statistics_timer();
 
 };
 }
 
+Q_DECLARE_METATYPE(serial_communicator::statistics)
+Q_DECLARE_METATYPE(serial_communicator::link_quality)
+
 #endif // COMMUNICATOR_H
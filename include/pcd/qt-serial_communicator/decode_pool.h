@@ -0,0 +1,92 @@
+/// \file decode_pool.h
+/// \brief Defines the serial_communicator::decode_pool class.
+#ifndef DECODE_POOL_H
+#define DECODE_POOL_H
+
+#include "utility/mpmc_queue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace serial_communicator {
+///
+/// \brief A pool of worker threads that validates and expands received frames for communicators.
+/// \details Communicators attached with communicator::p_decode_pool() hand each complete frame to
+/// the pool through a lock-free queue, and the workers verify its checksum and decompress its data.
+/// Each communicator still finishes its frames on its own thread in the order they arrived, so
+/// sequencing and delivery order are unchanged.  One pool may serve any number of communicators,
+/// which share ownership of it, so the pool lives until the last of them releases it.
+///
+class decode_pool
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief decode_pool Creates a new decode pool and starts its workers.
+    /// \param n_threads OPTIONAL The number of worker threads, or 0 for one per hardware thread.
+    /// \param capacity OPTIONAL The maximum number of tasks waiting for a worker.
+    ///
+    decode_pool(uint32_t n_threads = 0, uint32_t capacity = 1024);
+    ~decode_pool();
+
+    // METHODS
+    ///
+    /// \brief submit Hands a task to the workers.
+    /// \param task The task to run.
+    /// \return TRUE if a worker will run the task, or FALSE if too many tasks are waiting.
+    ///
+    bool submit(std::function<void()> task);
+
+    // PROPERTIES
+    ///
+    /// \brief p_threads Gets the number of worker threads.
+    /// \return The number of worker threads.
+    ///
+    uint32_t p_threads() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_tasks Stores the tasks waiting for a worker.
+    ///
+    utility::mpmc_queue<std::function<void()>> m_tasks;
+    ///
+    /// \brief m_n_tasks Stores the number of tasks waiting for a worker.
+    /// \details A worker may take a task before its submitter counts it, so the count can briefly be negative.
+    ///
+    std::atomic<int32_t> m_n_tasks;
+    ///
+    /// \brief m_n_idle Stores the number of workers asleep waiting for a task.
+    ///
+    std::atomic<uint32_t> m_n_idle;
+    ///
+    /// \brief m_stop Indicates that the workers should exit once the waiting tasks are done.
+    ///
+    std::atomic<bool> m_stop;
+    ///
+    /// \brief m_mutex Protects the workers' sleep.
+    ///
+    std::mutex m_mutex;
+    ///
+    /// \brief m_condition Wakes sleeping workers.
+    ///
+    std::condition_variable m_condition;
+    ///
+    /// \brief m_workers The worker threads.
+    ///
+    std::vector<std::thread> m_workers;
+
+    // METHODS
+    ///
+    /// \brief worker The worker threads' main loop.
+    ///
+    void worker();
+};
+}
+
+#endif // DECODE_POOL_H
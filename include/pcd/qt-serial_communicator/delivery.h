@@ -0,0 +1,187 @@
+/// \file delivery.h
+/// \brief Defines the serial_communicator::delivery class.
+#ifndef DELIVERY_H
+#define DELIVERY_H
+
+#include "message_status.h"
+#include "utility/status_observer.h"
+
+#include <QObject>
+#include <QMetaType>
+#include <QTimer>
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#endif
+
+namespace serial_communicator {
+class communicator;
+///
+/// \brief A handle for observing the delivery of a sent message.
+/// \details A delivery is returned by communicator::send_async() and is shared between the caller
+/// and the communicator, so it remains valid for as long as either holds it.  It completes once
+/// the message reaches SENT, RECEIVED, NOTRECEIVED, CANCELLED, or DROPPED.  If the communicator is destroyed before
+/// then, the delivery completes as NOTRECEIVED.
+///
+class delivery
+    : public QObject,
+      public utility::status_observer
+{
+    Q_OBJECT
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief delivery Creates a new delivery instance with a QUEUED status.
+    /// \param sequence_number The sequence number assigned to the message.
+    ///
+    delivery(uint32_t sequence_number);
+
+    // METHODS
+    ///
+    /// \brief wait Blocks until the delivery completes.
+    /// \return The final status of the message.
+    /// \details Do not call this from the communicator's thread, since the communicator cannot
+    /// make progress while its thread is blocked.
+    ///
+    message_status wait() const;
+    ///
+    /// \brief on_complete Registers a callback for when the delivery completes.
+    /// \param callback The callback, which receives the final status of the message.
+    /// \details If the delivery has already completed, the callback is invoked immediately.  Otherwise
+    /// it is invoked on the communicator's thread from within its event processing.
+    ///
+    void on_complete(std::function<void(message_status)> callback);
+
+    // PROPERTIES
+    ///
+    /// \brief p_sequence_number Gets the sequence number assigned to the message.
+    /// \return The sequence number assigned to the message.
+    ///
+    uint32_t p_sequence_number() const;
+    ///
+    /// \brief p_status Gets the current status of the message.
+    /// \return The current status of the message.
+    ///
+    message_status p_status() const;
+    ///
+    /// \brief p_complete Gets if the delivery has completed.
+    /// \return TRUE if the message has reached SENT, RECEIVED, NOTRECEIVED, CANCELLED, or DROPPED, otherwise FALSE.
+    ///
+    bool p_complete() const;
+    ///
+    /// \brief p_future Gets a future that resolves with the final status of the message.
+    /// \return The future.
+    ///
+    std::shared_future<message_status> p_future() const;
+
+signals:
+    // SIGNALS
+    ///
+    /// \brief status_changed Emitted whenever the message's status changes.
+    /// \param status The new status.
+    ///
+    void status_changed(serial_communicator::message_status status);
+    ///
+    /// \brief completed Emitted once when the delivery completes.
+    /// \param status The final status of the message.
+    ///
+    void completed(serial_communicator::message_status status);
+
+private:
+    // FRIENDS
+    friend class serial_communicator::communicator;
+
+    // VARIABLES
+    ///
+    /// \brief m_sequence_number Stores the sequence number assigned to the message.
+    ///
+    uint32_t m_sequence_number;
+    ///
+    /// \brief m_mutex Protects the status and callbacks.
+    ///
+    mutable std::mutex m_mutex;
+    ///
+    /// \brief m_status Stores the current status of the message.
+    ///
+    message_status m_status;
+    ///
+    /// \brief m_promise Stores the promise of the final status.
+    ///
+    std::promise<message_status> m_promise;
+    ///
+    /// \brief m_future Stores the future of the final status.
+    ///
+    std::shared_future<message_status> m_future;
+    ///
+    /// \brief m_callbacks Stores the callbacks waiting for completion.
+    ///
+    std::vector<std::function<void(message_status)>> m_callbacks;
+
+    // METHODS
+    ///
+    /// \brief update Updates the status, completing the delivery if the status is final.
+    /// \param status The new status.
+    ///
+    void update(message_status status) override;
+    ///
+    /// \brief is_final Checks if a status ends a delivery.
+    /// \param status The status to check.
+    /// \return TRUE if the status is SENT, RECEIVED, NOTRECEIVED, CANCELLED, or DROPPED, otherwise FALSE.
+    ///
+    static bool is_final(message_status status);
+};
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+///
+/// \brief Suspends a coroutine until a delivery completes.
+/// \details The coroutine is resumed from the communicator's event loop, not from within the
+/// receipt handling that completed the delivery.
+///
+class delivery_awaiter
+{
+public:
+    delivery_awaiter(std::shared_ptr<delivery> delivery)
+        : m_delivery(std::move(delivery))
+    {
+    }
+    bool await_ready() const
+    {
+        return m_delivery->p_complete();
+    }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        delivery* target = m_delivery.get();
+        m_delivery->on_complete([target, handle](message_status)
+        {
+            QTimer::singleShot(0, target, [handle]() { handle.resume(); });
+        });
+    }
+    message_status await_resume() const
+    {
+        return m_delivery->p_status();
+    }
+
+private:
+    std::shared_ptr<delivery> m_delivery;
+};
+///
+/// \brief operator co_await Allows a coroutine to co_await the result of communicator::send_async().
+/// \param delivery The delivery to await.
+/// \return An awaiter that yields the final status of the message.
+///
+inline delivery_awaiter operator co_await(std::shared_ptr<delivery> delivery)
+{
+    return delivery_awaiter(std::move(delivery));
+}
+#endif
+}
+
+Q_DECLARE_METATYPE(serial_communicator::message_status)
+
+#endif // DELIVERY_H
@@ -0,0 +1,181 @@
+/// \file emulated_link.h
+/// \brief Defines the serial_communicator::emulated_link class.
+#ifndef EMULATED_LINK_H
+#define EMULATED_LINK_H
+
+#include "utility/emulated_device.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include <chrono>
+#include <deque>
+#include <random>
+
+namespace serial_communicator {
+///
+/// \brief An in-process, full duplex link that emulates the timing and impairments of a serial line.
+/// \details Each direction is serialized at the configured baud rate with 10 bits per byte, then
+/// delayed by a fixed latency.  Bytes may be corrupted by independent bit errors, dropped
+/// independently, or dropped in bursts following a two state Gilbert-Elliott model.  Both
+/// directions use the same settings.
+///
+class emulated_link
+    : public QObject
+{
+    Q_OBJECT
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief emulated_link Creates a new unimpaired link with both ends open.
+    /// \param seed OPTIONAL The seed of the impairment random generator.
+    ///
+    emulated_link(uint32_t seed = 1);
+    ~emulated_link();
+
+    // METHODS
+    ///
+    /// \brief transmit Carries bytes written to one end towards the other end.
+    /// \param direction The direction index, 0 from A to B or 1 from B to A.
+    /// \param data The written bytes.
+    /// \param length The number of written bytes.
+    ///
+    void transmit(uint32_t direction, const uint8_t* data, uint32_t length);
+
+    // PROPERTIES
+    ///
+    /// \brief p_a Gets the first end of the link.
+    /// \return The first end of the link.
+    ///
+    QIODevice* p_a() const;
+    ///
+    /// \brief p_b Gets the second end of the link.
+    /// \return The second end of the link.
+    ///
+    QIODevice* p_b() const;
+    ///
+    /// \brief p_baud Gets the emulated baud rate.
+    /// \return The baud rate in bits per second, or 0 if serialization delay is disabled.
+    ///
+    uint32_t p_baud() const;
+    ///
+    /// \brief p_baud Sets the emulated baud rate.
+    /// \param value The baud rate in bits per second, or 0 to disable serialization delay.
+    ///
+    void p_baud(uint32_t value);
+    ///
+    /// \brief p_latency Gets the one way propagation latency.
+    /// \return The latency in microseconds.
+    ///
+    uint32_t p_latency() const;
+    ///
+    /// \brief p_latency Sets the one way propagation latency.
+    /// \param value The latency in microseconds.
+    ///
+    void p_latency(uint32_t value);
+    ///
+    /// \brief p_bit_error_rate Gets the probability that any single bit is flipped.
+    /// \return The bit error rate.
+    ///
+    double p_bit_error_rate() const;
+    ///
+    /// \brief p_bit_error_rate Sets the probability that any single bit is flipped.
+    /// \param value The bit error rate.
+    ///
+    void p_bit_error_rate(double value);
+    ///
+    /// \brief p_drop_rate Gets the probability that any single byte is dropped.
+    /// \return The byte drop rate.
+    ///
+    double p_drop_rate() const;
+    ///
+    /// \brief p_drop_rate Sets the probability that any single byte is dropped.
+    /// \param value The byte drop rate.
+    ///
+    void p_drop_rate(double value);
+    ///
+    /// \brief p_burst Gets the burst loss transition probabilities.
+    /// \param enter The per byte probability of entering a burst.
+    /// \param exit The per byte probability of leaving a burst.
+    /// \details All bytes are dropped while in a burst.
+    ///
+    void p_burst(double& enter, double& exit) const;
+    ///
+    /// \brief p_burst Sets the burst loss transition probabilities.
+    /// \param enter The per byte probability of entering a burst, or 0 to disable burst loss.
+    /// \param exit The per byte probability of leaving a burst.
+    /// \details All bytes are dropped while in a burst.
+    ///
+    void p_burst(double enter, double exit);
+
+private:
+    // STRUCTURES
+    ///
+    /// \brief A block of bytes in flight.
+    ///
+    struct in_flight
+    {
+        std::chrono::steady_clock::time_point due;  ///< The time at which the block arrives.
+        QByteArray data;                            ///< The bytes of the block.
+    };
+
+    // VARIABLES
+    ///
+    /// \brief m_ends Stores the two ends of the link.
+    ///
+    utility::emulated_device* m_ends[2];
+    ///
+    /// \brief m_in_flight Stores the blocks in flight in each direction, ordered by arrival.
+    ///
+    std::deque<in_flight> m_in_flight[2];
+    ///
+    /// \brief m_line_free Stores the time at which each direction finishes serializing its previous block.
+    ///
+    std::chrono::steady_clock::time_point m_line_free[2];
+    ///
+    /// \brief m_in_burst Stores if each direction is currently in a loss burst.
+    ///
+    bool m_in_burst[2];
+    ///
+    /// \brief m_random Stores the impairment random generator.
+    ///
+    std::mt19937 m_random;
+    ///
+    /// \brief m_timer The timer that delivers blocks once they arrive.
+    ///
+    QTimer* m_timer;
+    ///
+    /// \brief m_baud Stores the emulated baud rate.
+    ///
+    uint32_t m_baud;
+    ///
+    /// \brief m_latency Stores the one way latency in microseconds.
+    ///
+    uint32_t m_latency;
+    ///
+    /// \brief m_bit_error_rate Stores the bit error rate.
+    ///
+    double m_bit_error_rate;
+    ///
+    /// \brief m_drop_rate Stores the byte drop rate.
+    ///
+    double m_drop_rate;
+    ///
+    /// \brief m_burst_enter Stores the per byte probability of entering a burst.
+    ///
+    double m_burst_enter;
+    ///
+    /// \brief m_burst_exit Stores the per byte probability of leaving a burst.
+    ///
+    double m_burst_exit;
+
+private slots:
+    // SLOTS
+    ///
+    /// \brief deliver Delivers all blocks that have arrived.
+    ///
+    void deliver();
+};
+}
+
+#endif // EMULATED_LINK_H
@@ -0,0 +1,104 @@
+/// \file latency_histogram.h
+/// \brief Defines the serial_communicator::latency_histogram class.
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace serial_communicator {
+///
+/// \brief A log-bucketed histogram of latencies in microseconds.
+/// \details Values are grouped by power of two, and each power of two is split into 16 linear
+/// sub-buckets, giving a worst-case relative error of 6.25% over the full 64-bit range.  Recording
+/// is a single relaxed atomic increment, so histograms may be read while they are being written.
+///
+class latency_histogram
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief latency_histogram Creates a new empty histogram.
+    ///
+    latency_histogram();
+
+    // METHODS
+    ///
+    /// \brief record Records a latency value.
+    /// \param microseconds The latency to record, in microseconds.
+    ///
+    void record(uint64_t microseconds);
+    ///
+    /// \brief percentile Estimates a percentile of the recorded latencies.
+    /// \param percentile The percentile to estimate, from 0 to 100.
+    /// \return The estimated latency in microseconds, or 0 if the histogram is empty.
+    ///
+    uint64_t percentile(double percentile) const;
+    ///
+    /// \brief reset Clears all recorded values.
+    ///
+    void reset();
+
+    // PROPERTIES
+    ///
+    /// \brief p_count Gets the number of values recorded.
+    /// \return The number of values recorded.
+    ///
+    uint64_t p_count() const;
+    ///
+    /// \brief p_mean Gets the mean of the recorded values.
+    /// \return The mean latency in microseconds, or 0 if the histogram is empty.
+    ///
+    double p_mean() const;
+    ///
+    /// \brief p_max Gets the largest recorded value.
+    /// \return The largest latency in microseconds.
+    ///
+    uint64_t p_max() const;
+
+private:
+    // CONSTANTS
+    ///
+    /// \brief m_sub_bucket_bits Stores the number of bits used for linear sub-buckets in each power of two.
+    ///
+    static const uint32_t m_sub_bucket_bits = 4;
+    ///
+    /// \brief m_n_buckets Stores the total number of buckets.
+    ///
+    static const uint32_t m_n_buckets = (64 - m_sub_bucket_bits + 1) << m_sub_bucket_bits;
+
+    // VARIABLES
+    ///
+    /// \brief m_buckets Stores the count of values in each bucket.
+    ///
+    std::atomic<uint64_t> m_buckets[m_n_buckets];
+    ///
+    /// \brief m_count Stores the total number of values recorded.
+    ///
+    std::atomic<uint64_t> m_count;
+    ///
+    /// \brief m_sum Stores the sum of all values recorded.
+    ///
+    std::atomic<uint64_t> m_sum;
+    ///
+    /// \brief m_max Stores the largest value recorded.
+    ///
+    std::atomic<uint64_t> m_max;
+
+    // METHODS
+    ///
+    /// \brief bucket_index Gets the bucket that a value belongs to.
+    /// \param value The value to locate.
+    /// \return The index of the bucket.
+    ///
+    static uint32_t bucket_index(uint64_t value);
+    ///
+    /// \brief bucket_value Gets a representative value for a bucket.
+    /// \param index The index of the bucket.
+    /// \return The midpoint of the values held by the bucket.
+    ///
+    static uint64_t bucket_value(uint32_t index);
+};
+}
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,18 @@
+/// \file latency_metric.h
+/// \brief Defines the serial_communicator::latency_metric enumeration.
+#ifndef LATENCY_METRIC_H
+#define LATENCY_METRIC_H
+
+namespace serial_communicator {
+///
+/// \brief Enumerates the latencies measured by the communicator.
+///
+enum class latency_metric
+{
+  QUEUEING = 0,     ///< The time from send() until the message's first transmission.
+  RECEIPT = 1,      ///< The time from a message's last transmission until its receipt arrived.
+  DELIVERY = 2      ///< The time from parsing an inbound message until it was taken by receive().
+};
+}
+
+#endif // LATENCY_METRIC_H
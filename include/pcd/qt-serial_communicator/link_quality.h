@@ -0,0 +1,23 @@
+/// \file link_quality.h
+/// \brief Defines the serial_communicator::link_quality structure.
+#ifndef LINK_QUALITY_H
+#define LINK_QUALITY_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+///
+/// \brief A snapshot of a communicator's estimate of its link to the peer.
+/// \details Estimates are exponentially smoothed, so they follow recent conditions while ignoring
+/// single outliers.
+///
+struct link_quality
+{
+    bool up = true;                 ///< Indicates that a frame has been heard from the peer within the link timeout.
+    double frame_error_rate = 0;    ///< The smoothed fraction of received frames that were corrupt or cut short.
+    double round_trip_time = 0;     ///< The smoothed round trip time in milliseconds, or 0 if it has not been measured.
+    uint64_t link_downs = 0;        ///< The number of times the link has gone down.
+};
+}
+
+#endif // LINK_QUALITY_H
@@ -0,0 +1,51 @@
+/// \file loopback.h
+/// \brief Defines the serial_communicator::loopback class.
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include "utility/loopback_device.h"
+
+namespace serial_communicator {
+///
+/// \brief An in-process, full duplex link between two communicators.
+/// \details Bytes written to one end become readable from the other end without any serial
+/// hardware, allowing the full protocol to be run and load tested at memory speed.  Both ends are
+/// opened unbuffered on construction, so each written block is handed across as one shared chunk
+/// with no intermediate buffering.
+///
+class loopback
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief loopback Creates a new loopback with both ends open and connected.
+    ///
+    loopback();
+    ~loopback();
+
+    // PROPERTIES
+    ///
+    /// \brief p_a Gets the first end of the loopback.
+    /// \return The first end of the loopback.
+    ///
+    QIODevice* p_a() const;
+    ///
+    /// \brief p_b Gets the second end of the loopback.
+    /// \return The second end of the loopback.
+    ///
+    QIODevice* p_b() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_a Stores the first end of the loopback.
+    ///
+    utility::loopback_device* m_a;
+    ///
+    /// \brief m_b Stores the second end of the loopback.
+    ///
+    utility::loopback_device* m_b;
+};
+}
+
+#endif // LOOPBACK_H
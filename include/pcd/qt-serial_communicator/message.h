@@ -3,6 +3,7 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+#include <chrono>
 #include <cstdint>
 
 namespace serial_communicator {
@@ -46,6 +47,26 @@ public:
     /// \return The data read from the field.
     ///
     T get_field(uint16_t address) const;
+    template <typename T>
+    ///
+    /// \brief set_field Sets an array of consecutive data fields in the message.
+    /// \param address The address of the first field to write to.
+    /// \param data The array of values to write.
+    /// \param count The number of values in the array.
+    /// \details The whole array is converted to big endian in one pass using vectorized byte swapping
+    /// where available, which is far faster than setting each element individually.
+    ///
+    void set_field(uint16_t address, const T* data, uint16_t count);
+    template <typename T>
+    ///
+    /// \brief get_field Gets an array of consecutive data fields from the message.
+    /// \param address The address of the first field to read from.
+    /// \param data The array to read the values into.
+    /// \param count The number of values to read.
+    /// \details The whole array is converted from big endian in one pass using vectorized byte swapping
+    /// where available, which is far faster than getting each element individually.
+    ///
+    void get_field(uint16_t address, T* data, uint16_t count) const;
     ///
     /// \brief serialize Serializes the message into the given byte array.
     /// \param byte_array The byte array to serialize the message into.
@@ -64,6 +85,36 @@ public:
     ///
     uint8_t p_priority() const;
     ///
+    /// \brief p_priority Sets the priority of the message.
+    /// \param value The priority of the message.  Higher priorities are sent first.
+    /// \note The default value is 0.
+    ///
+    void p_priority(uint8_t value);
+    ///
+    /// \brief p_channel Gets the logical channel of the message.
+    /// \return The logical channel of the message.
+    ///
+    uint8_t p_channel() const;
+    ///
+    /// \brief p_channel Sets the logical channel of the message.
+    /// \param value The logical channel the message is sent and received on.
+    /// \note The default value is 0.
+    ///
+    void p_channel(uint8_t value);
+    ///
+    /// \brief p_receive_timestamp Gets the time at which the message's last byte was read from the serial port.
+    /// \return The monotonic time at which the message arrived, or the clock's epoch if the message was not received.
+    /// \details Comparing the timestamp with std::chrono::steady_clock::now() gives the time the message
+    /// spent waiting in the communicator and the application.
+    ///
+    std::chrono::steady_clock::time_point p_receive_timestamp() const;
+    ///
+    /// \brief p_receive_timestamp Sets the time at which the message's last byte was read from the serial port.
+    /// \param value The monotonic time at which the message arrived.
+    /// \note The communicator sets this on every message it receives.
+    ///
+    void p_receive_timestamp(std::chrono::steady_clock::time_point value);
+    ///
     /// \brief p_data_length Gets the data length of the message in bytes.
     /// \return The data length of the message in bytes.
     ///
@@ -73,6 +124,16 @@ public:
     /// \return The total length of the message in bytes.
     ///
     uint32_t p_message_length() const;
+    ///
+    /// \brief p_data Gets direct access to the message's data fields.
+    /// \return A pointer to the message's data, which is p_data_length() bytes long and stored big endian.
+    ///
+    uint8_t* p_data();
+    ///
+    /// \brief p_data Gets direct read access to the message's data fields.
+    /// \return A pointer to the message's data, which is p_data_length() bytes long and stored big endian.
+    ///
+    const uint8_t* p_data() const;
 
 private:
     // VARIABLES
@@ -85,6 +146,14 @@ private:
     ///
     uint8_t m_priority;
     ///
+    /// \brief m_channel The message's logical channel.
+    ///
+    uint8_t m_channel;
+    ///
+    /// \brief m_receive_timestamp The time at which the message arrived.
+    ///
+    std::chrono::steady_clock::time_point m_receive_timestamp;
+    ///
     /// \brief m_data_length The message's data length, in bytes.
     ///
     uint16_t m_data_length;
@@ -13,7 +13,9 @@ enum class message_status
   SENT = 1,         ///< The message has been sent, and no receipt was required.
   VERIFYING = 2,    ///< The message has been sent, and the communicator is verifying that the message was received.
   RECEIVED = 3,     ///< The message was sent, and was verified as received from the receiving communicator.
-  NOTRECEIVED = 4   ///< The message was sent, but no verification was received.
+  NOTRECEIVED = 4,  ///< The message was sent, but no verification was received.
+  CANCELLED = 5,    ///< The message was withdrawn from the transmit queue before it was sent or verified.
+  DROPPED = 6       ///< The message was dropped from a full transmit queue to make room for another.
 };
 }
 
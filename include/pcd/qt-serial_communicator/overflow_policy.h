@@ -0,0 +1,18 @@
+/// \file overflow_policy.h
+/// \brief Defines the serial_communicator::overflow_policy enumeration.
+#ifndef OVERFLOW_POLICY_H
+#define OVERFLOW_POLICY_H
+
+namespace serial_communicator {
+///
+/// \brief Enumerates what happens when a message arrives at a full queue.
+///
+enum class overflow_policy
+{
+  REJECT = 0,               ///< The new message is refused.
+  DROP_OLDEST = 1,          ///< The oldest queued messages are dropped to make room.
+  DROP_LOWEST_PRIORITY = 2  ///< Queued messages of lower priority than the new message are dropped to make room, newest first.  If there are none, the new message is refused.
+};
+}
+
+#endif // OVERFLOW_POLICY_H
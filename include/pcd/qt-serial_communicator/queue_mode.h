@@ -0,0 +1,17 @@
+/// \file queue_mode.h
+/// \brief Defines the serial_communicator::queue_mode enumeration.
+#ifndef QUEUE_MODE_H
+#define QUEUE_MODE_H
+
+namespace serial_communicator {
+///
+/// \brief Enumerates the ways the transmit and receive queues are bounded.
+///
+enum class queue_mode
+{
+  FIXED = 0,    ///< Each queue holds at most p_queue_size messages.
+  ELASTIC = 1   ///< Each queue grows as needed, and holds at most p_queue_memory_limit bytes of messages.
+};
+}
+
+#endif // QUEUE_MODE_H
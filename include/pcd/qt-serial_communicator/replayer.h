@@ -0,0 +1,82 @@
+/// \file replayer.h
+/// \brief Defines the serial_communicator::replayer class.
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+#include "capture.h"
+
+namespace serial_communicator {
+
+class communicator;
+
+///
+/// \brief Feeds a capture file back through a communicator's receive parser.
+/// \details Captured bytes of one direction are handed to the communicator's parser as if they had
+/// been read from the serial port, and all resulting messages are taken from the receive queue and
+/// discarded.  Replaying at maximum speed measures the parser's throughput on realistic traffic.
+///
+class replayer
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief replayer Creates a new replayer instance.
+    /// \param communicator The communicator whose parser will receive the replayed bytes.
+    ///
+    replayer(communicator* communicator);
+
+    // METHODS
+    ///
+    /// \brief run Replays a capture file.
+    /// \param path The path of the capture file.
+    /// \param realtime TRUE to reproduce the original timing between records, or FALSE to replay at maximum speed.
+    /// \param direction OPTIONAL The direction of captured bytes to replay.
+    /// \return TRUE if the whole file was replayed, otherwise FALSE.
+    ///
+    bool run(const std::string& path, bool realtime, capture::direction direction = capture::direction::RX);
+
+    // PROPERTIES
+    ///
+    /// \brief p_bytes Gets the number of bytes replayed by the last run.
+    /// \return The number of bytes replayed.
+    ///
+    uint64_t p_bytes() const;
+    ///
+    /// \brief p_messages Gets the number of messages delivered to the receive queue by the last run.
+    /// \return The number of messages delivered.
+    ///
+    uint64_t p_messages() const;
+    ///
+    /// \brief p_elapsed Gets the wall time of the last run.
+    /// \return The wall time of the last run in seconds.
+    ///
+    double p_elapsed() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_communicator Stores the communicator being replayed into.
+    ///
+    communicator* m_communicator;
+    ///
+    /// \brief m_bytes Stores the number of bytes replayed by the last run.
+    ///
+    uint64_t m_bytes;
+    ///
+    /// \brief m_messages Stores the number of messages delivered by the last run.
+    ///
+    uint64_t m_messages;
+    ///
+    /// \brief m_elapsed Stores the wall time of the last run in seconds.
+    ///
+    double m_elapsed;
+
+    // METHODS
+    ///
+    /// \brief drain Parses all complete frames and discards the resulting messages.
+    ///
+    void drain();
+};
+}
+
+#endif // REPLAYER_H
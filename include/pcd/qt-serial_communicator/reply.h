@@ -0,0 +1,181 @@
+/// \file reply.h
+/// \brief Defines the serial_communicator::reply class.
+#ifndef REPLY_H
+#define REPLY_H
+
+#include "message.h"
+#include "reply_status.h"
+
+#include <QObject>
+#include <QMetaType>
+#include <QTimer>
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#endif
+
+namespace serial_communicator {
+class communicator;
+///
+/// \brief A handle for awaiting the response to a remote call.
+/// \details A reply is returned by communicator::call() and is shared between the caller and the
+/// communicator, so it remains valid for as long as either holds it.  It completes once the
+/// response arrives, the call times out, or the request cannot be delivered.  If the communicator
+/// is destroyed first, the reply completes as NOT_DELIVERED.
+///
+class reply
+    : public QObject
+{
+    Q_OBJECT
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief reply Creates a new reply instance with a PENDING status.
+    /// \param correlation The correlation ID of the call.
+    ///
+    reply(uint32_t correlation);
+    ~reply();
+
+    // METHODS
+    ///
+    /// \brief wait Blocks until the reply completes.
+    /// \return The final status of the reply.
+    /// \details Do not call this from the communicator's thread, since the communicator cannot
+    /// make progress while its thread is blocked.
+    ///
+    reply_status wait() const;
+    ///
+    /// \brief take Takes the response message.
+    /// \return The response message, or nullptr if there is none or it was already taken.  The calling code takes ownership of the message pointer.
+    ///
+    message* take();
+    ///
+    /// \brief on_complete Registers a callback for when the reply completes.
+    /// \param callback The callback, which receives the final status of the reply.
+    /// \details If the reply has already completed, the callback is invoked immediately.  Otherwise
+    /// it is invoked on the communicator's thread from within its event processing.
+    ///
+    void on_complete(std::function<void(reply_status)> callback);
+
+    // PROPERTIES
+    ///
+    /// \brief p_correlation Gets the correlation ID of the call.
+    /// \return The correlation ID of the call.
+    ///
+    uint32_t p_correlation() const;
+    ///
+    /// \brief p_status Gets the current status of the reply.
+    /// \return The current status of the reply.
+    ///
+    reply_status p_status() const;
+    ///
+    /// \brief p_future Gets a future that resolves with the final status of the reply.
+    /// \return The future.
+    ///
+    std::shared_future<reply_status> p_future() const;
+
+signals:
+    // SIGNALS
+    ///
+    /// \brief completed Emitted once when the reply completes.
+    /// \param status The final status of the reply.
+    ///
+    void completed(serial_communicator::reply_status status);
+
+private:
+    // FRIENDS
+    friend class communicator;
+
+    // VARIABLES
+    ///
+    /// \brief m_correlation Stores the correlation ID of the call.
+    ///
+    uint32_t m_correlation;
+    ///
+    /// \brief m_mutex Protects the status, response, and callbacks.
+    ///
+    mutable std::mutex m_mutex;
+    ///
+    /// \brief m_status Stores the current status of the reply.
+    ///
+    reply_status m_status;
+    ///
+    /// \brief m_response Stores the response message until it is taken.
+    ///
+    message* m_response;
+    ///
+    /// \brief m_promise Stores the promise of the final status.
+    ///
+    std::promise<reply_status> m_promise;
+    ///
+    /// \brief m_future Stores the future of the final status.
+    ///
+    std::shared_future<reply_status> m_future;
+    ///
+    /// \brief m_callbacks Stores the callbacks waiting for completion.
+    ///
+    std::vector<std::function<void(reply_status)>> m_callbacks;
+
+    // METHODS
+    ///
+    /// \brief complete Completes the reply.
+    /// \param status The final status.
+    /// \param response The response message, or nullptr.  The reply takes ownership of the message pointer.
+    ///
+    void complete(reply_status status, message* response);
+};
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+///
+/// \brief Suspends a coroutine until a reply completes.
+/// \details The coroutine is resumed from the communicator's event loop.  The co_await expression
+/// yields the response message, which the coroutine then owns, or nullptr if the call failed.
+///
+class reply_awaiter
+{
+public:
+    reply_awaiter(std::shared_ptr<reply> reply)
+        : m_reply(std::move(reply))
+    {
+    }
+    bool await_ready() const
+    {
+        return m_reply->p_status() != reply_status::PENDING;
+    }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        reply* target = m_reply.get();
+        m_reply->on_complete([target, handle](reply_status)
+        {
+            QTimer::singleShot(0, target, [handle]() { handle.resume(); });
+        });
+    }
+    message* await_resume()
+    {
+        return m_reply->take();
+    }
+
+private:
+    std::shared_ptr<reply> m_reply;
+};
+///
+/// \brief operator co_await Allows a coroutine to co_await the result of communicator::call().
+/// \param reply The reply to await.
+/// \return An awaiter that yields the response message.
+///
+inline reply_awaiter operator co_await(std::shared_ptr<reply> reply)
+{
+    return reply_awaiter(std::move(reply));
+}
+#endif
+}
+
+Q_DECLARE_METATYPE(serial_communicator::reply_status)
+
+#endif // REPLY_H
@@ -0,0 +1,19 @@
+/// \file reply_status.h
+/// \brief Defines the serial_communicator::reply_status enumeration.
+#ifndef REPLY_STATUS_H
+#define REPLY_STATUS_H
+
+namespace serial_communicator {
+///
+/// \brief Enumerates the states of a remote call's reply.
+///
+enum class reply_status
+{
+  PENDING = 0,          ///< The call is waiting for its response.
+  RECEIVED = 1,         ///< The response was received.
+  TIMED_OUT = 2,        ///< The timeout elapsed without a response.
+  NOT_DELIVERED = 3     ///< The request could not be delivered.
+};
+}
+
+#endif // REPLY_STATUS_H
@@ -0,0 +1,171 @@
+/// \file schema.h
+/// \brief Defines the serial_communicator::schema facility for compile-time message layouts.
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include "message.h"
+#include "utility/byte_order.h"
+
+namespace serial_communicator {
+///
+/// \brief Binds one member of a structure to a message field.
+/// \tparam S The structure type.
+/// \tparam T The type of the member.  Must be an arithmetic type.
+/// \tparam M A pointer to the member.
+///
+template <typename S, typename T, T S::*M>
+struct field
+{
+    static_assert(std::is_arithmetic<T>::value, "schema fields must be arithmetic types");
+    ///
+    /// \brief size The size of the field in bytes.
+    ///
+    static const uint32_t size = sizeof(T);
+    ///
+    /// \brief store Writes the member into a message's data.
+    /// \param data The message data at the field's address.
+    /// \param structure The structure to read the member from.
+    ///
+    static void store(uint8_t* data, const S& structure)
+    {
+        utility::store_big_endian<T>(data, structure.*M);
+    }
+    ///
+    /// \brief load Reads the member from a message's data.
+    /// \param data The message data at the field's address.
+    /// \param structure The structure to write the member into.
+    ///
+    static void load(const uint8_t* data, S& structure)
+    {
+        structure.*M = utility::load_big_endian<T>(data);
+    }
+};
+
+namespace utility {
+///
+/// \brief Computes the total size of a list of fields and encodes or decodes them at consecutive offsets.
+/// \details The offset of every field is a template argument, so encoding and decoding inline into
+/// straight-line byte swapping loads and stores.
+///
+template <uint32_t offset, typename... F>
+struct field_list;
+template <uint32_t offset>
+struct field_list<offset>
+{
+    static const uint32_t length = offset;
+    template <typename S>
+    static void store(uint8_t*, const S&)
+    {
+    }
+    template <typename S>
+    static void load(const uint8_t*, S&)
+    {
+    }
+};
+template <uint32_t offset, typename F, typename... R>
+struct field_list<offset, F, R...>
+{
+    static const uint32_t length = field_list<offset + F::size, R...>::length;
+    template <typename S>
+    static void store(uint8_t* data, const S& structure)
+    {
+        F::store(data + offset, structure);
+        field_list<offset + F::size, R...>::store(data, structure);
+    }
+    template <typename S>
+    static void load(const uint8_t* data, S& structure)
+    {
+        F::load(data + offset, structure);
+        field_list<offset + F::size, R...>::load(data, structure);
+    }
+};
+}
+
+///
+/// \brief Defines the message ID and field layout of a structure.
+/// \tparam ID The message ID bound to the structure.
+/// \tparam F The fields of the structure, in wire order.
+/// \details Specialize serial_communicator::schema for a structure by deriving from this type:
+/// \code
+/// struct pose { double x; double y; float heading; };
+/// namespace serial_communicator {
+/// template <> struct schema<pose>
+///     : schema_definition<0x0010,
+///         field<pose, double, &pose::x>,
+///         field<pose, double, &pose::y>,
+///         field<pose, float, &pose::heading>> {};
+/// }
+/// \endcode
+/// Fields are packed in order with no padding.  The total length is checked at compile time.
+///
+template <uint16_t ID, typename... F>
+struct schema_definition
+{
+    ///
+    /// \brief id The message ID bound to the structure.
+    ///
+    static const uint16_t id = ID;
+    ///
+    /// \brief data_length The total length of the fields in bytes.
+    ///
+    static const uint32_t data_length = utility::field_list<0, F...>::length;
+    static_assert(data_length <= 0xFFFF, "schema data length exceeds the maximum message data length");
+    ///
+    /// \brief store Writes all fields of a structure into message data.
+    /// \param data The message data.
+    /// \param structure The structure to encode.
+    ///
+    template <typename S>
+    static void store(uint8_t* data, const S& structure)
+    {
+        utility::field_list<0, F...>::store(data, structure);
+    }
+    ///
+    /// \brief load Reads all fields of a structure from message data.
+    /// \param data The message data.
+    /// \param structure The structure to decode into.
+    ///
+    template <typename S>
+    static void load(const uint8_t* data, S& structure)
+    {
+        utility::field_list<0, F...>::load(data, structure);
+    }
+};
+
+///
+/// \brief Binds a structure to a message ID and field layout.  Specialize for each structure using schema_definition.
+///
+template <typename S>
+struct schema;
+
+///
+/// \brief encode Creates a message from a structure using its schema.
+/// \param structure The structure to encode.
+/// \return A new message.  The calling code takes ownership of the message pointer.
+///
+template <typename S>
+message* encode(const S& structure)
+{
+    message* output = new message(schema<S>::id, static_cast<uint16_t>(schema<S>::data_length));
+    schema<S>::store(output->p_data(), structure);
+    return output;
+}
+///
+/// \brief decode Reads a structure from a message using its schema.
+/// \param message The message to decode.
+/// \param structure The structure to decode into.
+/// \return TRUE if the message's ID and data length match the schema, otherwise FALSE.
+///
+template <typename S>
+bool decode(const message& message, S& structure)
+{
+    if(message.p_id() != schema<S>::id || message.p_data_length() != schema<S>::data_length)
+    {
+        return false;
+    }
+    schema<S>::load(message.p_data(), structure);
+    return true;
+}
+}
+
+#endif // SCHEMA_H
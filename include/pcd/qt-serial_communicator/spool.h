@@ -0,0 +1,229 @@
+/// \file spool.h
+/// \brief Defines the serial_communicator::spool class.
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include "message.h"
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <set>
+
+namespace serial_communicator {
+///
+/// \brief Persists outbound messages in a memory-mapped log file, so that they survive link outages and restarts.
+/// \details The spool file is a log of records, each holding a 1 byte marker, a 1 byte state, a 1 byte
+/// receipt flag, a 1 byte channel, a 4 byte length, the serialized message, and a CRC-32 of everything
+/// after the state.  Records are appended in place through the memory map and released by clearing
+/// their state byte, so each message is written once.  Once every record has been released, the log
+/// starts over from the beginning of the file.  When the log reaches the end of the file and at least
+/// half of it precedes the first pending record, the pending part is written to a new file that
+/// atomically replaces the old one, instead of growing the file.  On opening, the log is scanned once
+/// and every record that was not released is returned to the queue of waiting records.  A record cut
+/// short by a crash fails its CRC and ends the log.
+/// \note Writes reach the operating system immediately and survive a crash of the process.  Call
+/// sync(), or enable p_sync_on_append, to also survive a crash of the operating system.
+///
+class spool
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief spool Opens a spool file, creating it if it does not exist.
+    /// \param path The path of the spool file.
+    /// \details Records left pending by a previous run are recovered as waiting records.
+    ///
+    spool(const QString& path);
+    ~spool();
+
+    // METHODS
+    ///
+    /// \brief append Appends a message to the log.
+    /// \param message The message to append.
+    /// \param receipt_required Indicates that the message requires a receipt.
+    /// \param waiting TRUE if the message waits in the spool to be taken, or FALSE if the caller already holds it.
+    /// \return The record's ID, or 0 if the record could not be written, such as when the file would exceed p_max_size.
+    ///
+    uint64_t append(const message& message, bool receipt_required, bool waiting);
+    ///
+    /// \brief peek Gets the length of the message that take() would return next for a channel.
+    /// \param channel The message channel.
+    /// \param length Returns the message's total length in bytes.
+    /// \return TRUE if a record of the channel is waiting, otherwise FALSE.
+    ///
+    bool peek(uint8_t channel, uint32_t& length) const;
+    ///
+    /// \brief take Takes the waiting record of a channel with the highest priority, followed by oldest.
+    /// \param channel The message channel.
+    /// \param record Returns the record's ID.
+    /// \param receipt_required Returns if the message requires a receipt.
+    /// \return The message, which the caller owns, or nullptr if no record of the channel is waiting.
+    /// \details The record stays in the log until it is released.
+    ///
+    message* take(uint8_t channel, uint64_t& record, bool& receipt_required);
+    ///
+    /// \brief release Marks a record as done, so that it is never recovered.
+    /// \param record The record's ID.
+    ///
+    void release(uint64_t record);
+    ///
+    /// \brief sync Writes the log to disk.
+    ///
+    void sync();
+
+    // PROPERTIES
+    ///
+    /// \brief p_is_open Gets if the spool file is open and mapped.
+    /// \return TRUE if the file is open, otherwise FALSE.
+    /// \details The spool closes and forgets its records if its file cannot be mapped again after growing or compacting.
+    ///
+    bool p_is_open() const;
+    ///
+    /// \brief p_pending Gets the number of records that have not been released.
+    /// \return The number of pending records.
+    ///
+    uint32_t p_pending() const;
+    ///
+    /// \brief p_waiting Gets the number of records waiting to be taken.
+    /// \return The number of waiting records.
+    ///
+    uint32_t p_waiting() const;
+    ///
+    /// \brief p_waiting Gets the number of records of a channel waiting to be taken.
+    /// \param channel The message channel.
+    /// \return The number of waiting records.
+    ///
+    uint32_t p_waiting(uint8_t channel) const;
+    ///
+    /// \brief p_sync_on_append Gets if every append is written to disk before returning.
+    /// \return TRUE if appends are synchronous, otherwise FALSE.
+    ///
+    bool p_sync_on_append() const;
+    ///
+    /// \brief p_sync_on_append Sets if every append is written to disk before returning.
+    /// \param value TRUE to write each append to disk, otherwise FALSE.
+    /// \note The default value is FALSE, since writing to disk for each message is slow.
+    ///
+    void p_sync_on_append(bool value);
+    ///
+    /// \brief p_max_size Gets the size the spool file may grow to.
+    /// \return The maximum file size in bytes, or 0 if the size is unlimited.
+    ///
+    qint64 p_max_size() const;
+    ///
+    /// \brief p_max_size Sets the size the spool file may grow to.
+    /// \param value The maximum file size in bytes, or 0 for no limit.
+    /// \details Once the pending records fill the file, append() fails, and the communicator falls back
+    /// to its overflow policy.
+    /// \note The default value is 64 MiB.
+    ///
+    void p_max_size(qint64 value);
+
+private:
+    // CONSTANTS
+    ///
+    /// \brief m_marker Stores the byte that begins every record.
+    ///
+    const uint8_t m_marker = 0xA5;
+    ///
+    /// \brief m_prefix_length Stores the length of a record before its serialized message.
+    ///
+    const uint32_t m_prefix_length = 8;
+    ///
+    /// \brief m_initial_size Stores the size of a new spool file in bytes.
+    ///
+    const qint64 m_initial_size = 65536;
+
+    // VARIABLES
+    ///
+    /// \brief m_file Stores the spool file.
+    ///
+    QFile m_file;
+    ///
+    /// \brief m_data Stores the memory map of the spool file.
+    ///
+    uchar* m_data;
+    ///
+    /// \brief m_size Stores the size of the memory map in bytes.
+    ///
+    qint64 m_size;
+    ///
+    /// \brief m_end Stores the offset at which the next record is appended.
+    ///
+    qint64 m_end;
+    ///
+    /// \brief m_base Stores the position of the file's first byte in the log.
+    /// \details Records are identified by their position in the log, which never changes, while their
+    /// offset in the file moves back whenever the log is compacted or starts over.
+    ///
+    uint64_t m_base;
+    ///
+    /// \brief m_pending Stores the positions of the records that have not been released.
+    ///
+    std::set<uint64_t> m_pending;
+    ///
+    /// \brief m_waiting Stores the waiting records of each channel, by inverted priority and position.
+    ///
+    std::map<uint8_t, std::set<std::pair<uint8_t, uint64_t>>> m_waiting;
+    ///
+    /// \brief m_n_waiting Stores the number of waiting records.
+    ///
+    uint32_t m_n_waiting;
+    ///
+    /// \brief m_sync_on_append Stores if every append is written to disk before returning.
+    ///
+    bool m_sync_on_append;
+    ///
+    /// \brief m_max_size Stores the size the spool file may grow to, or 0 if unlimited.
+    ///
+    qint64 m_max_size;
+
+    // METHODS
+    ///
+    /// \brief recover Scans the log for pending records.
+    ///
+    void recover();
+    ///
+    /// \brief wait Adds a record to the waiting records of its channel.
+    /// \param position The position of the record.
+    ///
+    void wait(uint64_t position);
+    ///
+    /// \brief reserve Compacts or grows the spool file until a record of a given length fits.
+    /// \param length The length of the record.
+    /// \return TRUE if the record fits, otherwise FALSE.
+    ///
+    bool reserve(qint64 length);
+    ///
+    /// \brief compact Drops the released records before the first pending record from the file.
+    /// \return TRUE if the log was compacted, otherwise FALSE.
+    ///
+    bool compact();
+    ///
+    /// \brief remap Maps the spool file again after it was replaced or resized.
+    ///
+    void remap();
+    ///
+    /// \brief close Unmaps and closes the spool file after it could not be mapped again, and forgets all records.
+    ///
+    void close();
+    ///
+    /// \brief record Gets a record in the memory map.
+    /// \param position The position of the record.
+    /// \return The record's bytes.
+    ///
+    uchar* record(uint64_t position) const;
+    ///
+    /// \brief crc32 Calculates the CRC-32 of a block of bytes.
+    /// \param data The bytes.
+    /// \param length The number of bytes.
+    /// \return The CRC-32.
+    ///
+    static uint32_t crc32(const uint8_t* data, uint32_t length);
+};
+}
+
+#endif // SPOOL_H
@@ -0,0 +1,57 @@
+/// \file statistics.h
+/// \brief Defines the serial_communicator::statistics structure.
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+///
+/// \brief A snapshot of a communicator's runtime counters.
+/// \details Counters are cumulative since the communicator was created.  Rates are measured
+/// over the most recent statistics interval.
+///
+struct statistics
+{
+    // TRANSMIT
+    uint64_t tx_frames = 0;                 ///< The number of frames written to the serial port, including receipts.
+    uint64_t tx_bytes = 0;                  ///< The number of bytes written to the serial port, including escapes.
+    uint64_t tx_escaped_bytes = 0;          ///< The number of escape bytes inserted into written frames.
+    uint64_t tx_retransmissions = 0;        ///< The number of times a message was transmitted again after its first transmission.
+    uint64_t tx_rejected = 0;               ///< The number of messages rejected by send() because the transmit queue was full.
+    uint64_t tx_not_received = 0;           ///< The number of messages that exhausted their transmissions without a receipt.
+    uint64_t tx_cancelled = 0;              ///< The number of messages withdrawn from the transmit queue.
+    uint64_t tx_evicted = 0;                ///< The number of queued messages dropped by the overflow policy to make room for another.
+    uint64_t tx_spooled = 0;                ///< The number of messages that overflowed into the spool rather than the transmit queue.
+    uint64_t tx_compressed = 0;             ///< The number of frames transmitted with a compressed payload.
+    uint64_t tx_compression_saved = 0;      ///< The number of payload bytes saved by compression, before escaping.
+    uint64_t tx_delta = 0;                  ///< The number of frames transmitted with a delta encoded payload.
+    uint64_t tx_delta_saved = 0;            ///< The number of payload bytes saved by delta encoding, before compression and escaping.
+    uint64_t tx_piggybacked_receipts = 0;   ///< The number of receipts carried in extension blocks rather than in their own frames.
+    uint64_t tx_credit_stalls = 0;          ///< The number of spins in which a ready message was held back for lack of the receiver's credits.
+    uint64_t tx_credit_updates = 0;         ///< The number of frames sent only to advertise newly freed receive queue capacity.
+    uint32_t tx_queue_high_water = 0;       ///< The largest number of messages held in the transmit queue at once.
+    double tx_frames_per_second = 0;        ///< The transmitted frame rate over the last statistics interval.
+    double tx_bytes_per_second = 0;         ///< The transmitted byte rate over the last statistics interval.
+
+    // RECEIVE
+    uint64_t rx_frames = 0;                 ///< The number of complete frames parsed from the serial port, including receipts.
+    uint64_t rx_bytes = 0;                  ///< The number of bytes read from the serial port, including escapes.
+    uint64_t rx_discarded_bytes = 0;        ///< The number of bytes discarded while searching for a header byte.
+    uint64_t rx_checksum_failures = 0;      ///< The number of complete frames that failed checksum validation.
+    uint64_t rx_header_failures = 0;        ///< The number of frames discarded because their header checksum failed.
+    uint64_t rx_oversize = 0;               ///< The number of frames discarded because their data length exceeded the maximum.
+    uint64_t rx_truncated = 0;              ///< The number of frames discarded because the next header arrived before they ended.
+    uint64_t rx_dropped = 0;                ///< The number of valid messages dropped because the receive queue was full.
+    uint64_t rx_evicted = 0;                ///< The number of queued messages dropped by the overflow policy to make room for another.
+    uint64_t rx_decompression_failures = 0; ///< The number of frames whose compressed payload could not be decompressed.
+    uint64_t rx_delta_misses = 0;           ///< The number of delta encoded frames whose base was not cached.
+    uint64_t rx_unmatched_responses = 0;    ///< The number of responses discarded because their call had already finished.
+    uint64_t rx_filtered = 0;               ///< The number of valid messages discarded by the receive filter.
+    uint32_t rx_queue_high_water = 0;       ///< The largest number of messages held in the receive queue at once.
+    double rx_frames_per_second = 0;        ///< The received frame rate over the last statistics interval.
+    double rx_bytes_per_second = 0;         ///< The received byte rate over the last statistics interval.
+};
+}
+
+#endif // STATISTICS_H
@@ -0,0 +1,62 @@
+/// \file byte_order.h
+/// \brief Defines the serial_communicator::utility big endian load and store functions.
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Maps a scalar type to the unsigned integer of the same size.
+///
+template <uint32_t size>
+struct unsigned_of;
+template <> struct unsigned_of<1> { typedef uint8_t type; };
+template <> struct unsigned_of<2> { typedef uint16_t type; };
+template <> struct unsigned_of<4> { typedef uint32_t type; };
+template <> struct unsigned_of<8> { typedef uint64_t type; };
+
+///
+/// \brief store_big_endian Writes a scalar to a byte array in big endian order.
+/// \param destination The byte array to write to.  No alignment is required.
+/// \param value The scalar to write.
+///
+template <typename T>
+inline void store_big_endian(uint8_t* destination, T value)
+{
+    static_assert(std::is_arithmetic<T>::value, "only arithmetic types can be stored");
+    typedef typename unsigned_of<sizeof(T)>::type bits_type;
+    bits_type bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    // Write the most significant byte first, whatever the host order.
+    for(uint32_t i = 0; i < sizeof(T); i++)
+    {
+        destination[i] = static_cast<uint8_t>(bits >> (8 * (sizeof(T) - 1 - i)));
+    }
+}
+///
+/// \brief load_big_endian Reads a scalar from a byte array in big endian order.
+/// \param source The byte array to read from.  No alignment is required.
+/// \return The scalar read.
+///
+template <typename T>
+inline T load_big_endian(const uint8_t* source)
+{
+    static_assert(std::is_arithmetic<T>::value, "only arithmetic types can be loaded");
+    typedef typename unsigned_of<sizeof(T)>::type bits_type;
+    // Read the most significant byte first, whatever the host order.
+    bits_type bits = 0;
+    for(uint32_t i = 0; i < sizeof(T); i++)
+    {
+        bits = static_cast<bits_type>((static_cast<uint64_t>(bits) << 8) | source[i]);
+    }
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+}}
+
+#endif // BYTE_ORDER_H
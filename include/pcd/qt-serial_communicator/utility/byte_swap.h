@@ -0,0 +1,23 @@
+/// \file byte_swap.h
+/// \brief Defines the serial_communicator::utility bulk byte swapping functions.
+#ifndef BYTE_SWAP_H
+#define BYTE_SWAP_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief copy_big_endian Copies an array of scalars between host order and big endian order.
+/// \param destination The array to write to.  No alignment is required.
+/// \param source The array to read from.  No alignment is required.  Must not overlap the destination.
+/// \param element_size The size of each scalar in bytes.  Must be 1, 2, 4, or 8.
+/// \param count The number of scalars to copy.
+/// \details Byte swapping is its own inverse, so the same function converts in either direction.
+/// On big endian hosts this is a plain memcpy.  On x86 hosts the swap uses SSSE3 or AVX2 byte
+/// shuffles when the processor supports them, selected once at runtime.
+///
+void copy_big_endian(uint8_t* destination, const uint8_t* source, uint32_t element_size, uint32_t count);
+}}
+
+#endif // BYTE_SWAP_H
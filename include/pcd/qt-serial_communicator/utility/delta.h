@@ -0,0 +1,37 @@
+/// \file delta.h
+/// \brief Defines the serial_communicator::utility delta encoding functions.
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief delta_encode Encodes data as an XOR run-length diff against a base.
+/// \param base The base the data is diffed against.
+/// \param base_length The length of the base.  The base is treated as zero beyond its length.
+/// \param data The data to encode.
+/// \param length The length of the data.
+/// \param destination The buffer to write the diff to.
+/// \param capacity The size of the destination buffer.
+/// \return The size of the diff, or 0 if it would not fit in the destination.
+/// \details The diff is a series of runs, each made of a count of unchanged bytes, a count of
+/// changed bytes, and the XOR of each changed byte with the base.  Trailing unchanged bytes are
+/// omitted.
+///
+uint32_t delta_encode(const uint8_t* base, uint32_t base_length, const uint8_t* data, uint32_t length, uint8_t* destination, uint32_t capacity);
+///
+/// \brief delta_decode Reconstructs data from a diff written by delta_encode.
+/// \param base The base the data was diffed against.
+/// \param base_length The length of the base.
+/// \param diff The diff.
+/// \param diff_length The length of the diff.
+/// \param destination The buffer to write the reconstructed data to.
+/// \param length The length of the reconstructed data.
+/// \return TRUE if the data was reconstructed, or FALSE if the diff is malformed.
+///
+bool delta_decode(const uint8_t* base, uint32_t base_length, const uint8_t* diff, uint32_t diff_length, uint8_t* destination, uint32_t length);
+}}
+
+#endif // DELTA_H
@@ -0,0 +1,82 @@
+/// \file delta_cache.h
+/// \brief Defines the serial_communicator::utility::delta_cache class.
+#ifndef DELTA_CACHE_H
+#define DELTA_CACHE_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Stores recent payloads per message ID to serve as delta encoding bases.
+///
+class delta_cache
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief delta_cache Creates a new delta_cache instance.
+    /// \param depth The number of payloads kept per message ID.
+    ///
+    delta_cache(uint8_t depth);
+
+    // METHODS
+    ///
+    /// \brief store Adds a payload for a message ID, evicting the oldest if the ID is full.
+    /// \param id The message ID.
+    /// \param sequence_number The sequence number of the frame that carried the payload.
+    /// \param data The payload.
+    /// \param length The length of the payload.
+    ///
+    void store(uint16_t id, uint32_t sequence_number, const uint8_t* data, uint16_t length);
+    ///
+    /// \brief find Gets the payload carried by a specific frame.
+    /// \param id The message ID.
+    /// \param sequence_number The sequence number of the frame.
+    /// \return The payload, or nullptr if it is not cached.
+    ///
+    const std::vector<uint8_t>* find(uint16_t id, uint32_t sequence_number) const;
+    ///
+    /// \brief latest Gets the most recently stored payload for a message ID.
+    /// \param id The message ID.
+    /// \param sequence_number Returns the sequence number of the frame that carried the payload.
+    /// \return The payload, or nullptr if nothing is cached for the ID.
+    ///
+    const std::vector<uint8_t>* latest(uint16_t id, uint32_t& sequence_number) const;
+    ///
+    /// \brief erase Removes all payloads for a message ID.
+    /// \param id The message ID.
+    ///
+    void erase(uint16_t id);
+    ///
+    /// \brief clear Removes all payloads.
+    ///
+    void clear();
+
+private:
+    // STRUCTURES
+    ///
+    /// \brief A cached payload.
+    ///
+    struct entry
+    {
+        uint32_t sequence_number;   ///< The sequence number of the frame that carried the payload.
+        std::vector<uint8_t> data;  ///< The payload.
+    };
+
+    // VARIABLES
+    ///
+    /// \brief m_depth Stores the number of payloads kept per message ID.
+    ///
+    uint8_t m_depth;
+    ///
+    /// \brief m_entries Stores the cached payloads of each message ID, oldest first.
+    ///
+    std::map<uint16_t, std::deque<entry>> m_entries;
+};
+}}
+
+#endif // DELTA_CACHE_H
@@ -0,0 +1,47 @@
+/// \file emulated_device.h
+/// \brief Defines the serial_communicator::utility::emulated_device class.
+#ifndef EMULATED_DEVICE_H
+#define EMULATED_DEVICE_H
+
+#include "loopback_device.h"
+
+namespace serial_communicator {
+
+class emulated_link;
+
+namespace utility {
+///
+/// \brief One end of an emulated_link.
+/// \details Bytes written to the device are handed to the link, which impairs and delays them
+/// before delivering them to the other end.
+///
+class emulated_device
+    : public loopback_device
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief emulated_device Creates a new emulated_device instance.
+    /// \param link The link that carries written bytes.
+    /// \param direction The index of the direction that this device writes into.
+    ///
+    emulated_device(emulated_link* link, uint32_t direction);
+
+protected:
+    // QIODEVICE OVERRIDES
+    qint64 writeData(const char* data, qint64 length) override;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_link Stores the link that carries written bytes.
+    ///
+    emulated_link* m_link;
+    ///
+    /// \brief m_direction Stores the index of the direction that this device writes into.
+    ///
+    uint32_t m_direction;
+};
+}}
+
+#endif // EMULATED_DEVICE_H
@@ -0,0 +1,519 @@
+/// \file frame_engine.h
+/// \brief Defines the serial_communicator::utility::frame_engine class.
+#ifndef FRAME_ENGINE_H
+#define FRAME_ENGINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Frames, escapes, and checksums the serial protocol's packets, without depending on Qt.
+/// \details The engine escapes outgoing packets for a transport, and splits received bytes back into
+/// complete, unescaped frames.  Its collaborators are template parameters, so every call resolves at
+/// compile time and the engine runs the same in the communicator, a benchmark, or a bare test:
+/// - Transport provides write(const uint8_t* data, uint32_t length), which is given each escaped packet.
+/// - Clock provides now() and a time_point type, and timestamps received bytes that arrive without one.
+/// - Allocator allocates bytes, and is rebound for each of the engine's internal buffers.
+///
+template <typename Transport, typename Clock = std::chrono::steady_clock, typename Allocator = std::allocator<uint8_t>>
+class frame_engine
+{
+public:
+    // ENUMERATIONS
+    ///
+    /// \brief Enumerates how the engine finds the length of a received header.
+    ///
+    enum class header_mode
+    {
+        PLAIN = 0,      ///< Headers are 11 bytes long, without a header checksum.
+        CHECKSUM = 1,   ///< Headers are 12 bytes long, with a header checksum.
+        FLAGGED = 2     ///< Each header's receipt field flags whether it carries a header checksum.
+    };
+    ///
+    /// \brief Enumerates the outcomes of looking for the next frame.
+    ///
+    enum class result
+    {
+        INCOMPLETE = 0,     ///< More bytes are needed before the next frame can be read.
+        FRAME = 1,          ///< A complete frame is ready to be taken.
+        TRUNCATED = 2,      ///< A frame was cut short by the next header, and was dropped.
+        HEADER_FAILURE = 3, ///< A header failed its header checksum, and was dropped.
+        OVERSIZE = 4        ///< A header declared more data than allowed, and was dropped.
+    };
+
+    // STRUCTURES
+    ///
+    /// \brief The layout of a complete frame at the front of the engine's buffer.
+    ///
+    struct frame
+    {
+        uint32_t packet_length;                 ///< The total length of the frame, without escapes.
+        uint32_t header_length;                 ///< The length of the frame's header.
+        uint16_t data_length;                   ///< The length of the frame's data, as declared by its header.
+        uint16_t extension_length;              ///< The length of the frame's extension block, or 0 if it has none.
+        typename Clock::time_point arrival;     ///< The time at which the frame's last byte was received.
+    };
+
+    // CONSTRUCTORS
+    ///
+    /// \brief frame_engine Creates a new frame_engine instance.
+    /// \param transport The transport that escaped packets are written to.
+    /// \param allocator The allocator for the engine's internal buffers.
+    ///
+    frame_engine(Transport transport = Transport(), const Allocator& allocator = Allocator())
+        : m_transport(transport),
+          m_escaped(byte_allocator(allocator)),
+          m_buffer(byte_allocator(allocator)),
+          m_header_positions(position_allocator(allocator)),
+          m_arrivals(arrival_allocator(allocator))
+    {
+        // Initialize locals.
+        frame_engine::m_escape_next = false;
+        frame_engine::m_buffer_position = 0;
+        frame_engine::m_header_mode = header_mode::PLAIN;
+        frame_engine::m_max_data_length = UINT16_MAX;
+    }
+
+    // METHODS
+    ///
+    /// \brief transmit Escapes a packet and writes it to the transport.
+    /// \param packet The packet, beginning with its header byte.
+    /// \param length The length of the packet.
+    /// \return The number of escapes that were inserted.
+    ///
+    uint32_t transmit(const uint8_t* packet, uint32_t length)
+    {
+        // Check if escapes are needed.
+        uint32_t n_escapes = 0;
+        // Only check after the header.
+        for(uint32_t i = 1; i < length; i++)
+        {
+            if(packet[i] == frame_engine::m_header_byte || packet[i] == frame_engine::m_escape_byte)
+            {
+                n_escapes++;
+            }
+        }
+
+        // Escapes not needed.  Write packet as is.
+        if(n_escapes == 0)
+        {
+            frame_engine::m_transport.write(packet, length);
+            return 0;
+        }
+
+        // Escapes needed.  The escape buffer is reused from packet to packet.
+        frame_engine::m_escaped.resize(length + n_escapes);
+        uint32_t esc_write_position = 0;
+        // Copy the header byte first since it should not be escaped.
+        frame_engine::m_escaped[esc_write_position++] = packet[0];
+        for(uint32_t i = 1; i < length; i++)
+        {
+            if(packet[i] == frame_engine::m_header_byte || packet[i] == frame_engine::m_escape_byte)
+            {
+                // Insert escape, then the byte decremented by one.
+                frame_engine::m_escaped[esc_write_position++] = frame_engine::m_escape_byte;
+                frame_engine::m_escaped[esc_write_position++] = packet[i] - 1;
+            }
+            else
+            {
+                frame_engine::m_escaped[esc_write_position++] = packet[i];
+            }
+        }
+        frame_engine::m_transport.write(frame_engine::m_escaped.data(), length + n_escapes);
+        return n_escapes;
+    }
+    ///
+    /// \brief ingest Adds received bytes to the buffer, handling escapes.
+    /// \param data The received bytes.
+    /// \param length The number of received bytes.
+    /// \param timestamp The time at which the bytes were received.
+    ///
+    void ingest(const uint8_t* data, uint32_t length, typename Clock::time_point timestamp)
+    {
+        for(const uint8_t* current_byte = data; current_byte != data + length; ++current_byte)
+        {
+            // Check for header byte.  Header bytes are never escaped, so each one starts a new frame.
+            if(*current_byte == frame_engine::m_header_byte)
+            {
+                // Record the header's position and cancel any dangling escape.
+                frame_engine::m_header_positions.push_back(frame_engine::m_buffer_position + frame_engine::m_buffer.size());
+                frame_engine::m_buffer.push_back(*current_byte);
+                frame_engine::m_escape_next = false;
+            }
+            // Check for escape byte.
+            else if(*current_byte == frame_engine::m_escape_byte)
+            {
+                // Mark next byte as escaped.
+                frame_engine::m_escape_next = true;
+            }
+            else
+            {
+                // Add byte to buffer with escape.
+                frame_engine::m_buffer.push_back(*current_byte + static_cast<uint8_t>(frame_engine::m_escape_next));
+                frame_engine::m_escape_next = false;
+            }
+        }
+
+        // Record when the block's bytes arrived, unless it only held an escape.
+        uint64_t end = frame_engine::m_buffer_position + frame_engine::m_buffer.size();
+        if(frame_engine::m_arrivals.empty() || frame_engine::m_arrivals.back().first < end)
+        {
+            frame_engine::m_arrivals.push_back(std::make_pair(end, timestamp));
+        }
+    }
+    ///
+    /// \brief ingest Adds received bytes to the buffer, handling escapes, timestamped with the current time.
+    /// \param data The received bytes.
+    /// \param length The number of received bytes.
+    ///
+    void ingest(const uint8_t* data, uint32_t length)
+    {
+        frame_engine::ingest(data, length, Clock::now());
+    }
+    ///
+    /// \brief next Looks for the next frame in the buffer.
+    /// \param output Returns the layout of the frame if one is ready.
+    /// \param discarded Returns the number of bytes that were discarded because they did not belong to a frame.
+    /// \return The outcome.  Only FRAME leaves a frame for take(), and only INCOMPLETE means that calling again is pointless.
+    ///
+    result next(frame& output, uint64_t& discarded)
+    {
+        // Discard any bytes that precede the next frame header.
+        // Header bytes are never escaped, so only positions marked as headers by ingest() can start a frame.
+        discarded = 0;
+        if(frame_engine::m_header_positions.empty())
+        {
+            // No frame has started, so nothing in the buffer can be used.
+            discarded = frame_engine::m_buffer.size();
+            frame_engine::discard(frame_engine::m_buffer.size());
+            return result::INCOMPLETE;
+        }
+        uint64_t leading = frame_engine::m_header_positions.front() - frame_engine::m_buffer_position;
+        if(leading > 0)
+        {
+            discarded = leading;
+            frame_engine::discard(leading);
+        }
+
+        // A frame can never extend past the start of the next frame.
+        // If another header has already arrived, it bounds how much of the buffer this frame may occupy.
+        uint64_t frame_limit = UINT64_MAX;
+        if(frame_engine::m_header_positions.size() > 1)
+        {
+            frame_limit = frame_engine::m_header_positions[1] - frame_engine::m_buffer_position;
+        }
+
+        // Initialize with 1 header, 4 sequence, 1 receipt, 1 optional header checksum, 2 message id, 1 priority, 2 data length.
+        // The receipt field may flag the header checksum, so it is needed first.
+        if(frame_limit >= 6 && frame_engine::m_buffer.size() < 6)
+        {
+            return result::INCOMPLETE;
+        }
+        uint32_t header_length = frame_limit < 6 ? 11 : frame_engine::header_length(frame_engine::m_buffer[5]);
+        if(frame_limit < header_length)
+        {
+            // The frame was cut short by the next header.  Resume at the next header.
+            frame_engine::discard(frame_limit);
+            return result::TRUNCATED;
+        }
+        if(frame_engine::m_buffer.size() < header_length)
+        {
+            return result::INCOMPLETE;
+        }
+        uint8_t header[12];
+        std::copy(frame_engine::m_buffer.begin(), frame_engine::m_buffer.begin() + header_length, header);
+
+        // Validate the header checksum before trusting the data length.
+        if(header_length == 12 && header[6] != frame_engine::header_checksum(header, header_length))
+        {
+            // The header is corrupt.  Resume at the next header.
+            frame_engine::discard(1);
+            return result::HEADER_FAILURE;
+        }
+
+        // Read the last two bytes of the header to get the data length.
+        uint16_t data_length = static_cast<uint16_t>((header[header_length - 2] << 8) | header[header_length - 1]);
+        if(data_length > frame_engine::m_max_data_length)
+        {
+            // The frame is larger than allowed.  Resume at the next header.
+            frame_engine::discard(1);
+            return result::OVERSIZE;
+        }
+
+        // Finalize packet size with data length, any extension block, and checksum.
+        uint32_t packet_length = header_length + data_length + 1;
+        uint16_t extension_length = 0;
+        if(header[5] & frame_engine::m_extended_flag)
+        {
+            // The extension block's length follows the data.
+            uint32_t extension_offset = header_length + data_length;
+            if(frame_limit < extension_offset + 2)
+            {
+                frame_engine::discard(frame_limit);
+                return result::TRUNCATED;
+            }
+            if(frame_engine::m_buffer.size() < extension_offset + 2)
+            {
+                return result::INCOMPLETE;
+            }
+            extension_length = static_cast<uint16_t>((frame_engine::m_buffer[extension_offset] << 8) | frame_engine::m_buffer[extension_offset + 1]);
+            packet_length += 2 + extension_length;
+        }
+
+        // Check that the packet ends before the next header.
+        if(frame_limit < packet_length)
+        {
+            // The frame was cut short by the next header, or its length is corrupt.  Resume at the next header.
+            frame_engine::discard(frame_limit);
+            return result::TRUNCATED;
+        }
+        // Check if packet length exists in the buffer.
+        if(frame_engine::m_buffer.size() < packet_length)
+        {
+            return result::INCOMPLETE;
+        }
+
+        // The frame arrived when its last byte was received.
+        output.packet_length = packet_length;
+        output.header_length = header_length;
+        output.data_length = data_length;
+        output.extension_length = extension_length;
+        output.arrival = frame_engine::arrival(frame_engine::m_buffer_position + packet_length - 1);
+        return result::FRAME;
+    }
+    ///
+    /// \brief take Removes the frame found by next() from the buffer.
+    /// \param frame The frame's layout, as returned by next().
+    /// \param destination The array to copy the frame's packet_length bytes into.
+    ///
+    void take(const frame& frame, uint8_t* destination)
+    {
+        std::copy(frame_engine::m_buffer.begin(), frame_engine::m_buffer.begin() + frame.packet_length, destination);
+        frame_engine::discard(frame.packet_length);
+    }
+    ///
+    /// \brief checksum Calculates the XOR checksum that ends every packet.
+    /// \param data The bytes to check.
+    /// \param length The number of bytes to check.
+    /// \return The checksum.
+    ///
+    static uint8_t checksum(const uint8_t* data, uint32_t length)
+    {
+        uint8_t checksum = 0;
+        for(uint32_t i = 0 ; i < length; i++)
+        {
+            checksum ^= data[i];
+        }
+        return checksum;
+    }
+    ///
+    /// \brief header_checksum Calculates the CRC-8 of a header.
+    /// \param header The header bytes.
+    /// \param length The length of the header.
+    /// \return The header checksum.
+    ///
+    static uint8_t header_checksum(const uint8_t* header, uint32_t length)
+    {
+        // CRC-8 (polynomial 0x07) over every header byte except the header checksum itself.
+        uint8_t crc = 0;
+        for(uint32_t i = 0; i < length; i++)
+        {
+            if(i == 6)
+            {
+                continue;
+            }
+            crc ^= header[i];
+            for(uint8_t bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    // PROPERTIES
+    ///
+    /// \brief p_header_byte Gets the byte that starts every frame.
+    /// \return The header byte.
+    ///
+    uint8_t p_header_byte() const
+    {
+        return frame_engine::m_header_byte;
+    }
+    ///
+    /// \brief p_header_mode Gets how the length of a received header is found.
+    /// \return The header mode.
+    ///
+    header_mode p_header_mode() const
+    {
+        return frame_engine::m_header_mode;
+    }
+    ///
+    /// \brief p_header_mode Sets how the length of a received header is found.
+    /// \param value The new header mode.
+    ///
+    void p_header_mode(header_mode value)
+    {
+        frame_engine::m_header_mode = value;
+    }
+    ///
+    /// \brief p_max_data_length Gets the longest data length a received frame may declare.
+    /// \return The maximum data length in bytes.
+    ///
+    uint16_t p_max_data_length() const
+    {
+        return frame_engine::m_max_data_length;
+    }
+    ///
+    /// \brief p_max_data_length Sets the longest data length a received frame may declare.
+    /// \param value The maximum data length in bytes.
+    ///
+    void p_max_data_length(uint16_t value)
+    {
+        frame_engine::m_max_data_length = value;
+    }
+    ///
+    /// \brief p_buffered Gets the number of unescaped bytes waiting in the buffer.
+    /// \return The number of buffered bytes.
+    ///
+    uint64_t p_buffered() const
+    {
+        return frame_engine::m_buffer.size();
+    }
+    ///
+    /// \brief p_transport Gets the transport that escaped packets are written to.
+    /// \return A reference to the transport.
+    ///
+    Transport& p_transport()
+    {
+        return frame_engine::m_transport;
+    }
+
+private:
+    // TYPES
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t> byte_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint64_t> position_allocator;
+    typedef std::pair<uint64_t, typename Clock::time_point> arrival_block;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<arrival_block> arrival_allocator;
+
+    // CONSTANTS
+    ///
+    /// \brief m_header_byte Stores the message header byte.
+    ///
+    const uint8_t m_header_byte = 0xAA;
+    ///
+    /// \brief m_escape_byte Stores the message escape byte.
+    ///
+    const uint8_t m_escape_byte = 0x1B;
+    ///
+    /// \brief m_extended_flag Stores the receipt field flag of frames that carry an extension block.
+    ///
+    const uint8_t m_extended_flag = 0x20;
+    ///
+    /// \brief m_header_checksum_flag Stores the receipt field flag of frames that carry a header checksum.
+    ///
+    const uint8_t m_header_checksum_flag = 0x10;
+
+    // VARIABLES
+    ///
+    /// \brief m_transport Stores the transport that escaped packets are written to.
+    ///
+    Transport m_transport;
+    ///
+    /// \brief m_escaped Stores the escaped copy of the packet being transmitted.
+    ///
+    std::vector<uint8_t, byte_allocator> m_escaped;
+    ///
+    /// \brief m_buffer Stores received bytes, without escapes.
+    ///
+    std::deque<uint8_t, byte_allocator> m_buffer;
+    ///
+    /// \brief m_escape_next Indicates if the next received byte is escaped.
+    ///
+    bool m_escape_next;
+    ///
+    /// \brief m_buffer_position Stores the stream position of the first byte in the buffer.
+    ///
+    uint64_t m_buffer_position;
+    ///
+    /// \brief m_header_positions Stores the stream positions of unescaped header bytes in the buffer.
+    ///
+    std::deque<uint64_t, position_allocator> m_header_positions;
+    ///
+    /// \brief m_arrivals Stores the stream position just past each block of bytes in the buffer, and the time the block was received.
+    ///
+    std::deque<arrival_block, arrival_allocator> m_arrivals;
+    ///
+    /// \brief m_header_mode Stores how the length of a received header is found.
+    ///
+    header_mode m_header_mode;
+    ///
+    /// \brief m_max_data_length Stores the longest data length a received frame may declare.
+    ///
+    uint16_t m_max_data_length;
+
+    // METHODS
+    ///
+    /// \brief header_length Gets the length of a received header.
+    /// \param receipt The header's receipt field.
+    /// \return The header length.
+    ///
+    uint32_t header_length(uint8_t receipt) const
+    {
+        switch(frame_engine::m_header_mode)
+        {
+        case header_mode::CHECKSUM:
+            return 12;
+        case header_mode::FLAGGED:
+            return (receipt & frame_engine::m_header_checksum_flag) ? 12 : 11;
+        default:
+            return 11;
+        }
+    }
+    ///
+    /// \brief arrival Gets the time at which a byte of the buffer was received.
+    /// \param position The stream position of the byte.
+    /// \return The time at which the byte was received.
+    ///
+    typename Clock::time_point arrival(uint64_t position) const
+    {
+        // Blocks are in stream order, so the first to end past the position is the one that held it.
+        for(auto block = frame_engine::m_arrivals.begin(); block != frame_engine::m_arrivals.end(); ++block)
+        {
+            if(block->first > position)
+            {
+                return block->second;
+            }
+        }
+        return Clock::now();
+    }
+    ///
+    /// \brief discard Removes bytes from the front of the buffer.
+    /// \param length The number of bytes to remove.
+    ///
+    void discard(uint64_t length)
+    {
+        // Remove the bytes and any header positions they contained.
+        frame_engine::m_buffer.erase(frame_engine::m_buffer.begin(), frame_engine::m_buffer.begin() + length);
+        frame_engine::m_buffer_position += length;
+        while(!frame_engine::m_header_positions.empty() && frame_engine::m_header_positions.front() < frame_engine::m_buffer_position)
+        {
+            frame_engine::m_header_positions.pop_front();
+        }
+        // Forget blocks that have been consumed entirely.
+        while(!frame_engine::m_arrivals.empty() && frame_engine::m_arrivals.front().first <= frame_engine::m_buffer_position)
+        {
+            frame_engine::m_arrivals.pop_front();
+        }
+    }
+};
+}}
+
+#endif // FRAME_ENGINE_H
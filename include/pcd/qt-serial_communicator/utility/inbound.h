@@ -4,6 +4,10 @@
 #define INBOUND_H
 
 #include "pcd/qt-serial_communicator/message.h"
+#include "pcd/qt-serial_communicator/utility/byte_order.h"
+
+#include <chrono>
+#include <memory>
 
 namespace serial_communicator {
 ///
@@ -12,40 +16,187 @@ namespace serial_communicator {
 namespace utility {
 ///
 /// \brief Provides management of inbound messages.
+/// \details An inbound keeps the received message in its serialized form, within the buffer it
+/// was parsed from, and only creates a message when it is taken.  Messages that are dropped or
+/// evicted from the receive queue are therefore never copied.  Clock provides the time_point type of
+/// the message's timestamps, and Allocator is rebound to release the buffer.
 ///
+template <typename Clock = std::chrono::steady_clock, typename Allocator = std::allocator<uint8_t>>
 class inbound
 {
 public:
     // CONSTRUCTORS
     ///
     /// \brief inbound Creates a new inbound instance.
-    /// \param message A pointer to the received message.
+    /// \param buffer The buffer holding the serialized message.  This instance takes ownership of the buffer.
+    /// \param buffer_length The length of the buffer, as it was allocated.
+    /// \param offset The position of the serialized message within the buffer.
+    /// \param channel The logical channel the message was received on.
     /// \param sequence_number The originating sequence number of the received message.
-    /// \details This instance takes ownership of the message pointer.
+    /// \param receive_timestamp The time at which the message's last byte was read from the serial port.
+    /// \param parse_timestamp The time at which the message was parsed.
+    /// \param allocator The allocator that allocated the buffer.
+    ///
+    inbound(uint8_t* buffer, uint32_t buffer_length, uint32_t offset, uint8_t channel, uint32_t sequence_number, typename Clock::time_point receive_timestamp, typename Clock::time_point parse_timestamp, const Allocator& allocator = Allocator())
+        : m_allocator(allocator)
+    {
+        inbound::m_buffer = buffer;
+        inbound::m_buffer_length = buffer_length;
+        inbound::m_bytes = &buffer[offset];
+        inbound::m_channel = channel;
+        inbound::m_sequence_number = sequence_number;
+        inbound::m_parse_timestamp = parse_timestamp;
+        inbound::m_receive_timestamp = receive_timestamp;
+
+        // Decode only the fields needed to order and account for the message.
+        inbound::m_id = load_big_endian<uint16_t>(&inbound::m_bytes[0]);
+        inbound::m_priority = inbound::m_bytes[2];
+        inbound::m_data_length = load_big_endian<uint16_t>(&inbound::m_bytes[3]);
+    }
+    ~inbound()
+    {
+        std::allocator_traits<byte_allocator>::deallocate(inbound::m_allocator, inbound::m_buffer, inbound::m_buffer_length);
+    }
+
+    // METHODS
+    ///
+    /// \brief materialize Creates the received message from its serialized form.
+    /// \return The received message.  The caller takes ownership of the pointer.
     ///
-    inbound(message* message, uint32_t sequence_number);
+    message* materialize() const
+    {
+        message* output = new message(inbound::m_bytes);
+        output->p_channel(inbound::m_channel);
+        inbound::stamp(output, inbound::m_receive_timestamp);
+        return output;
+    }
 
     // PROPERTIES
     ///
-    /// \brief p_message Gets a pointer to the received message.
-    /// \return A pointer to the received message.
+    /// \brief p_id Gets the ID of the received message.
+    /// \return The ID of the received message.
+    ///
+    uint16_t p_id() const
+    {
+        return inbound::m_id;
+    }
+    ///
+    /// \brief p_priority Gets the priority of the received message.
+    /// \return The priority of the received message.
+    ///
+    uint8_t p_priority() const
+    {
+        return inbound::m_priority;
+    }
+    ///
+    /// \brief p_channel Gets the logical channel the message was received on.
+    /// \return The logical channel of the received message.
+    ///
+    uint8_t p_channel() const
+    {
+        return inbound::m_channel;
+    }
     ///
-    message* p_message() const;
+    /// \brief p_message_length Gets the total length of the received message in bytes.
+    /// \return The total length of the received message.
+    ///
+    uint32_t p_message_length() const
+    {
+        return inbound::m_data_length + 5;
+    }
     ///
     /// \brief p_sequence_number Gets the originiating sequence number of the received message.
     /// \return The originating sequence number of the received message.
     ///
-    unsigned int p_sequence_number() const;
+    unsigned int p_sequence_number() const
+    {
+        return inbound::m_sequence_number;
+    }
+    ///
+    /// \brief p_parse_timestamp Gets the time at which the received message was parsed.
+    /// \return The time at which the received message was parsed.
+    ///
+    typename Clock::time_point p_parse_timestamp() const
+    {
+        return inbound::m_parse_timestamp;
+    }
+    ///
+    /// \brief p_receive_timestamp Gets the time at which the message's last byte was read from the serial port.
+    /// \return The time at which the received message arrived.
+    ///
+    typename Clock::time_point p_receive_timestamp() const
+    {
+        return inbound::m_receive_timestamp;
+    }
 
 private:
+    // TYPES
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t> byte_allocator;
+
+    // VARIABLES
+    ///
+    /// \brief m_allocator Stores the allocator that releases the buffer.
+    ///
+    byte_allocator m_allocator;
+    ///
+    /// \brief m_buffer Stores the buffer holding the serialized message.
+    ///
+    uint8_t* m_buffer;
     ///
-    /// \brief m_message Stores a pointer to the recieved message.
+    /// \brief m_buffer_length Stores the length of the buffer.
     ///
-    message* m_message;
+    uint32_t m_buffer_length;
+    ///
+    /// \brief m_bytes Stores a pointer to the serialized message within the buffer.
+    ///
+    const uint8_t* m_bytes;
+    ///
+    /// \brief m_id Stores the ID of the received message.
+    ///
+    uint16_t m_id;
+    ///
+    /// \brief m_priority Stores the priority of the received message.
+    ///
+    uint8_t m_priority;
+    ///
+    /// \brief m_channel Stores the logical channel the message was received on.
+    ///
+    uint8_t m_channel;
+    ///
+    /// \brief m_data_length Stores the data length of the received message.
+    ///
+    uint16_t m_data_length;
     ///
     /// \brief m_sequence_number Stores the originating sequence number of the received message.
     ///
     uint32_t m_sequence_number;
+    ///
+    /// \brief m_parse_timestamp Stores the time at which the received message was parsed.
+    ///
+    typename Clock::time_point m_parse_timestamp;
+    ///
+    /// \brief m_receive_timestamp Stores the time at which the message's last byte was read from the serial port.
+    ///
+    typename Clock::time_point m_receive_timestamp;
+
+    // METHODS
+    ///
+    /// \brief stamp Gives a message its receive timestamp.
+    /// \param output The message.
+    /// \param timestamp The time at which the message's last byte was read.
+    ///
+    static void stamp(message* output, std::chrono::steady_clock::time_point timestamp)
+    {
+        output->p_receive_timestamp(timestamp);
+    }
+    ///
+    /// \brief stamp Leaves a message without a receive timestamp.
+    /// \details Messages carry steady clock timestamps, which readings of another clock cannot be converted to.
+    ///
+    template <typename TimePoint>
+    static void stamp(message*, TimePoint)
+    {
+    }
 };
 
 }}
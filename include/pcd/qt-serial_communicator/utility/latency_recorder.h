@@ -0,0 +1,102 @@
+/// \file latency_recorder.h
+/// \brief Defines the serial_communicator::utility::latency_recorder class.
+#ifndef LATENCY_RECORDER_H
+#define LATENCY_RECORDER_H
+
+#include "pcd/qt-serial_communicator/latency_histogram.h"
+#include "pcd/qt-serial_communicator/latency_metric.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Keeps latency histograms for each metric, per priority and optionally per message ID.
+/// \details Histograms are allocated on first use so that unused priorities and IDs cost nothing.
+///
+class latency_recorder
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief latency_recorder Creates a new latency_recorder instance with no histograms.
+    ///
+    latency_recorder();
+    ~latency_recorder();
+
+    // METHODS
+    ///
+    /// \brief record Records a latency against a metric.
+    /// \param metric The metric being measured.
+    /// \param priority The priority of the message the latency belongs to.
+    /// \param id The ID of the message the latency belongs to.
+    /// \param microseconds The latency in microseconds.
+    ///
+    void record(latency_metric metric, uint8_t priority, uint16_t id, uint64_t microseconds);
+    ///
+    /// \brief histogram Gets the histogram of a metric across all messages.
+    /// \param metric The metric to get.
+    /// \return The histogram of the metric.
+    ///
+    const latency_histogram* histogram(latency_metric metric) const;
+    ///
+    /// \brief histogram_by_priority Gets the histogram of a metric for one priority.
+    /// \param metric The metric to get.
+    /// \param priority The priority to get.
+    /// \return The histogram, or nullptr if nothing has been recorded for the priority.
+    ///
+    const latency_histogram* histogram_by_priority(latency_metric metric, uint8_t priority) const;
+    ///
+    /// \brief histogram_by_id Gets the histogram of a metric for one message ID.
+    /// \param metric The metric to get.
+    /// \param id The message ID to get.
+    /// \return The histogram, or nullptr if nothing has been recorded for the ID.
+    ///
+    const latency_histogram* histogram_by_id(latency_metric metric, uint16_t id) const;
+
+    // PROPERTIES
+    ///
+    /// \brief p_track_ids Gets if latencies are also kept per message ID.
+    /// \return TRUE if per-ID histograms are kept, otherwise FALSE.
+    ///
+    bool p_track_ids() const;
+    ///
+    /// \brief p_track_ids Sets if latencies are also kept per message ID.
+    /// \param value TRUE to keep per-ID histograms, otherwise FALSE.
+    ///
+    void p_track_ids(bool value);
+
+private:
+    // CONSTANTS
+    ///
+    /// \brief m_n_metrics Stores the number of latency metrics.
+    ///
+    static const int m_n_metrics = 3;
+
+    // VARIABLES
+    ///
+    /// \brief m_totals Stores the histogram of each metric across all messages.
+    ///
+    latency_histogram m_totals[m_n_metrics];
+    ///
+    /// \brief m_priorities Stores the lazily allocated histograms of each metric per priority.
+    ///
+    std::atomic<latency_histogram*> m_priorities[m_n_metrics][256];
+    ///
+    /// \brief m_ids Stores the lazily allocated histograms of each metric per message ID.
+    ///
+    std::map<uint16_t, latency_histogram*> m_ids[m_n_metrics];
+    ///
+    /// \brief m_ids_mutex Protects the per-ID maps against concurrent insertion and lookup.
+    ///
+    mutable std::mutex m_ids_mutex;
+    ///
+    /// \brief m_track_ids Stores if latencies are also kept per message ID.
+    ///
+    std::atomic<bool> m_track_ids;
+};
+}}
+
+#endif // LATENCY_RECORDER_H
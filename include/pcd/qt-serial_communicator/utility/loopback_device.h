@@ -0,0 +1,91 @@
+/// \file loopback_device.h
+/// \brief Defines the serial_communicator::utility::loopback_device class.
+#ifndef LOOPBACK_DEVICE_H
+#define LOOPBACK_DEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+
+#include <deque>
+#include <mutex>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief One end of an in-process byte pipe.
+/// \details Bytes written to a device are handed to its peer as a single shared chunk and become
+/// readable from the peer after the event loop delivers its readyRead signal.  A device without a
+/// peer discards everything written to it.
+///
+class loopback_device
+    : public QIODevice
+{
+    Q_OBJECT
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief loopback_device Creates a new, unconnected loopback device.
+    /// \param parent OPTIONAL The QObject parent of the device.
+    ///
+    loopback_device(QObject* parent = nullptr);
+
+    // METHODS
+    ///
+    /// \brief connect_peer Connects this device to a peer device.
+    /// \param peer The device that will receive everything written to this device.
+    ///
+    void connect_peer(loopback_device* peer);
+    ///
+    /// \brief deliver Makes a chunk of bytes readable from this device.
+    /// \param chunk The bytes to deliver.  The chunk is shared, not copied.
+    /// \details This may be called from any thread.
+    ///
+    void deliver(const QByteArray& chunk);
+
+    // QIODEVICE OVERRIDES
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+    bool waitForBytesWritten(int msecs) override;
+
+protected:
+    // QIODEVICE OVERRIDES
+    qint64 readData(char* data, qint64 max_length) override;
+    qint64 writeData(const char* data, qint64 length) override;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_peer Stores the device that receives written bytes.
+    ///
+    loopback_device* m_peer;
+    ///
+    /// \brief m_chunks Stores delivered chunks that have not been fully read.
+    ///
+    std::deque<QByteArray> m_chunks;
+    ///
+    /// \brief m_read_offset Stores the read position within the front chunk.
+    ///
+    int m_read_offset;
+    ///
+    /// \brief m_available Stores the number of unread bytes across all chunks.
+    ///
+    qint64 m_available;
+    ///
+    /// \brief m_notify_pending Indicates that a readyRead notification has already been scheduled.
+    ///
+    bool m_notify_pending;
+    ///
+    /// \brief m_mutex Protects the chunk queue against writers on other threads.
+    ///
+    mutable std::mutex m_mutex;
+
+private slots:
+    // SLOTS
+    ///
+    /// \brief notify Emits readyRead for chunks delivered since the last notification.
+    ///
+    void notify();
+};
+}}
+
+#endif // LOOPBACK_DEVICE_H
@@ -0,0 +1,34 @@
+/// \file lz77.h
+/// \brief Defines the serial_communicator::utility LZ77 block compression functions.
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief lz77_compress Compresses a block of bytes.
+/// \param source The bytes to compress.
+/// \param length The number of bytes to compress.
+/// \param destination The buffer to write the compressed block to.
+/// \param capacity The size of the destination buffer.
+/// \return The size of the compressed block, or 0 if it would not fit in the destination.
+/// \details The block format follows LZ4: each sequence is a token holding 4 bit literal and match
+/// lengths, extended literal length bytes, the literals, a 16 bit little endian match offset, and
+/// extended match length bytes.  The final sequence holds literals only.  Matches are found
+/// greedily with a single 4096 entry hash table, favouring speed over ratio.
+///
+uint32_t lz77_compress(const uint8_t* source, uint32_t length, uint8_t* destination, uint32_t capacity);
+///
+/// \brief lz77_decompress Decompresses a block written by lz77_compress.
+/// \param source The compressed block.
+/// \param length The size of the compressed block.
+/// \param destination The buffer to write the decompressed bytes to.
+/// \param capacity The size of the destination buffer.
+/// \return The number of decompressed bytes, or -1 if the block is malformed or does not fit.
+///
+int64_t lz77_decompress(const uint8_t* source, uint32_t length, uint8_t* destination, uint32_t capacity);
+}}
+
+#endif // LZ77_H
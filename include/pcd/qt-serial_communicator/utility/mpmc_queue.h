@@ -0,0 +1,169 @@
+/// \file mpmc_queue.h
+/// \brief Defines the serial_communicator::utility::mpmc_queue class.
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief A bounded, lock-free queue for any number of producer and consumer threads.
+/// \details Each cell carries a sequence number that tells producers and consumers whose turn it
+/// is to use the cell, so a push or pop claims a position with a single compare-and-swap and never
+/// blocks.  The capacity is rounded up to a power of two.
+///
+template <typename T>
+class mpmc_queue
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief mpmc_queue Creates a new, empty mpmc_queue instance.
+    /// \param capacity The minimum number of items the queue can hold.
+    ///
+    mpmc_queue(uint32_t capacity)
+    {
+        // Round the capacity up to a power of two, so positions wrap with a mask.
+        size_t size = 2;
+        while(size < capacity)
+        {
+            size *= 2;
+        }
+        mpmc_queue::m_mask = size - 1;
+        mpmc_queue::m_cells = new cell[size];
+        for(size_t i = 0; i < size; i++)
+        {
+            mpmc_queue::m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mpmc_queue::m_enqueue_position.store(0, std::memory_order_relaxed);
+        mpmc_queue::m_dequeue_position.store(0, std::memory_order_relaxed);
+    }
+    ~mpmc_queue()
+    {
+        delete [] mpmc_queue::m_cells;
+    }
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    // METHODS
+    ///
+    /// \brief push Adds an item to the back of the queue.
+    /// \param item The item to add, which is moved into the queue.
+    /// \return TRUE if the item was added, or FALSE if the queue is full.
+    ///
+    bool push(T&& item)
+    {
+        cell* target;
+        size_t position = mpmc_queue::m_enqueue_position.load(std::memory_order_relaxed);
+        while(true)
+        {
+            target = &mpmc_queue::m_cells[position & mpmc_queue::m_mask];
+            size_t sequence = target->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if(difference == 0)
+            {
+                // The cell is free for this position, so try to claim it.
+                if(mpmc_queue::m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(difference < 0)
+            {
+                // The cell still holds an item from the previous lap, so the queue is full.
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the position first.
+                position = mpmc_queue::m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        // Store the item and hand the cell to consumers.
+        target->data = std::move(item);
+        target->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    ///
+    /// \brief pop Removes the item at the front of the queue.
+    /// \param item Returns the removed item.
+    /// \return TRUE if an item was removed, or FALSE if the queue is empty.
+    ///
+    bool pop(T& item)
+    {
+        cell* target;
+        size_t position = mpmc_queue::m_dequeue_position.load(std::memory_order_relaxed);
+        while(true)
+        {
+            target = &mpmc_queue::m_cells[position & mpmc_queue::m_mask];
+            size_t sequence = target->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if(difference == 0)
+            {
+                // The cell holds the item for this position, so try to claim it.
+                if(mpmc_queue::m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(difference < 0)
+            {
+                // No producer has filled the cell yet, so the queue is empty.
+                return false;
+            }
+            else
+            {
+                // Another consumer claimed the position first.
+                position = mpmc_queue::m_dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+        // Take the item and hand the cell back to producers for the next lap.
+        item = std::move(target->data);
+        target->sequence.store(position + mpmc_queue::m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // STRUCTURES
+    ///
+    /// \brief A slot of the queue and the sequence number that says whose turn it is.
+    ///
+    struct cell
+    {
+        std::atomic<size_t> sequence;   ///< The position the cell expects next: its own position when free, or one past it when full.
+        T data;                         ///< The stored item.
+    };
+
+    // VARIABLES
+    ///
+    /// \brief m_cells Stores the queue's cells.
+    ///
+    cell* m_cells;
+    ///
+    /// \brief m_mask Stores the mask that wraps positions onto cells.
+    ///
+    size_t m_mask;
+    ///
+    /// \brief m_padding_enqueue Keeps the enqueue position off the cache line of the fields before it.
+    ///
+    char m_padding_enqueue[64];
+    ///
+    /// \brief m_enqueue_position Stores the next position to push to.
+    ///
+    std::atomic<size_t> m_enqueue_position;
+    ///
+    /// \brief m_padding_dequeue Keeps producers and consumers from sharing a cache line.
+    ///
+    char m_padding_dequeue[64];
+    ///
+    /// \brief m_dequeue_position Stores the next position to pop from.
+    ///
+    std::atomic<size_t> m_dequeue_position;
+};
+}}
+
+#endif // MPMC_QUEUE_H
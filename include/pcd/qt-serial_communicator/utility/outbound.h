@@ -5,14 +5,20 @@
 
 #include "pcd/qt-serial_communicator/message.h"
 #include "pcd/qt-serial_communicator/message_status.h"
+#include "pcd/qt-serial_communicator/utility/sequence.h"
+#include "pcd/qt-serial_communicator/utility/status_observer.h"
 
 #include <chrono>
+#include <memory>
+#include <vector>
 
 namespace serial_communicator {
 namespace utility {
 ///
 /// \brief Provides management of outbound messages.
+/// \details Clock provides the time_point type of the message's timestamps.
 ///
+template <typename Clock = std::chrono::steady_clock>
 class outbound
 {
 public:
@@ -23,61 +29,198 @@ public:
     /// \param sequence_number The originating sequence number of the outbound message.
     /// \param receipt_required A flag indicating if receipt is required for the outbound message.
     /// \param tracker A tracker for external observation of an outgoing message's status.
-    ///
-    outbound(message* message, uint32_t sequence_number, bool receipt_required, message_status* tracker);
-    ~outbound();
+    /// \param observer A shared observer of the outgoing message's status, or nullptr.
+    /// \param timestamp The time at which the message was queued.
+    /// \details If the outbound is destroyed before the message's status is final, the observer is told NOTRECEIVED.
+    ///
+    outbound(message* message, uint32_t sequence_number, bool receipt_required, message_status* tracker, std::shared_ptr<status_observer> observer, typename Clock::time_point timestamp)
+    {
+        // Store locals.
+        outbound::m_message = message;
+        outbound::m_sequence_number = sequence_number;
+        outbound::m_receipt_required = receipt_required;
+        outbound::m_tracker = tracker;
+        outbound::m_observer = observer;
+
+        // Initialize counters.
+        outbound::m_enqueue_timestamp = timestamp;
+        outbound::m_transmit_timestamp = outbound::m_enqueue_timestamp;
+        outbound::m_n_transmissions = 0;
+        outbound::m_delta_base = false;
+
+        // Set status to queued.
+        outbound::update_status(message_status::QUEUED);
+    }
+    ~outbound()
+    {
+        // Tell the observer if the message is being abandoned.
+        if(outbound::m_observer)
+        {
+            outbound::m_observer->update(message_status::NOTRECEIVED);
+        }
+        delete outbound::m_message;
+    }
 
     // METHODS
     ///
     /// \brief mark_transmitted Instrucst the outgoing message that it has been transmitted.
+    /// \param timestamp The time at which the message was transmitted.
     /// \details Call this method any time the message is transmitted.  It informs the instance
     /// to update counters and timestamps related to retransmission.
     ///
-    void mark_transmitted();
+    void mark_transmitted(typename Clock::time_point timestamp)
+    {
+        // Update transmission timestamp.
+        outbound::m_transmit_timestamp = timestamp;
+        // Increment transmission counter.
+        outbound::m_n_transmissions++;
+    }
     ///
     /// \brief update_status Updates the internal status and tracker to a new message status.
     /// \param status The new status to set.
     ///
-    void update_status(message_status status);
+    void update_status(message_status status)
+    {
+        // Update internal status.
+        outbound::m_status = status;
+        // Update tracker if available.
+        if(outbound::m_tracker)
+        {
+            *outbound::m_tracker = status;
+        }
+        // Update observer if available.
+        if(outbound::m_observer)
+        {
+            outbound::m_observer->update(status);
+        }
+    }
     ///
     /// \brief timeout_elapsed Checks if a specified timeout has elapsed since the message was last transmitted.
     /// \param timeout The length of the timeout period in milliseconds.
+    /// \param now The current time.
     /// \return TRUE if the timeout has elapsed, otherwise FALSE.
     ///
-    bool timeout_elapsed(uint32_t timeout) const;
+    bool timeout_elapsed(uint32_t timeout, typename Clock::time_point now) const
+    {
+        // Check if the given timeout has been elapsed.
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - outbound::m_transmit_timestamp).count() > timeout;
+    }
     ///
     /// \brief can_retransmit Checks if the message can be retransmitted, or if it has reached its max transmissions.
     /// \param transmit_limit The maximum allowed transmissions of the message.
     /// \return TRUE if the message may be retransmitted, otherwise FALSE.
     ///
-    bool can_retransmit(uint8_t transmit_limit) const;
+    bool can_retransmit(uint8_t transmit_limit) const
+    {
+        return outbound::m_n_transmissions < transmit_limit;
+    }
+    ///
+    /// \brief reprioritize Changes the priority of the outbound message.
+    /// \param priority The new priority.
+    /// \details The new priority applies to the message's ordering and to any future transmissions.
+    ///
+    void reprioritize(uint8_t priority)
+    {
+        outbound::m_message->p_priority(priority);
+    }
 
     // PROPERTIES
     ///
     /// \brief p_message Gets a reference to the current outbound message.
     /// \return A const reference to the current outbound message.
     ///
-    const message* p_message() const;
+    const message* p_message() const
+    {
+        return outbound::m_message;
+    }
     ///
     /// \brief p_sequence_number Gets the originating sequence number of the outbound message.
     /// \return The originating sequence number of the outbound message.
     ///
-    uint32_t p_sequence_number() const;
+    uint32_t p_sequence_number() const
+    {
+        return outbound::m_sequence_number;
+    }
     ///
     /// \brief p_receipt_required Gets if the message is requiring a receipt from the receiver or not.
     /// \return TRUE if receipt is required, otherwise FALSE.
     ///
-    bool p_receipt_required() const;
+    bool p_receipt_required() const
+    {
+        return outbound::m_receipt_required;
+    }
     ///
     /// \brief p_n_transmissions Gets the total number of transmissions of the message.
     /// \return The total number of transmissions of the message.
     ///
-    unsigned char p_n_transmissions() const;
+    unsigned char p_n_transmissions() const
+    {
+        return outbound::m_n_transmissions;
+    }
     ///
     /// \brief p_status Gets the current status of the message.
     /// \return The current status of the message.
     ///
-    message_status p_status() const;
+    message_status p_status() const
+    {
+        return outbound::m_status;
+    }
+    ///
+    /// \brief p_enqueue_timestamp Gets the time at which the message was queued.
+    /// \return The time at which the message was queued.
+    ///
+    typename Clock::time_point p_enqueue_timestamp() const
+    {
+        return outbound::m_enqueue_timestamp;
+    }
+    ///
+    /// \brief p_transmit_timestamp Gets the last time in which the message was transmitted.
+    /// \return The last time in which the message was transmitted.
+    ///
+    typename Clock::time_point p_transmit_timestamp() const
+    {
+        return outbound::m_transmit_timestamp;
+    }
+    ///
+    /// \brief p_observer Gets the observer of the outbound message's status.
+    /// \return The observer, or nullptr if the message was not sent with one.
+    ///
+    const status_observer* p_observer() const
+    {
+        return outbound::m_observer.get();
+    }
+    ///
+    /// \brief p_extensions Gets the extension entries carried with the message.
+    /// \return The extension entries.
+    ///
+    const std::vector<uint8_t>& p_extensions() const
+    {
+        return outbound::m_extensions;
+    }
+    ///
+    /// \brief p_extensions Sets the extension entries carried with the message.
+    /// \param value The extension entries.
+    ///
+    void p_extensions(std::vector<uint8_t> value)
+    {
+        outbound::m_extensions = std::move(value);
+    }
+    ///
+    /// \brief p_delta_base Gets if the last transmission marked the payload as a delta base for the receiver to cache.
+    /// \return TRUE if the payload was marked, otherwise FALSE.
+    ///
+    bool p_delta_base() const
+    {
+        return outbound::m_delta_base;
+    }
+    ///
+    /// \brief p_delta_base Sets if the last transmission marked the payload as a delta base for the receiver to cache.
+    /// \param value TRUE if the payload was marked, otherwise FALSE.
+    ///
+    void p_delta_base(bool value)
+    {
+        outbound::m_delta_base = value;
+    }
 
 private:
     // VARIABLES
@@ -102,13 +245,46 @@ private:
     ///
     message_status* m_tracker;
     ///
+    /// \brief m_observer Stores the shared observer of the outgoing message's status.
+    ///
+    std::shared_ptr<status_observer> m_observer;
+    ///
+    /// \brief m_enqueue_timestamp Stores the time in which the message was queued.
+    ///
+    typename Clock::time_point m_enqueue_timestamp;
+    ///
     /// \brief m_transmit_timestamp Stores the last time in which the message was transmitted.
     ///
-    std::chrono::high_resolution_clock::time_point m_transmit_timestamp;
+    typename Clock::time_point m_transmit_timestamp;
     ///
     /// \brief m_n_transmissions Stores the total number of times the message has been transmitted.
     ///
     uint8_t m_n_transmissions;
+    ///
+    /// \brief m_extensions Stores the extension entries carried with the message.
+    ///
+    std::vector<uint8_t> m_extensions;
+    ///
+    /// \brief m_delta_base Stores if the last transmission marked the payload as a delta base.
+    ///
+    bool m_delta_base;
+};
+///
+/// \brief Orders outbound messages for transmission: highest priority first, followed by oldest.
+///
+template <typename Clock = std::chrono::steady_clock>
+struct outbound_order
+{
+    bool operator()(const outbound<Clock>* a, const outbound<Clock>* b) const
+    {
+        // Higher priority first.
+        if(a->p_message()->p_priority() != b->p_message()->p_priority())
+        {
+            return a->p_message()->p_priority() > b->p_message()->p_priority();
+        }
+        // Then earlier sequence number, which is older.
+        return sequence_before(a->p_sequence_number(), b->p_sequence_number());
+    }
 };
 }}
 
@@ -0,0 +1,2927 @@
+/// \file protocol_engine.h
+/// \brief Defines the serial_communicator::utility::protocol_engine class.
+#ifndef PROTOCOL_ENGINE_H
+#define PROTOCOL_ENGINE_H
+
+#include "pcd/qt-serial_communicator/channel_config.h"
+#include "pcd/qt-serial_communicator/latency_metric.h"
+#include "pcd/qt-serial_communicator/link_quality.h"
+#include "pcd/qt-serial_communicator/message.h"
+#include "pcd/qt-serial_communicator/message_status.h"
+#include "pcd/qt-serial_communicator/overflow_policy.h"
+#include "pcd/qt-serial_communicator/queue_mode.h"
+#include "pcd/qt-serial_communicator/utility/byte_order.h"
+#include "pcd/qt-serial_communicator/utility/delta.h"
+#include "pcd/qt-serial_communicator/utility/delta_cache.h"
+#include "pcd/qt-serial_communicator/utility/frame_engine.h"
+#include "pcd/qt-serial_communicator/utility/inbound.h"
+#include "pcd/qt-serial_communicator/utility/latency_recorder.h"
+#include "pcd/qt-serial_communicator/utility/lz77.h"
+#include "pcd/qt-serial_communicator/utility/outbound.h"
+#include "pcd/qt-serial_communicator/utility/sequence.h"
+#include "pcd/qt-serial_communicator/utility/slot_pool.h"
+#include "pcd/qt-serial_communicator/utility/statistics_tracker.h"
+#include "pcd/qt-serial_communicator/utility/status_observer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Runs the serial protocol's queues, scheduling, receipts, retransmission, flow control, and link upkeep, without depending on Qt.
+/// \details The engine owns the transmit and receive queues, and a frame_engine for the wire format.  It
+/// keeps no timers of its own: poll() does whatever work is due at Clock::now(), so the engine runs the
+/// same under an event loop, a busy loop, or a test that steps its own clock.  Its collaborators are
+/// template parameters, so every call resolves at compile time:
+/// - Host is the frame engine's transport, so it provides write(const uint8_t* data, uint32_t length).  It is also told of events the engine cannot handle alone:
+///   - wake(uint32_t milliseconds) asks for poll() to be called again within the given time.
+///   - link_changed(const link_quality& quality) reports that the link went up or down.
+///   - link_quality_updated(const link_quality& quality) reports a new round trip time measurement.
+///   - correlated(bool response, uint32_t correlation, const uint8_t* bytes, uint8_t channel, bool receipt_required, typename Clock::time_point arrival)
+///     offers a received message that belongs to a call, in its serialized form, and returns TRUE if the host consumed it.
+///   - retired(uint32_t sequence_number) reports that an outbound message has left the transmit queue.
+///   - offloads() returns TRUE if another thread is offered for validating received frames.
+///   - submit(std::function<void()> work) offers a received frame's validation to that thread, and returns FALSE to have it done in place.
+///   - decoded() is called from that thread once a frame is validated, and asks for collect() to be called on the engine's thread.
+/// - Clock provides now() and a time_point type, and drives every timeout.  Every timestamp the engine keeps is a Clock::time_point.
+/// - Allocator allocates bytes, and is rebound for the engine's queues, messages, and frame buffers, and for the frame engine's buffers.
+///   Frames validated on the host's thread are expanded there, so the allocator must then be safe to use from both threads.
+///
+template <typename Host, typename Clock = std::chrono::steady_clock, typename Allocator = std::allocator<uint8_t>>
+class protocol_engine
+{
+public:
+    // ENUMERATIONS
+    ///
+    /// \brief Enumerates the protocol features offered in hello frames.
+    ///
+    enum class feature
+    {
+        HEADER_CHECKSUM = 0x01, ///< Frame headers carry a header checksum.
+        COMPRESSION = 0x02,     ///< Frames may carry compressed payloads.
+        DELTA = 0x04,           ///< Frames may carry delta encoded payloads.
+        EXTENSIONS = 0x08       ///< Frames may carry piggybacked receipts and credits in extension blocks.
+    };
+    ///
+    /// \brief Enumerates the roles of a frame within a remote call.
+    ///
+    enum class call_kind
+    {
+        REQUEST = 0,            ///< The frame is a request.
+        RESPONSE = 1            ///< The frame is a response.
+    };
+
+    // CONSTRUCTORS
+    ///
+    /// \brief protocol_engine Creates a new protocol_engine instance.
+    /// \param host The host that escaped packets are written to, and that is told of events.
+    /// \param allocator The allocator for the engine's and the frame engine's buffers.
+    ///
+    protocol_engine(Host host = Host(), const Allocator& allocator = Allocator())
+        : m_frames(host, allocator),
+          m_allocator(allocator),
+          m_delta_bases(1),
+          m_delta_history(m_delta_depth),
+          m_pending_receipts(receipt_allocator(allocator)),
+          m_tx_queue(m_queue_chunk, allocator),
+          m_rx_queue(m_queue_chunk, allocator),
+          m_channels(std::less<uint8_t>(), channel_allocator(allocator)),
+          m_tx_index(0, std::hash<uint32_t>(), std::equal_to<uint32_t>(), index_allocator(allocator)),
+          m_decoding(job_list_allocator(allocator))
+    {
+        // Initialize parameters to default values.
+        protocol_engine::m_queue_size = 10;
+        protocol_engine::m_queue_mode = queue_mode::FIXED;
+        protocol_engine::m_queue_memory_limit = 1048576;
+        protocol_engine::m_overflow_policy = overflow_policy::REJECT;
+        protocol_engine::m_receipt_timeout = 100;
+        protocol_engine::m_max_transmissions = 5;
+        protocol_engine::m_header_checksum = false;
+        protocol_engine::m_max_data_length = 0xFFFF;
+        protocol_engine::m_compression_threshold = 32;
+        protocol_engine::m_ack_delay = 0;
+        protocol_engine::m_flow_control = false;
+        protocol_engine::m_heartbeat_interval = 0;
+        protocol_engine::m_fail_on_link_down = false;
+        protocol_engine::m_negotiation = false;
+        protocol_engine::m_receive_filter = false;
+
+        // Start on the legacy format until a negotiation completes.
+        protocol_engine::m_negotiated = false;
+        protocol_engine::m_peer_features = 0;
+        protocol_engine::m_peer_max_data_length = 0xFFFF;
+        protocol_engine::m_hellos_sent = 0;
+
+        // Nothing is due until receipts are held or heartbeats are enabled.
+        protocol_engine::m_ack_pending = false;
+        protocol_engine::m_last_heard = protocol_engine::now();
+        protocol_engine::m_in_flight.store(0);
+
+        // Initialize sequence counter.
+        protocol_engine::m_sequence_counter = 0;
+
+        // Create the default channel.  Until the peer advertises credits, it is assumed to have unbounded capacity.
+        protocol_engine::channel(0);
+        protocol_engine::m_round_robin_channel = 0;
+    }
+    ~protocol_engine()
+    {
+        // Wait for any other thread to finish with this engine's frames, and discard them.
+        while(protocol_engine::m_in_flight.load(std::memory_order_acquire) > 0)
+        {
+            std::this_thread::yield();
+        }
+        for(auto job = protocol_engine::m_decoding.begin(); job != protocol_engine::m_decoding.end(); ++job)
+        {
+            protocol_engine::deallocate((*job)->packet, (*job)->packet_length);
+            protocol_engine::release((*job)->expanded);
+            protocol_engine::destroy(*job);
+        }
+
+        // Clean up queues.
+        for(uint32_t i = 0; i < protocol_engine::m_tx_queue.p_capacity(); i++)
+        {
+            protocol_engine::destroy(protocol_engine::m_tx_queue.at(i));
+        }
+        for(uint32_t i = 0; i < protocol_engine::m_rx_queue.p_capacity(); i++)
+        {
+            protocol_engine::destroy(protocol_engine::m_rx_queue.at(i));
+        }
+    }
+
+    // METHODS
+    ///
+    /// \brief enqueue Adds a message to the transmit queue.
+    /// \param message The message to send.  The engine takes ownership of the pointer.
+    /// \param receipt_required Indicates if the receiver must acknowledge the message.
+    /// \param tracker OPTIONAL A tracker of the message's status.
+    /// \param observer OPTIONAL A shared observer of the message's status.
+    /// \param extensions OPTIONAL Extension entries to carry with the message.
+    /// \return TRUE if the message was queued, otherwise FALSE, in which case the message is deleted.
+    ///
+    bool enqueue(message* message, bool receipt_required, message_status* tracker = nullptr, std::shared_ptr<status_observer> observer = nullptr, std::vector<uint8_t> extensions = std::vector<uint8_t>())
+    {
+        // Make room in the transmit queue according to the overflow policy.
+        if(!protocol_engine::accepts(*message) || !protocol_engine::make_room(message->p_channel(), message->p_message_length(), message->p_priority()))
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_REJECTED);
+            delete message;
+            return false;
+        }
+        protocol_engine::admit(message, protocol_engine::reserve(), receipt_required, tracker, observer, std::move(extensions));
+        return true;
+    }
+    ///
+    /// \brief accepts Checks if the peer can take a message.
+    /// \param message The message to check.
+    /// \return FALSE if the peer would discard the message or could not parse it, otherwise TRUE.
+    ///
+    bool accepts(const message& message) const
+    {
+        // Messages on other channels carry their channel in an extension block.
+        return !(protocol_engine::m_negotiated && message.p_data_length() > protocol_engine::m_peer_max_data_length) &&
+               !(message.p_channel() != 0 && !protocol_engine::uses(feature::EXTENSIONS));
+    }
+    ///
+    /// \brief fits Checks if a message could be held by a channel's empty transmit queue.
+    /// \param channel The channel of the message.
+    /// \param length The length of the message.
+    /// \return TRUE if the message fits, otherwise FALSE.
+    ///
+    bool fits(uint8_t channel, uint32_t length)
+    {
+        return !protocol_engine::queue_full(protocol_engine::channel(channel), 0, 0, length);
+    }
+    ///
+    /// \brief has_room Checks if a channel's transmit queue has room for a message without dropping any other.
+    /// \param channel The channel of the message.
+    /// \param length The length of the message.
+    /// \return TRUE if there is room, otherwise FALSE.
+    ///
+    bool has_room(uint8_t channel, uint32_t length)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(channel);
+        return !protocol_engine::queue_full(state, state.tx_size, state.tx_bytes, length);
+    }
+    ///
+    /// \brief make_room Makes room in a channel's transmit queue according to the overflow policy.
+    /// \param channel The channel of the message.
+    /// \param length The length of the message.
+    /// \param priority The priority of the message.
+    /// \return TRUE if there is now room for the message, otherwise FALSE.
+    ///
+    bool make_room(uint8_t channel, uint32_t length, uint8_t priority)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(channel);
+
+        // Refuse a message that would not fit even in an empty queue, rather than dropping everything for it.
+        if(protocol_engine::queue_full(state, 0, 0, length))
+        {
+            return false;
+        }
+
+        while(protocol_engine::queue_full(state, state.tx_size, state.tx_bytes, length))
+        {
+            // Pick the message to drop according to the overflow policy.
+            outbound_message* victim = nullptr;
+            switch(protocol_engine::m_overflow_policy)
+            {
+            case overflow_policy::REJECT:
+            {
+                break;
+            }
+            case overflow_policy::DROP_OLDEST:
+            {
+                // The channel's age order lists its oldest message first.
+                if(!state.tx_age.empty())
+                {
+                    victim = protocol_engine::m_tx_queue.at(protocol_engine::m_tx_index[state.tx_age.begin()->second]);
+                }
+                break;
+            }
+            case overflow_policy::DROP_LOWEST_PRIORITY:
+            {
+                // The channel's ready set ends with its newest message of the lowest priority.
+                if(!state.tx_ready.empty() && (*state.tx_ready.rbegin())->p_message()->p_priority() < priority)
+                {
+                    victim = *state.tx_ready.rbegin();
+                }
+                break;
+            }
+            }
+            if(!victim)
+            {
+                return false;
+            }
+
+            // Drop the victim.
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_EVICTED);
+            protocol_engine::retire(victim, message_status::DROPPED);
+        }
+        return true;
+    }
+    ///
+    /// \brief reserve Reserves the next sequence number.
+    /// \return The reserved sequence number.
+    ///
+    uint32_t reserve()
+    {
+        return protocol_engine::m_sequence_counter++;
+    }
+    ///
+    /// \brief admit Adds a message to the transmit queue, which must have room for it.
+    /// \param message The message to send.  The engine takes ownership of the pointer.
+    /// \param sequence_number The message's reserved sequence number.
+    /// \param receipt_required Indicates if the receiver must acknowledge the message.
+    /// \param tracker A tracker of the message's status, or nullptr.
+    /// \param observer A shared observer of the message's status, or nullptr.
+    /// \param extensions Extension entries to carry with the message.
+    ///
+    void admit(message* message, uint32_t sequence_number, bool receipt_required, message_status* tracker, std::shared_ptr<status_observer> observer, std::vector<uint8_t> extensions)
+    {
+        // Carry the message's channel, unless it is the default channel.
+        if(message->p_channel() != 0)
+        {
+            extensions.push_back(static_cast<uint8_t>(protocol_engine::extension_type::CHANNEL));
+            extensions.push_back(1);
+            extensions.push_back(message->p_channel());
+        }
+
+        // Add outbound message.
+        outbound_message* entry = protocol_engine::create<outbound_message>(message, sequence_number, receipt_required, tracker, observer, protocol_engine::now());
+        entry->p_extensions(std::move(extensions));
+        uint32_t slot = protocol_engine::m_tx_queue.insert(entry);
+        protocol_engine::channel_state& state = protocol_engine::channel(message->p_channel());
+        state.tx_size++;
+        state.tx_bytes += message->p_message_length();
+        // Index and schedule the message.
+        protocol_engine::m_tx_index[sequence_number] = slot;
+        state.tx_age.insert(std::make_pair(entry->p_enqueue_timestamp(), sequence_number));
+        state.tx_ready.insert(entry);
+        // Update the queue high-water mark.
+        protocol_engine::m_statistics.high_water(statistics_tracker::gauge::TX_QUEUE, protocol_engine::m_tx_queue.p_size());
+    }
+    ///
+    /// \brief cancel Withdraws a message from the transmit queue, whether it is queued or awaiting a receipt.
+    /// \param sequence_number The sequence number of the message.
+    /// \param observer The observer the message was queued with.
+    /// \return TRUE if the message was withdrawn, otherwise FALSE.
+    ///
+    bool cancel(uint32_t sequence_number, const status_observer* observer)
+    {
+        outbound_message* message = protocol_engine::find(sequence_number, observer);
+        if(!message)
+        {
+            return false;
+        }
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_CANCELLED);
+        protocol_engine::retire(message, message_status::CANCELLED);
+        return true;
+    }
+    ///
+    /// \brief set_priority Changes the priority of a message in the transmit queue.
+    /// \param sequence_number The sequence number of the message.
+    /// \param observer The observer the message was queued with.
+    /// \param priority The new priority.
+    /// \return TRUE if the message was found, otherwise FALSE.
+    ///
+    bool set_priority(uint32_t sequence_number, const status_observer* observer, uint8_t priority)
+    {
+        outbound_message* message = protocol_engine::find(sequence_number, observer);
+        if(!message)
+        {
+            return false;
+        }
+        // Only the ready set is ordered by priority, so reposition the message there if it is ready.
+        protocol_engine::channel_state& state = protocol_engine::channel(message->p_message()->p_channel());
+        bool ready = state.tx_ready.erase(message) > 0;
+        message->reprioritize(priority);
+        if(ready)
+        {
+            state.tx_ready.insert(message);
+        }
+        return true;
+    }
+    ///
+    /// \brief take Takes the highest priority, oldest message from the receive queue.
+    /// \param channel The channel to take from, or -1 for any channel.
+    /// \param id The ID to take, or 0xFFFF for any ID.
+    /// \return The message, or nullptr if none matches.  The caller takes ownership of the pointer.
+    ///
+    message* take(int16_t channel, uint16_t id)
+    {
+        // Find a message with the matching channel and ID that has the highest priority, followed by oldest age.
+        inbound_message* to_read = nullptr;
+        uint32_t location = 0;
+
+        for(uint32_t i = 0; i < protocol_engine::m_rx_queue.p_capacity(); i++)
+        {
+            // Check if there is a valid message at this location.
+            if(protocol_engine::m_rx_queue.at(i) != nullptr)
+            {
+                // Store local reference to this message.
+                inbound_message* current = protocol_engine::m_rx_queue.at(i);
+
+                // Check if the message has a matching channel and id.
+                if((channel < 0 || current->p_channel() == channel) && (id == 0xFFFF || current->p_id() == id))
+                {
+                    // If to_read is currently empty, initialize it.
+                    if(to_read == nullptr)
+                    {
+                        to_read = current;
+                        location = i;
+                    }
+                    else
+                    {
+                        // Check to see if the current message beats the to_read message in priority.
+                        if(current->p_priority() > to_read->p_priority())
+                        {
+                            // Replace the to_read message with the current message.
+                            to_read = current;
+                            location = i;
+                        }
+                        // Otherwise, check if priorities are equal.
+                        else if(current->p_priority() == to_read->p_priority())
+                        {
+                            // Compare age.
+                            if(sequence_before(current->p_sequence_number(), to_read->p_sequence_number()))
+                            {
+                                // Replace to_read message with current message.
+                                to_read = current;
+                                location = i;
+                            }
+                        }
+                    }
+
+                }
+            }
+        }
+
+        // Check if a message was actually found.
+        if(to_read == nullptr)
+        {
+            return nullptr;
+        }
+
+        // If this point has been reached, a valid message has been found to read.
+
+        // Create the message from the inbound instance before it is deleted.
+        message* output = to_read->materialize();
+
+        // Record the time the message waited in the receive queue.
+        protocol_engine::m_latency.record(latency_metric::DELIVERY, output->p_priority(), output->p_id(), protocol_engine::elapsed_us(to_read->p_parse_timestamp()));
+
+        // Remove the inbound entry from the receive queue.
+        protocol_engine::destroy(protocol_engine::m_rx_queue.remove(location));
+        protocol_engine::channel_state& state = protocol_engine::channel(output->p_channel());
+        state.rx_size--;
+        state.rx_bytes -= output->p_message_length();
+
+        // Return the read message.
+        return output;
+    }
+    ///
+    /// \brief messages_available Gets the number of messages in the receive queue.
+    /// \return The number of messages available.
+    ///
+    uint32_t messages_available() const
+    {
+        return protocol_engine::m_rx_queue.p_size();
+    }
+    ///
+    /// \brief messages_available Gets the number of messages in a channel's receive queue.
+    /// \param channel The channel.
+    /// \return The number of messages available on the channel.
+    ///
+    uint32_t messages_available(uint8_t channel) const
+    {
+        auto state = protocol_engine::m_channels.find(channel);
+        return state == protocol_engine::m_channels.end() ? 0 : state->second.rx_size;
+    }
+    ///
+    /// \brief ingest Adds bytes received from the peer.
+    /// \param data The received bytes.
+    /// \param length The number of received bytes.
+    /// \param timestamp The time at which the bytes were received.
+    ///
+    void ingest(const uint8_t* data, uint32_t length, typename Clock::time_point timestamp)
+    {
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_BYTES, length);
+
+        // Add to the frame engine's buffer, which handles escapes.
+        protocol_engine::m_frames.ingest(data, length, timestamp);
+    }
+    ///
+    /// \brief ingest Adds bytes received from the peer, timestamped with the current time.
+    /// \param data The received bytes.
+    /// \param length The number of received bytes.
+    ///
+    void ingest(const uint8_t* data, uint32_t length)
+    {
+        protocol_engine::ingest(data, length, Clock::now());
+    }
+    ///
+    /// \brief poll Does all work that is due: transmits the next message, handles received frames, and checks every timeout.
+    /// \details Call this regularly, and whenever the host is asked to wake.  At most one message is transmitted per call.
+    ///
+    void poll()
+    {
+        // Check the link before deciding what can be transmitted.
+        timestamp current = protocol_engine::now();
+        if(protocol_engine::m_heartbeat_interval > 0 && current >= protocol_engine::m_heartbeat_due)
+        {
+            protocol_engine::heartbeat();
+            protocol_engine::m_heartbeat_due = current + std::chrono::milliseconds(protocol_engine::m_heartbeat_interval);
+            protocol_engine::host().wake(protocol_engine::m_heartbeat_interval);
+        }
+
+        protocol_engine::spin_tx();
+        // Parse every complete frame that is waiting.
+        while(protocol_engine::spin_rx())
+        {
+        }
+        // Finish frames that were validated on another thread since the last poll.
+        protocol_engine::collect();
+        protocol_engine::update_credits();
+
+        // No outbound frame carried the pending receipts in time, so send them on their own.
+        current = protocol_engine::now();
+        if(protocol_engine::m_ack_pending && current >= protocol_engine::m_ack_due)
+        {
+            protocol_engine::flush_receipts();
+        }
+        // Retry an unanswered hello.
+        if(protocol_engine::m_negotiation && !protocol_engine::m_negotiated && protocol_engine::m_hellos_sent < protocol_engine::m_hello_attempts && current - protocol_engine::m_hello_timestamp >= std::chrono::milliseconds(protocol_engine::m_hello_interval))
+        {
+            protocol_engine::send_hello(false);
+        }
+    }
+    ///
+    /// \brief spin_tx Retransmits timed out messages, and transmits the next message the scheduler picks.
+    ///
+    void spin_tx()
+    {
+        // Receipt-required messages cannot be delivered over a dead link.
+        if(!protocol_engine::m_link_quality.up && protocol_engine::m_fail_on_link_down)
+        {
+            protocol_engine::fail_unacknowledged();
+        }
+
+        // Return messages whose receipt timeout has elapsed to their channel's ready set.
+        // Waiting messages are ordered by transmission time, so only the earliest of each channel need checking.
+        timestamp current = protocol_engine::now();
+        for(auto state = protocol_engine::m_channels.begin(); state != protocol_engine::m_channels.end(); ++state)
+        {
+            uint32_t receipt_timeout = state->second.config.receipt_timeout ? state->second.config.receipt_timeout : protocol_engine::m_receipt_timeout;
+            while(!state->second.tx_waiting.empty())
+            {
+                outbound_message* waiting = protocol_engine::m_tx_queue.at(protocol_engine::m_tx_index[state->second.tx_waiting.begin()->second]);
+                if(!waiting->timeout_elapsed(receipt_timeout, current))
+                {
+                    break;
+                }
+                state->second.tx_waiting.erase(state->second.tx_waiting.begin());
+                state->second.tx_ready.insert(waiting);
+            }
+        }
+
+        // Share the link between channels by deficit round robin.
+        // Each channel with a message to send earns its weight in quanta of bytes per round, and sends its
+        // highest priority, oldest message that the link, receiver, and window allow once it has earned the message's length.
+        auto current_channel = protocol_engine::m_channels.find(protocol_engine::m_round_robin_channel);
+        uint32_t n_idle = 0;
+        bool stalled = false;
+        while(n_idle < protocol_engine::m_channels.size())
+        {
+            protocol_engine::channel_state& state = current_channel->second;
+            auto ready = state.tx_ready.begin();
+            while(ready != state.tx_ready.end() && !protocol_engine::can_transmit(state, *ready))
+            {
+                ++ready;
+            }
+            if(ready == state.tx_ready.end())
+            {
+                // Channels with nothing to send do not save up their share.
+                stalled |= !state.tx_ready.empty();
+                state.deficit = 0;
+                n_idle++;
+            }
+            else
+            {
+                n_idle = 0;
+                uint32_t length = (*ready)->p_message()->p_message_length();
+                if(length <= state.deficit)
+                {
+                    // Send the message, and stay on the channel while it has share left.
+                    state.deficit -= length;
+                    outbound_message* to_send = *ready;
+                    state.tx_ready.erase(ready);
+                    protocol_engine::m_round_robin_channel = current_channel->first;
+                    protocol_engine::transmit(to_send);
+                    return;
+                }
+            }
+
+            // Move on to the next channel, which earns its share for the round.
+            if(++current_channel == protocol_engine::m_channels.end())
+            {
+                current_channel = protocol_engine::m_channels.begin();
+            }
+            current_channel->second.deficit += static_cast<uint64_t>(protocol_engine::m_channel_quantum) * current_channel->second.config.weight;
+        }
+        // Every ready message is waiting for credits, its channel's window, or for the link to come back up.
+        if(stalled && protocol_engine::m_link_quality.up)
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_CREDIT_STALLS);
+        }
+    }
+    ///
+    /// \brief spin_rx Reads and handles the next received frame.
+    /// \return TRUE if a frame or corrupt frame was handled, or FALSE if more bytes are needed.
+    ///
+    bool spin_rx()
+    {
+        // Parse headers in the format currently in use, and bound their data length.
+        // When negotiating, each frame flags its own header checksum, since the format changes while frames are in flight.
+        protocol_engine::m_frames.p_header_mode(protocol_engine::m_negotiation ? framing::header_mode::FLAGGED : protocol_engine::m_header_checksum ? framing::header_mode::CHECKSUM : framing::header_mode::PLAIN);
+        protocol_engine::m_frames.p_max_data_length(protocol_engine::m_max_data_length);
+
+        // Find the next frame, discarding any bytes that precede it.
+        typename framing::frame frame;
+        uint64_t discarded;
+        typename framing::result result = protocol_engine::m_frames.next(frame, discarded);
+        if(discarded > 0)
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_DISCARDED_BYTES, discarded);
+        }
+        switch(result)
+        {
+        case framing::result::INCOMPLETE:
+        {
+            return false;
+        }
+        case framing::result::TRUNCATED:
+        {
+            // The frame was cut short by the next header, or its length is corrupt.
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_TRUNCATED);
+            protocol_engine::observe_frame(false);
+            return true;
+        }
+        case framing::result::HEADER_FAILURE:
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_HEADER_FAILURES);
+            protocol_engine::observe_frame(false);
+            return true;
+        }
+        case framing::result::OVERSIZE:
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_OVERSIZE);
+            protocol_engine::observe_frame(false);
+            return true;
+        }
+        case framing::result::FRAME:
+        {
+            break;
+        }
+        }
+
+        // Create packet array and read packet from the frame engine.
+        uint8_t* packet = protocol_engine::allocate(frame.packet_length);
+        protocol_engine::m_frames.take(frame, packet);
+
+        // If this point is reached, a full packet has been read.
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_FRAMES);
+
+        // Validate and finish the frame right away if no other thread is offered and no earlier frame is still queued.
+        if(!protocol_engine::host().offloads() && protocol_engine::m_decoding.empty())
+        {
+            protocol_engine::decode_job job;
+            protocol_engine::prepare(job, packet, frame);
+            protocol_engine::decode(&job);
+            protocol_engine::finish(job);
+            return true;
+        }
+
+        // Otherwise offer the frame to the host's thread.
+        protocol_engine::decode_job* job = protocol_engine::create<protocol_engine::decode_job>();
+        protocol_engine::prepare(*job, packet, frame);
+        protocol_engine::m_in_flight.fetch_add(1, std::memory_order_relaxed);
+        if(!protocol_engine::host().submit([this, job]() { protocol_engine::decode(job); protocol_engine::decoded(); }))
+        {
+            // The thread is busy, so validate the frame here.
+            protocol_engine::m_in_flight.fetch_sub(1, std::memory_order_relaxed);
+            protocol_engine::decode(job);
+            // Only queue the frame if it must wait behind earlier frames.
+            if(protocol_engine::m_decoding.empty())
+            {
+                protocol_engine::finish(*job);
+                protocol_engine::destroy(job);
+                return true;
+            }
+        }
+        protocol_engine::m_decoding.push_back(job);
+
+        // Finish validated frames in the order they arrived.
+        protocol_engine::collect();
+
+        return true;
+    }
+    ///
+    /// \brief collect Finishes validated frames, in the order they arrived.
+    ///
+    void collect()
+    {
+        // Stop at the first frame still being validated, so that frames are never finished out of order.
+        while(!protocol_engine::m_decoding.empty() && protocol_engine::m_decoding.front()->done.load(std::memory_order_acquire))
+        {
+            protocol_engine::decode_job* job = protocol_engine::m_decoding.front();
+            protocol_engine::m_decoding.pop_front();
+            protocol_engine::finish(*job);
+            protocol_engine::destroy(job);
+        }
+    }
+    ///
+    /// \brief reset_delta Forgets every delta base, sent and received.
+    ///
+    void reset_delta()
+    {
+        protocol_engine::m_delta_bases.clear();
+        protocol_engine::m_delta_history.clear();
+        protocol_engine::m_delta_peer.reset();
+    }
+    ///
+    /// \brief uses Checks if a feature is used on the link.
+    /// \param feature The feature to check.
+    /// \return TRUE if the feature is in use, otherwise FALSE.
+    ///
+    bool uses(feature feature) const
+    {
+        // Without negotiation, the local settings alone decide.
+        if(!protocol_engine::m_negotiation)
+        {
+            return feature != protocol_engine::feature::HEADER_CHECKSUM || protocol_engine::m_header_checksum;
+        }
+        // Otherwise, a feature is only used once both ends have offered it.
+        return protocol_engine::m_negotiated && (protocol_engine::local_features() & protocol_engine::m_peer_features & static_cast<uint8_t>(feature));
+    }
+    ///
+    /// \brief correlation_entry Creates the extension entry that ties a frame to a call.
+    /// \param kind The frame's role within the call.
+    /// \param correlation The correlation ID of the call.
+    /// \return The extension entry.
+    ///
+    static std::vector<uint8_t> correlation_entry(call_kind kind, uint32_t correlation)
+    {
+        std::vector<uint8_t> entry(7);
+        entry[0] = static_cast<uint8_t>(protocol_engine::extension_type::CORRELATION);
+        entry[1] = 5;
+        entry[2] = static_cast<uint8_t>(kind);
+        store_big_endian(&entry[3], correlation);
+        return entry;
+    }
+
+    // PROPERTIES
+    ///
+    /// \brief p_queue_size Gets the size of each channel's transmit and receive queues, in messages.
+    /// \return The queue size.
+    ///
+    uint16_t p_queue_size() const
+    {
+        return protocol_engine::m_queue_size;
+    }
+    ///
+    /// \brief p_queue_size Sets the size of each channel's transmit and receive queues, in messages.
+    /// \param value The queue size.
+    ///
+    void p_queue_size(uint16_t value)
+    {
+        // The queues grow on demand, so only the bound changes.
+        protocol_engine::m_queue_size = value;
+        // Release any storage left unused at the end of the queues.
+        protocol_engine::m_tx_queue.trim();
+        protocol_engine::m_rx_queue.trim();
+    }
+    ///
+    /// \brief p_queue_mode Gets how the queues are bounded.
+    /// \return The queue mode.
+    ///
+    queue_mode p_queue_mode() const
+    {
+        return protocol_engine::m_queue_mode;
+    }
+    ///
+    /// \brief p_queue_mode Sets how the queues are bounded.
+    /// \param value The queue mode.
+    ///
+    void p_queue_mode(queue_mode value)
+    {
+        protocol_engine::m_queue_mode = value;
+        protocol_engine::m_tx_queue.trim();
+        protocol_engine::m_rx_queue.trim();
+    }
+    ///
+    /// \brief p_queue_memory_limit Gets the most message bytes each queue may hold in ELASTIC mode.
+    /// \return The memory limit in bytes.
+    ///
+    uint32_t p_queue_memory_limit() const
+    {
+        return protocol_engine::m_queue_memory_limit;
+    }
+    ///
+    /// \brief p_queue_memory_limit Sets the most message bytes each queue may hold in ELASTIC mode.
+    /// \param value The memory limit in bytes.
+    ///
+    void p_queue_memory_limit(uint32_t value)
+    {
+        protocol_engine::m_queue_memory_limit = value;
+        protocol_engine::m_tx_queue.trim();
+        protocol_engine::m_rx_queue.trim();
+    }
+    ///
+    /// \brief p_overflow_policy Gets what happens when a message arrives at a full queue.
+    /// \return The overflow policy.
+    ///
+    overflow_policy p_overflow_policy() const
+    {
+        return protocol_engine::m_overflow_policy;
+    }
+    ///
+    /// \brief p_overflow_policy Sets what happens when a message arrives at a full queue.
+    /// \param value The overflow policy.
+    ///
+    void p_overflow_policy(overflow_policy value)
+    {
+        protocol_engine::m_overflow_policy = value;
+    }
+    ///
+    /// \brief p_receipt_timeout Gets the receipt timeout.
+    /// \return The receipt timeout in milliseconds.
+    ///
+    uint32_t p_receipt_timeout() const
+    {
+        return protocol_engine::m_receipt_timeout;
+    }
+    ///
+    /// \brief p_receipt_timeout Sets the receipt timeout.
+    /// \param value The receipt timeout in milliseconds.
+    ///
+    void p_receipt_timeout(uint32_t value)
+    {
+        protocol_engine::m_receipt_timeout = value;
+    }
+    ///
+    /// \brief p_max_transmissions Gets the maximum number of transmissions of one message.
+    /// \return The maximum number of transmissions.
+    ///
+    uint8_t p_max_transmissions() const
+    {
+        return protocol_engine::m_max_transmissions;
+    }
+    ///
+    /// \brief p_max_transmissions Sets the maximum number of transmissions of one message.
+    /// \param value The maximum number of transmissions.
+    ///
+    void p_max_transmissions(uint8_t value)
+    {
+        protocol_engine::m_max_transmissions = value;
+    }
+    ///
+    /// \brief p_channel Gets the settings of a logical channel.
+    /// \param channel The channel.
+    /// \return The channel's settings, or the defaults if it has not been used.
+    ///
+    channel_config p_channel(uint8_t channel) const
+    {
+        auto state = protocol_engine::m_channels.find(channel);
+        if(state == protocol_engine::m_channels.end())
+        {
+            return channel_config();
+        }
+        return state->second.config;
+    }
+    ///
+    /// \brief p_channel Sets the settings of a logical channel.
+    /// \param channel The channel.
+    /// \param value The channel's settings.
+    ///
+    void p_channel(uint8_t channel, const channel_config& value)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(channel);
+        state.config = value;
+        // Every channel must earn some share of the link.
+        state.config.weight = std::max<uint16_t>(value.weight, 1);
+    }
+    ///
+    /// \brief p_header_checksum Gets if frames carry a header checksum.
+    /// \return TRUE if frames carry a header checksum, otherwise FALSE.
+    ///
+    bool p_header_checksum() const
+    {
+        return protocol_engine::m_header_checksum;
+    }
+    ///
+    /// \brief p_header_checksum Sets if frames carry a header checksum.
+    /// \param value TRUE if frames carry a header checksum, otherwise FALSE.
+    ///
+    void p_header_checksum(bool value)
+    {
+        protocol_engine::m_header_checksum = value;
+    }
+    ///
+    /// \brief p_compression Gets if an ID's payloads are compressed.
+    /// \param id The message ID.
+    /// \return TRUE if compressed, otherwise FALSE.
+    ///
+    bool p_compression(uint16_t id) const
+    {
+        return protocol_engine::m_compression.test(id);
+    }
+    ///
+    /// \brief p_compression Sets if an ID's payloads are compressed.
+    /// \param id The message ID.
+    /// \param value TRUE to compress, otherwise FALSE.
+    ///
+    void p_compression(uint16_t id, bool value)
+    {
+        protocol_engine::m_compression.set(id, value);
+    }
+    ///
+    /// \brief p_compression_threshold Gets the smallest data length that is considered for compression.
+    /// \return The threshold in bytes.
+    ///
+    uint16_t p_compression_threshold() const
+    {
+        return protocol_engine::m_compression_threshold;
+    }
+    ///
+    /// \brief p_compression_threshold Sets the smallest data length that is considered for compression.
+    /// \param value The threshold in bytes.
+    ///
+    void p_compression_threshold(uint16_t value)
+    {
+        protocol_engine::m_compression_threshold = value;
+    }
+    ///
+    /// \brief p_delta Gets if an ID's payloads are delta encoded.
+    /// \param id The message ID.
+    /// \return TRUE if delta encoded, otherwise FALSE.
+    ///
+    bool p_delta(uint16_t id) const
+    {
+        return protocol_engine::m_delta.test(id);
+    }
+    ///
+    /// \brief p_delta Sets if an ID's payloads are delta encoded.
+    /// \param id The message ID.
+    /// \param value TRUE to delta encode, otherwise FALSE.
+    ///
+    void p_delta(uint16_t id, bool value)
+    {
+        protocol_engine::m_delta.set(id, value);
+        if(!value)
+        {
+            protocol_engine::m_delta_bases.erase(id);
+        }
+    }
+    ///
+    /// \brief p_ack_delay Gets how long receipts are held waiting for an outbound frame to carry them.
+    /// \return The delay in milliseconds.
+    ///
+    uint32_t p_ack_delay() const
+    {
+        return protocol_engine::m_ack_delay;
+    }
+    ///
+    /// \brief p_ack_delay Sets how long receipts are held waiting for an outbound frame to carry them.
+    /// \param value The delay in milliseconds, or 0 to send receipts immediately.
+    ///
+    void p_ack_delay(uint32_t value)
+    {
+        protocol_engine::m_ack_delay = value;
+        // Send any receipts held under the previous delay.
+        if(value == 0)
+        {
+            protocol_engine::flush_receipts();
+        }
+    }
+    ///
+    /// \brief p_flow_control Gets if the free receive queue capacity is advertised to the sender.
+    /// \return TRUE if flow control is enabled, otherwise FALSE.
+    ///
+    bool p_flow_control() const
+    {
+        return protocol_engine::m_flow_control;
+    }
+    ///
+    /// \brief p_flow_control Sets if the free receive queue capacity is advertised to the sender.
+    /// \param value TRUE to enable flow control, otherwise FALSE.
+    ///
+    void p_flow_control(bool value)
+    {
+        protocol_engine::m_flow_control = value;
+    }
+    ///
+    /// \brief p_heartbeat_interval Gets the heartbeat interval.
+    /// \return The interval in milliseconds, or 0 if heartbeats are disabled.
+    ///
+    uint32_t p_heartbeat_interval() const
+    {
+        return protocol_engine::m_heartbeat_interval;
+    }
+    ///
+    /// \brief p_heartbeat_interval Sets the heartbeat interval.
+    /// \param value The interval in milliseconds, or 0 to disable heartbeats and assume the link is up.
+    ///
+    void p_heartbeat_interval(uint32_t value)
+    {
+        protocol_engine::m_heartbeat_interval = value;
+
+        // Schedule the first heartbeat, or assume the link is up if disabled.
+        if(value > 0)
+        {
+            protocol_engine::m_last_heard = protocol_engine::now();
+            protocol_engine::m_heartbeat_due = protocol_engine::m_last_heard + std::chrono::milliseconds(value);
+            protocol_engine::host().wake(value);
+        }
+        else
+        {
+            protocol_engine::set_link(true);
+        }
+    }
+    ///
+    /// \brief p_fail_on_link_down Gets if receipt-required messages fail when the link goes down.
+    /// \return TRUE if they fail, otherwise FALSE.
+    ///
+    bool p_fail_on_link_down() const
+    {
+        return protocol_engine::m_fail_on_link_down;
+    }
+    ///
+    /// \brief p_fail_on_link_down Sets if receipt-required messages fail when the link goes down.
+    /// \param value TRUE if they fail, otherwise FALSE.
+    ///
+    void p_fail_on_link_down(bool value)
+    {
+        protocol_engine::m_fail_on_link_down = value;
+    }
+    ///
+    /// \brief p_link_quality Gets the current estimate of the link.
+    /// \return The link quality.
+    ///
+    link_quality p_link_quality() const
+    {
+        return protocol_engine::m_link_quality;
+    }
+    ///
+    /// \brief p_negotiation Gets if protocol features are negotiated with the peer.
+    /// \return TRUE if negotiation is enabled, otherwise FALSE.
+    ///
+    bool p_negotiation() const
+    {
+        return protocol_engine::m_negotiation;
+    }
+    ///
+    /// \brief p_negotiation Sets if protocol features are negotiated with the peer.
+    /// \param value TRUE to start negotiating, or FALSE to return to the local settings.
+    ///
+    void p_negotiation(bool value)
+    {
+        protocol_engine::m_negotiation = value;
+
+        // Start negotiating with the peer, or return to the local settings.
+        if(value)
+        {
+            protocol_engine::negotiate();
+        }
+        else
+        {
+            protocol_engine::m_negotiated = false;
+        }
+    }
+    ///
+    /// \brief p_negotiated Gets if the peer has answered the negotiation.
+    /// \return TRUE if negotiated, otherwise FALSE.
+    ///
+    bool p_negotiated() const
+    {
+        return protocol_engine::m_negotiated;
+    }
+    ///
+    /// \brief p_receive_filter Gets if received messages of unsubscribed IDs are discarded.
+    /// \return TRUE if the filter is enabled, otherwise FALSE.
+    ///
+    bool p_receive_filter() const
+    {
+        return protocol_engine::m_receive_filter;
+    }
+    ///
+    /// \brief p_receive_filter Sets if received messages of unsubscribed IDs are discarded.
+    /// \param value TRUE to enable the filter, otherwise FALSE.
+    ///
+    void p_receive_filter(bool value)
+    {
+        protocol_engine::m_receive_filter = value;
+    }
+    ///
+    /// \brief p_subscribed Gets if an ID passes the receive filter.
+    /// \param id The message ID.
+    /// \return TRUE if subscribed, otherwise FALSE.
+    ///
+    bool p_subscribed(uint16_t id) const
+    {
+        return protocol_engine::m_subscribed.test(id);
+    }
+    ///
+    /// \brief p_subscribed Sets if an ID passes the receive filter.
+    /// \param id The message ID.
+    /// \param value TRUE to subscribe, otherwise FALSE.
+    ///
+    void p_subscribed(uint16_t id, bool value)
+    {
+        protocol_engine::m_subscribed.set(id, value);
+    }
+    ///
+    /// \brief p_max_data_length Gets the largest data length accepted in a received frame.
+    /// \return The maximum data length in bytes.
+    ///
+    uint16_t p_max_data_length() const
+    {
+        return protocol_engine::m_max_data_length;
+    }
+    ///
+    /// \brief p_max_data_length Sets the largest data length accepted in a received frame.
+    /// \param value The maximum data length in bytes.
+    ///
+    void p_max_data_length(uint16_t value)
+    {
+        protocol_engine::m_max_data_length = value;
+    }
+    ///
+    /// \brief p_next_sequence Gets the sequence number that the next queued message will be assigned.
+    /// \return The next sequence number.
+    ///
+    uint32_t p_next_sequence() const
+    {
+        return protocol_engine::m_sequence_counter;
+    }
+    ///
+    /// \brief p_statistics Gets the engine's runtime counters.
+    /// \return A reference to the statistics tracker.
+    ///
+    statistics_tracker& p_statistics()
+    {
+        return protocol_engine::m_statistics;
+    }
+    ///
+    /// \brief p_statistics Gets the engine's runtime counters.
+    /// \return A const reference to the statistics tracker.
+    ///
+    const statistics_tracker& p_statistics() const
+    {
+        return protocol_engine::m_statistics;
+    }
+    ///
+    /// \brief p_latency Gets the engine's latency histograms.
+    /// \return A reference to the latency recorder.
+    ///
+    latency_recorder& p_latency()
+    {
+        return protocol_engine::m_latency;
+    }
+    ///
+    /// \brief p_latency Gets the engine's latency histograms.
+    /// \return A const reference to the latency recorder.
+    ///
+    const latency_recorder& p_latency() const
+    {
+        return protocol_engine::m_latency;
+    }
+    ///
+    /// \brief p_host Gets the host that escaped packets are written to.
+    /// \return A reference to the host.
+    ///
+    Host& p_host()
+    {
+        return protocol_engine::host();
+    }
+
+private:
+    // ENUMERATIONS
+    ///
+    /// \brief Enumerates the types of the message's receipt field.
+    ///
+    enum class receipt_type
+    {
+        NOT_REQUIRED = 0,       ///< In a transmitted message, indicates that no receipt is required from the receiver.
+        REQUIRED = 1,           ///< In a transmitted message, indicates that a receipt is required from the receiver.
+        RECEIVED = 2,           ///< In a receipt message, indicates that the message was properly received.
+        CHECKSUM_MISMATCH = 3,  ///< In a receipt message, indicates that the message was received, but the checksum did not match.
+        CONTROL = 4             ///< Indicates a control frame, which is handled by the engine and whose ID field holds the control type.
+    };
+    ///
+    /// \brief Enumerates the types of control frames.
+    ///
+    enum class control_type
+    {
+        CREDITS = 0,            ///< Carries no data.  The frame's extension block holds the sender's newly freed credits.
+        HEARTBEAT = 1,          ///< Carries a heartbeat kind and the 8 byte timestamp of the ping.
+        HELLO = 2               ///< Carries a protocol version, a reply flag, the supported features, and the 2 byte maximum data length.
+    };
+    ///
+    /// \brief Enumerates the kinds of heartbeat.
+    ///
+    enum class heartbeat_kind
+    {
+        PING = 0,               ///< A heartbeat to be answered.
+        PONG = 1                ///< The answer to a heartbeat, echoing its timestamp.
+    };
+    ///
+    /// \brief Enumerates the flags carried in the upper bits of the message's receipt field.
+    ///
+    enum class frame_flag
+    {
+        COMPRESSED = 0x80,      ///< Indicates that the data field holds the uncompressed data length followed by an LZ77 block.
+        DELTA = 0x40,           ///< Indicates that the data field holds a base sequence number, the data length, and a diff against the base.
+        EXTENDED = 0x20,        ///< Indicates that the data field is followed by a 2 byte length and a block of type-length-value extensions.
+        HEADER_CHECKSUM = 0x10  ///< When negotiating, indicates that the header carries a header checksum.
+    };
+    ///
+    /// \brief Enumerates the types of entries in a frame's extension block.
+    ///
+    enum class extension_type
+    {
+        RECEIPTS = 0x01,        ///< Receipts for other frames, as a 4 byte sequence number and a receipt type each.
+        CORRELATION = 0x02,     ///< The call this frame belongs to, as a call kind and a 4 byte correlation ID.
+        CREDITS = 0x03,         ///< The free capacity of the sender's default channel receive queue, as a 2 byte message count and a 4 byte length.
+        CHANNEL = 0x04,         ///< The logical channel of the frame's message, when not the default channel.
+        CHANNEL_CREDITS = 0x05, ///< The free capacity of the sender's other channel receive queues, as a channel, a 2 byte message count, and a 4 byte length each.
+        DELTA_BASE = 0x06       ///< Marks a payload that the sender will diff against once it is acknowledged, so the receiver caches it.  Has no value.
+    };
+
+    // TYPES
+    typedef frame_engine<Host, Clock, Allocator> framing;
+    typedef typename Clock::time_point timestamp;
+    typedef utility::outbound<Clock> outbound_message;
+    typedef utility::inbound<Clock, Allocator> inbound_message;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t> byte_allocator;
+    typedef std::vector<uint8_t, byte_allocator> byte_vector;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<outbound_message*> ready_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<timestamp, uint32_t>> schedule_allocator;
+    typedef std::set<outbound_message*, outbound_order<Clock>, ready_allocator> ready_set;
+    typedef std::set<std::pair<timestamp, uint32_t>, std::less<std::pair<timestamp, uint32_t>>, schedule_allocator> schedule_set;
+
+    // STRUCTURES
+    ///
+    /// \brief A receipt waiting to be sent.
+    ///
+    struct pending_receipt
+    {
+        uint32_t sequence_number;   ///< The sequence number of the frame being acknowledged.
+        uint16_t id;                ///< The message ID of the frame being acknowledged.
+        uint8_t priority;           ///< The priority of the frame being acknowledged.
+        receipt_type type;          ///< The receipt type.
+    };
+    ///
+    /// \brief The entries read from a frame's extension block that concern the frame itself.
+    ///
+    struct frame_extensions
+    {
+        bool correlated = false;    ///< Indicates that the frame belongs to a call.
+        call_kind kind;             ///< The frame's role within the call.
+        uint32_t correlation;       ///< The correlation ID of the call.
+        uint8_t channel = 0;        ///< The logical channel of the frame's message.
+        bool delta_base = false;    ///< Indicates that the frame's payload is a delta base.
+    };
+    ///
+    /// \brief The queues, scheduling, and credits of one logical channel.
+    ///
+    struct channel_state
+    {
+        explicit channel_state(const Allocator& allocator)
+            : tx_ready(outbound_order<Clock>(), ready_allocator(allocator)),
+              tx_waiting(std::less<std::pair<timestamp, uint32_t>>(), schedule_allocator(allocator)),
+              tx_age(std::less<std::pair<timestamp, uint32_t>>(), schedule_allocator(allocator))
+        {
+        }
+
+        channel_config config;                                  ///< The channel's settings.
+        ready_set tx_ready;                                     ///< The outbound messages ready to be transmitted, highest priority and oldest first.
+        schedule_set tx_waiting;                                ///< The outbound messages awaiting a receipt, by last transmission time and sequence number.
+        schedule_set tx_age;                                    ///< The channel's outbound messages, by enqueue time and sequence number, oldest first.
+        uint32_t tx_size = 0;                                   ///< The number of messages in the transmit queue.
+        uint64_t tx_bytes = 0;                                  ///< The total message length in the transmit queue.
+        uint32_t rx_size = 0;                                   ///< The number of messages in the receive queue.
+        uint64_t rx_bytes = 0;                                  ///< The total message length in the receive queue.
+        uint32_t tx_unacknowledged = 0;                         ///< The number of receipt-required messages transmitted but not yet retired.
+        uint64_t tx_unacknowledged_bytes = 0;                   ///< The total message length of receipt-required messages transmitted but not yet retired.
+        uint16_t peer_messages = 0xFFFF;                        ///< The free messages last advertised by the peer's receive queue.
+        uint32_t peer_bytes = 0xFFFFFFFF;                       ///< The free bytes last advertised by the peer's receive queue.
+        uint16_t advertised_messages = 0xFFFF;                  ///< The free receive queue messages last advertised to the peer.
+        uint32_t advertised_bytes = 0xFFFFFFFF;                 ///< The free receive queue bytes last advertised to the peer.
+        bool credits_unconfirmed = false;                       ///< Indicates that credits were raised after advertising a full queue, and the peer has not yet shown that it heard them.
+        timestamp credits_timestamp;                            ///< The last time credits were advertised to the peer.
+        uint64_t deficit = 0;                                   ///< The bytes the channel may still transmit in the current round robin round.
+    };
+    ///
+    /// \brief A received frame being validated, possibly on another thread.
+    ///
+    struct decode_job
+    {
+        uint8_t* packet;                    ///< The unescaped frame.
+        uint32_t packet_length;             ///< The length of the frame.
+        uint32_t header_length;             ///< The length of the frame's header.
+        uint16_t data_length;               ///< The length of the frame's data field as sent.
+        uint16_t extension_length;          ///< The length of the frame's extension block.
+        timestamp arrival;                  ///< The time at which the frame's last byte was read.
+        bool checksum_ok;                   ///< Indicates that the frame passed its checksum.
+        bool expanded_ok;                   ///< Indicates that any compressed data expanded successfully.
+        uint8_t* expanded;                  ///< The expanded message byte array, or nullptr.
+        std::atomic<bool> done;             ///< Indicates that validation has finished.
+    };
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<pending_receipt> receipt_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const uint8_t, channel_state>> channel_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const uint32_t, uint32_t>> index_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<decode_job*> job_list_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint32_t> sequence_allocator;
+
+    // CONSTANTS
+    ///
+    /// \brief m_receipt_mask Stores the mask of the receipt type within the receipt field.
+    ///
+    const uint8_t m_receipt_mask = 0x0F;
+    ///
+    /// \brief m_delta_depth Stores the number of received payloads kept per ID as delta bases.
+    ///
+    const uint8_t m_delta_depth = 4;
+    ///
+    /// \brief m_queue_chunk Stores the number of slots the transmit and receive queues grow by.
+    ///
+    const uint32_t m_queue_chunk = 16;
+    ///
+    /// \brief m_heartbeat_misses Stores the number of heartbeat intervals of silence after which the link is down.
+    ///
+    const uint32_t m_heartbeat_misses = 3;
+    ///
+    /// \brief m_protocol_version Stores the protocol version offered in hello frames.
+    ///
+    const uint8_t m_protocol_version = 1;
+    ///
+    /// \brief m_hello_attempts Stores the number of hellos sent before giving up on an unanswered negotiation.
+    ///
+    const uint8_t m_hello_attempts = 3;
+    ///
+    /// \brief m_hello_interval Stores the time to wait for an answer before resending a hello, in milliseconds.
+    ///
+    const uint32_t m_hello_interval = 250;
+    ///
+    /// \brief m_channel_quantum Stores the bytes a channel earns per unit of weight in each round robin round.
+    ///
+    const uint32_t m_channel_quantum = 512;
+
+    // PARAMETERS
+    ///
+    /// \brief m_queue_size Stores the size of the transmit/receive queues, in messages.
+    ///
+    uint16_t m_queue_size;
+    ///
+    /// \brief m_queue_mode Stores how the transmit/receive queues are bounded.
+    ///
+    queue_mode m_queue_mode;
+    ///
+    /// \brief m_queue_memory_limit Stores the most message bytes each queue may hold in ELASTIC mode.
+    ///
+    uint32_t m_queue_memory_limit;
+    ///
+    /// \brief m_overflow_policy Stores what happens when a message arrives at a full queue.
+    ///
+    overflow_policy m_overflow_policy;
+    ///
+    /// \brief m_receipt_timeout Stores the receipt timeout in milliseconds.
+    ///
+    uint32_t m_receipt_timeout;
+    ///
+    /// \brief m_max_transmissions Stores the maximum amount of transmissions for one message.
+    ///
+    uint8_t m_max_transmissions;
+    ///
+    /// \brief m_header_checksum Stores if frames carry a header checksum.
+    ///
+    bool m_header_checksum;
+    ///
+    /// \brief m_max_data_length Stores the largest data length accepted in a received frame.
+    ///
+    uint16_t m_max_data_length;
+    ///
+    /// \brief m_compression Stores which message IDs have their payloads compressed.
+    ///
+    std::bitset<65536> m_compression;
+    ///
+    /// \brief m_compression_threshold Stores the smallest data length that is considered for compression.
+    ///
+    uint16_t m_compression_threshold;
+    ///
+    /// \brief m_delta Stores which message IDs have their payloads delta encoded.
+    ///
+    std::bitset<65536> m_delta;
+    ///
+    /// \brief m_receive_filter Stores if received messages of unsubscribed IDs are discarded.
+    ///
+    bool m_receive_filter;
+    ///
+    /// \brief m_subscribed Stores which message IDs pass the receive filter.
+    ///
+    std::bitset<65536> m_subscribed;
+    ///
+    /// \brief m_ack_delay Stores how long receipts are held waiting for an outbound frame to carry them, in milliseconds.
+    ///
+    uint32_t m_ack_delay;
+    ///
+    /// \brief m_flow_control Stores if the free receive queue capacity is advertised to the sender.
+    ///
+    bool m_flow_control;
+    ///
+    /// \brief m_heartbeat_interval Stores the heartbeat interval in milliseconds.
+    ///
+    uint32_t m_heartbeat_interval;
+    ///
+    /// \brief m_fail_on_link_down Stores if receipt-required messages fail when the link goes down.
+    ///
+    bool m_fail_on_link_down;
+    ///
+    /// \brief m_negotiation Stores if protocol features are negotiated with the peer.
+    ///
+    bool m_negotiation;
+
+    // VARIABLES
+    ///
+    /// \brief m_frames Frames and escapes the bytes written to and read from the host.
+    ///
+    framing m_frames;
+    ///
+    /// \brief m_allocator Stores the allocator that the engine rebinds for its queues, messages, and frame buffers.
+    ///
+    Allocator m_allocator;
+    ///
+    /// \brief m_sequence_counter Stores the current sequence number for assigning unique and monotonic sequence IDs to messages.
+    ///
+    uint32_t m_sequence_counter;
+    ///
+    /// \brief m_statistics Stores the engine's runtime counters.
+    ///
+    statistics_tracker m_statistics;
+    ///
+    /// \brief m_latency Stores the engine's latency histograms.
+    ///
+    latency_recorder m_latency;
+    ///
+    /// \brief m_in_flight Stores the number of frames handed to another thread that it has not finished with.
+    ///
+    std::atomic<uint32_t> m_in_flight;
+    ///
+    /// \brief m_delta_bases Stores the last acknowledged payload of each delta encoded ID.
+    ///
+    delta_cache m_delta_bases;
+    ///
+    /// \brief m_delta_history Stores recently received payloads of IDs that the peer delta encodes.
+    ///
+    delta_cache m_delta_history;
+    ///
+    /// \brief m_delta_peer Stores which message IDs the peer has sent delta encoded.
+    ///
+    std::bitset<65536> m_delta_peer;
+    ///
+    /// \brief m_pending_receipts Stores receipts waiting to be sent, oldest first.
+    ///
+    std::deque<pending_receipt, receipt_allocator> m_pending_receipts;
+    ///
+    /// \brief m_ack_pending Indicates that the oldest pending receipt is being held for the acknowledgement delay.
+    ///
+    bool m_ack_pending;
+    ///
+    /// \brief m_ack_due Stores when the held receipts must be sent on their own.
+    ///
+    timestamp m_ack_due;
+    ///
+    /// \brief m_heartbeat_due Stores when the next heartbeat is sent.
+    ///
+    timestamp m_heartbeat_due;
+    ///
+    /// \brief m_link_quality Stores the current estimate of the link.
+    ///
+    link_quality m_link_quality;
+    ///
+    /// \brief m_last_heard Stores when a valid frame was last heard from the peer.
+    ///
+    timestamp m_last_heard;
+    ///
+    /// \brief m_negotiated Indicates that the peer has answered the negotiation.
+    ///
+    bool m_negotiated;
+    ///
+    /// \brief m_peer_features Stores the features offered by the peer.
+    ///
+    uint8_t m_peer_features;
+    ///
+    /// \brief m_peer_max_data_length Stores the largest data length the peer accepts.
+    ///
+    uint16_t m_peer_max_data_length;
+    ///
+    /// \brief m_hellos_sent Stores the number of hellos sent in the current negotiation.
+    ///
+    uint8_t m_hellos_sent;
+    ///
+    /// \brief m_hello_timestamp Stores when the last hello was sent.
+    ///
+    timestamp m_hello_timestamp;
+    ///
+    /// \brief m_round_robin_channel Stores the channel that the round robin scheduler is currently serving.
+    ///
+    uint8_t m_round_robin_channel;
+
+    // QUEUES
+    ///
+    /// \brief m_tx_queue The internal transmit queue.
+    ///
+    slot_pool<outbound_message, Allocator> m_tx_queue;
+    ///
+    /// \brief m_rx_queue The internal receive queue.
+    ///
+    slot_pool<inbound_message, Allocator> m_rx_queue;
+    ///
+    /// \brief m_channels Stores the logical channels that have been configured or used, by channel.
+    ///
+    std::map<uint8_t, channel_state, std::less<uint8_t>, channel_allocator> m_channels;
+    ///
+    /// \brief m_tx_index Stores the transmit queue position of each outbound message, by sequence number.
+    ///
+    std::unordered_map<uint32_t, uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, index_allocator> m_tx_index;
+    ///
+    /// \brief m_decoding Stores the received frames being validated, in the order they arrived.
+    ///
+    std::deque<decode_job*, job_list_allocator> m_decoding;
+
+    // METHODS
+    ///
+    /// \brief host Gets the host, which the frame engine holds as its transport.
+    /// \return A reference to the host.
+    ///
+    Host& host()
+    {
+        return protocol_engine::m_frames.p_transport();
+    }
+    ///
+    /// \brief now Reads the engine's clock.
+    /// \return The current time.
+    ///
+    static timestamp now()
+    {
+        return Clock::now();
+    }
+    ///
+    /// \brief allocate Allocates a byte buffer.
+    /// \param length The length of the buffer.
+    /// \return The buffer.
+    ///
+    uint8_t* allocate(uint32_t length)
+    {
+        byte_allocator allocator(protocol_engine::m_allocator);
+        return std::allocator_traits<byte_allocator>::allocate(allocator, length);
+    }
+    ///
+    /// \brief deallocate Releases a byte buffer.
+    /// \param buffer The buffer, or nullptr.
+    /// \param length The length the buffer was allocated with.
+    ///
+    void deallocate(uint8_t* buffer, uint32_t length)
+    {
+        if(buffer)
+        {
+            byte_allocator allocator(protocol_engine::m_allocator);
+            std::allocator_traits<byte_allocator>::deallocate(allocator, buffer, length);
+        }
+    }
+    ///
+    /// \brief release Releases an expanded message byte array, whose length follows from its data length field.
+    /// \param bytes The message byte array, or nullptr.
+    ///
+    void release(uint8_t* bytes)
+    {
+        if(bytes)
+        {
+            protocol_engine::deallocate(bytes, 5u + load_big_endian<uint16_t>(&bytes[3]));
+        }
+    }
+    ///
+    /// \brief create Allocates and constructs an object.
+    /// \param arguments The arguments of the object's constructor.
+    /// \return The object.
+    ///
+    template <typename T, typename... Arguments>
+    T* create(Arguments&&... arguments)
+    {
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> object_allocator;
+        object_allocator allocator(protocol_engine::m_allocator);
+        T* object = std::allocator_traits<object_allocator>::allocate(allocator, 1);
+        std::allocator_traits<object_allocator>::construct(allocator, object, std::forward<Arguments>(arguments)...);
+        return object;
+    }
+    ///
+    /// \brief destroy Destroys and releases an object made by create().
+    /// \param object The object, or nullptr.
+    ///
+    template <typename T>
+    void destroy(T* object)
+    {
+        if(object)
+        {
+            typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> object_allocator;
+            object_allocator allocator(protocol_engine::m_allocator);
+            std::allocator_traits<object_allocator>::destroy(allocator, object);
+            std::allocator_traits<object_allocator>::deallocate(allocator, object, 1);
+        }
+    }
+    ///
+    /// \brief elapsed_us Gets the time elapsed since a timestamp.
+    /// \param since The timestamp.
+    /// \return The elapsed time in microseconds.
+    ///
+    static uint64_t elapsed_us(timestamp since)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(protocol_engine::now() - since).count());
+    }
+    ///
+    /// \brief decoded Tells the host that a frame was validated on its thread, then lets go of the frame.
+    ///
+    void decoded()
+    {
+        protocol_engine::host().decoded();
+        // The engine may be destroyed as soon as nothing is in flight, so this must come last.
+        protocol_engine::m_in_flight.fetch_sub(1, std::memory_order_release);
+    }
+    ///
+    /// \brief prepare Fills in a received frame's job before it is validated.
+    /// \param job The job.
+    /// \param packet The unescaped frame, which the job takes over.
+    /// \param frame The frame's layout.
+    ///
+    void prepare(decode_job& job, uint8_t* packet, const typename framing::frame& frame)
+    {
+        job.packet = packet;
+        job.packet_length = frame.packet_length;
+        job.header_length = frame.header_length;
+        job.data_length = frame.data_length;
+        job.extension_length = frame.extension_length;
+        job.arrival = frame.arrival;
+        job.done.store(false, std::memory_order_relaxed);
+    }
+    ///
+    /// \brief decode Validates a received frame's checksum and expands any compressed data.
+    /// \param job The frame.  Only this method writes to it until it is marked as done.
+    ///
+    void decode(decode_job* job)
+    {
+        // Validate the checksum.
+        job->checksum_ok = job->packet[job->packet_length - 1] == framing::checksum(job->packet, job->packet_length - 1);
+        // Expand compressed data before acknowledging it, so that a payload that fails to decompress is retransmitted.
+        job->expanded = nullptr;
+        job->expanded_ok = true;
+        if(job->checksum_ok && (job->packet[5] & static_cast<uint8_t>(protocol_engine::frame_flag::COMPRESSED)))
+        {
+            job->expanded = protocol_engine::decompress(job->packet, job->header_length);
+            job->expanded_ok = job->expanded != nullptr;
+        }
+        // Publish the results to the engine's thread.
+        job->done.store(true, std::memory_order_release);
+    }
+    ///
+    /// \brief finish Handles a validated frame.
+    /// \param job The frame.  Its buffers are taken over, and the job itself is left to the caller.
+    ///
+    void finish(const decode_job& job)
+    {
+        uint8_t* packet = job.packet;
+        uint32_t packet_length = job.packet_length;
+        uint32_t header_length = job.header_length;
+        uint16_t data_length = job.data_length;
+        uint16_t extension_length = job.extension_length;
+        timestamp arrival = job.arrival;
+        uint8_t* expanded = job.expanded;
+        bool checksum_ok = job.checksum_ok;
+        bool expanded_ok = job.expanded_ok;
+
+        if(!checksum_ok)
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_CHECKSUM_FAILURES);
+        }
+        protocol_engine::observe_frame(checksum_ok);
+        if(!expanded_ok)
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_DECOMPRESSION_FAILURES);
+            checksum_ok = false;
+        }
+        // Reconstruct delta encoded data from the cached base.
+        uint16_t id = load_big_endian<uint16_t>(&packet[header_length - 5]);
+        if(checksum_ok && (packet[5] & static_cast<uint8_t>(protocol_engine::frame_flag::DELTA)))
+        {
+            // Start caching bases for this ID.
+            protocol_engine::m_delta_peer.set(id);
+            uint8_t* reconstructed = protocol_engine::decode_delta(expanded ? expanded : &packet[header_length - 5]);
+            protocol_engine::release(expanded);
+            expanded = reconstructed;
+            if(!expanded)
+            {
+                protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_DELTA_MISSES);
+                checksum_ok = false;
+            }
+        }
+        // Extract sequence number from the packet.
+        uint32_t sequence_number = load_big_endian<uint32_t>(&packet[1]);
+
+        // Apply any receipts and other extensions carried by the frame.
+        protocol_engine::frame_extensions extensions;
+        if(checksum_ok && (packet[5] & static_cast<uint8_t>(protocol_engine::frame_flag::EXTENDED)))
+        {
+            protocol_engine::read_extensions(&packet[header_length + data_length + 2], extension_length, extensions);
+        }
+
+        // Handle receipts
+        switch(static_cast<protocol_engine::receipt_type>(packet[5] & protocol_engine::m_receipt_mask))
+        {
+        case protocol_engine::receipt_type::NOT_REQUIRED:
+        {
+            // Do nothing
+            break;
+        }
+        case protocol_engine::receipt_type::REQUIRED:
+        {
+            // Cache the payload as a delta base if the sender marked it as one, or already delta encodes its ID.
+            if(checksum_ok && (extensions.delta_base || protocol_engine::m_delta_peer.test(id)))
+            {
+                const uint8_t* bytes = expanded ? expanded : &packet[header_length - 5];
+                protocol_engine::m_delta_history.store(id, sequence_number, &bytes[5], load_big_endian<uint16_t>(&bytes[3]));
+            }
+            // A corrupt frame is answered right away.  A valid frame is only acknowledged once it has been stored.
+            if(!checksum_ok)
+            {
+                protocol_engine::acknowledge(sequence_number, id, packet[header_length - 3], protocol_engine::receipt_type::CHECKSUM_MISMATCH);
+            }
+            break;
+        }
+        case protocol_engine::receipt_type::RECEIVED:
+        case protocol_engine::receipt_type::CHECKSUM_MISMATCH:
+        {
+            // Apply the receipt to the associated message in the TXQ.
+            if(checksum_ok)
+            {
+                protocol_engine::receipt(sequence_number, static_cast<protocol_engine::receipt_type>(packet[5] & protocol_engine::m_receipt_mask));
+            }
+            break;
+        }
+        case protocol_engine::receipt_type::CONTROL:
+        {
+            // Control frames are handled once their extensions have been applied.
+            break;
+        }
+        }
+
+        // Receipt and control frames are handled entirely here, and never become messages.
+        uint8_t frame_type = packet[5] & protocol_engine::m_receipt_mask;
+        if(frame_type != static_cast<uint8_t>(protocol_engine::receipt_type::NOT_REQUIRED) && frame_type != static_cast<uint8_t>(protocol_engine::receipt_type::REQUIRED))
+        {
+            if(checksum_ok && frame_type == static_cast<uint8_t>(protocol_engine::receipt_type::CONTROL))
+            {
+                protocol_engine::control(static_cast<protocol_engine::control_type>(id), &packet[header_length], data_length);
+            }
+            protocol_engine::deallocate(packet, packet_length);
+            protocol_engine::release(expanded);
+            return;
+        }
+
+        // Offer requests and responses to the host, which routes them to their calls and handlers.
+        bool receipt_required = (packet[5] & protocol_engine::m_receipt_mask) == static_cast<uint8_t>(protocol_engine::receipt_type::REQUIRED);
+        bool routed = false;
+        if(checksum_ok && extensions.correlated)
+        {
+            const uint8_t* bytes = expanded ? expanded : &packet[header_length - 5];
+            routed = protocol_engine::host().correlated(extensions.kind == protocol_engine::call_kind::RESPONSE, extensions.correlation, bytes, extensions.channel, receipt_required, arrival);
+        }
+
+        // Lastly, put packet into inbound message in the rx_queue.
+        uint8_t priority = packet[header_length - 3];
+        bool stored = routed;
+        if(checksum_ok && !routed && protocol_engine::m_receive_filter && !protocol_engine::m_subscribed.test(id))
+        {
+            // Nobody wants the message, so it is discarded as if it had been received and taken.
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_FILTERED);
+            stored = true;
+        }
+        else if(checksum_ok && !routed)
+        {
+            // Keep the message serialized in the buffer it was parsed from, and only create it once it is taken.
+            uint8_t* buffer = expanded ? expanded : packet;
+            uint32_t offset = expanded ? 0 : header_length - 5;
+            uint32_t message_length = load_big_endian<uint16_t>(&buffer[offset + 3]) + 5u;
+            // Make room in the channel's RXQ according to the overflow policy.
+            if(protocol_engine::make_room_rx(extensions.channel, message_length, priority))
+            {
+                // Add new inbound to the rx_queue, which takes over the buffer.
+                uint32_t buffer_length = expanded ? message_length : packet_length;
+                protocol_engine::m_rx_queue.insert(protocol_engine::create<inbound_message>(buffer, buffer_length, offset, extensions.channel, sequence_number, arrival, protocol_engine::now(), protocol_engine::m_allocator));
+                if(expanded)
+                {
+                    expanded = nullptr;
+                }
+                else
+                {
+                    packet = nullptr;
+                }
+                protocol_engine::channel_state& state = protocol_engine::channel(extensions.channel);
+                state.rx_size++;
+                state.rx_bytes += message_length;
+                // Update the queue high-water mark.
+                protocol_engine::m_statistics.high_water(statistics_tracker::gauge::RX_QUEUE, protocol_engine::m_rx_queue.p_size());
+                stored = true;
+            }
+            else
+            {
+                // Record that the message was dropped for lack of space.
+                protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_DROPPED);
+            }
+        }
+
+        // A receipt-required frame shows that the peer is not stalled on the channel, or gets a receipt carrying the latest credits.
+        if(checksum_ok && receipt_required)
+        {
+            protocol_engine::channel(extensions.channel).credits_unconfirmed = false;
+        }
+
+        // Queue a receipt for a valid frame to be sent on its own or carried by the next outbound frame.
+        // A frame dropped for lack of space is not acknowledged, so the sender retransmits it.
+        if(checksum_ok && stored && receipt_required)
+        {
+            protocol_engine::acknowledge(sequence_number, id, priority, protocol_engine::receipt_type::RECEIVED);
+        }
+
+        // Delete the packet.
+        protocol_engine::deallocate(packet, packet_length);
+        protocol_engine::release(expanded);
+    }
+    ///
+    /// \brief tx Serializes, encodes, and transmits an outbound message.
+    /// \param message The message to transmit.
+    ///
+    void tx(outbound_message* message)
+    {
+        // Serialize the packet without escapes.
+        // First, get total packet length = message length + 7 (1 header, 4 sequence, 1 receipt, 1 checksum) + optional header checksum.
+        uint32_t header_length = protocol_engine::header_length();
+        uint32_t packet_size = message->p_message()->p_message_length() + header_length - 4;
+        // Only payloads the receiver was told to cache may later serve as delta bases.
+        message->p_delta_base(protocol_engine::m_delta.test(message->p_message()->p_id()) && message->p_receipt_required() && protocol_engine::uses(feature::DELTA) && protocol_engine::uses(feature::EXTENSIONS));
+        // Gather any pending receipts and other extensions to carry in the frame.
+        byte_vector extensions(protocol_engine::m_allocator);
+        protocol_engine::write_extensions(extensions, message);
+        if(!extensions.empty())
+        {
+            packet_size += 2 + static_cast<uint32_t>(extensions.size());
+        }
+        // Create packet.
+        uint8_t* packet = protocol_engine::allocate(packet_size);
+        // Write the header, sequence, and receipt.
+        packet[0] = protocol_engine::m_frames.p_header_byte();
+        store_big_endian(&packet[1], message->p_sequence_number());
+        packet[5] = message->p_receipt_required();
+        // Write the message bytes.
+        message->p_message()->serialize(&packet[header_length - 5]);
+        // Delta encode, then compress, the data if enabled for this ID and worthwhile.
+        uint16_t data_length = message->p_message()->p_data_length();
+        uint16_t encoded_length = data_length;
+        if(protocol_engine::m_delta.test(message->p_message()->p_id()) && message->p_receipt_required() && protocol_engine::uses(feature::DELTA))
+        {
+            encoded_length = protocol_engine::encode_delta(packet, header_length);
+        }
+        if(protocol_engine::m_compression.test(message->p_message()->p_id()) && encoded_length >= protocol_engine::m_compression_threshold && protocol_engine::uses(feature::COMPRESSION))
+        {
+            encoded_length = protocol_engine::compress(packet, header_length);
+        }
+        uint32_t allocated_size = packet_size;
+        packet_size -= data_length - encoded_length;
+        // Append the extension block after the data.
+        if(!extensions.empty())
+        {
+            protocol_engine::append_extensions(packet, header_length + encoded_length, extensions);
+        }
+        // Calculate and add the header checksum and CRC.
+        protocol_engine::seal_header(packet);
+        packet[packet_size-1] = framing::checksum(packet, packet_size - 1);
+
+        // Record queueing latency on first transmission, or count retransmissions.
+        if(message->p_n_transmissions() == 0)
+        {
+            protocol_engine::m_latency.record(latency_metric::QUEUEING, message->p_message()->p_priority(), message->p_message()->p_id(), protocol_engine::elapsed_us(message->p_enqueue_timestamp()));
+        }
+        else
+        {
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_RETRANSMISSIONS);
+        }
+
+        // Write to the host.
+        protocol_engine::tx(packet, packet_size);
+
+        // Mark that the message has been sent.
+        message->mark_transmitted(protocol_engine::now());
+
+        // Delete the packet.
+        protocol_engine::deallocate(packet, allocated_size);
+    }
+    ///
+    /// \brief tx Escapes and transmits a packet.
+    /// \param buffer The packet.
+    /// \param length The length of the packet.
+    ///
+    void tx(uint8_t* buffer, uint32_t length)
+    {
+        // Escape the packet and write it to the host.
+        uint32_t n_escapes = protocol_engine::m_frames.transmit(buffer, length);
+
+        // Update transmit counters.
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_FRAMES);
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_BYTES, length + n_escapes);
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_ESCAPED_BYTES, n_escapes);
+    }
+    ///
+    /// \brief header_length Gets the length of transmitted headers in the format currently in use.
+    /// \return The header length.
+    ///
+    uint32_t header_length() const
+    {
+        return protocol_engine::uses(feature::HEADER_CHECKSUM) ? 12 : 11;
+    }
+    ///
+    /// \brief local_features Gets the features offered to the peer.
+    /// \return The features, as a mask of feature flags.
+    ///
+    uint8_t local_features() const
+    {
+        uint8_t features = static_cast<uint8_t>(feature::COMPRESSION) | static_cast<uint8_t>(feature::DELTA) | static_cast<uint8_t>(feature::EXTENSIONS);
+        if(protocol_engine::m_header_checksum)
+        {
+            features |= static_cast<uint8_t>(feature::HEADER_CHECKSUM);
+        }
+        return features;
+    }
+    ///
+    /// \brief negotiate Starts a new negotiation with the peer.
+    ///
+    void negotiate()
+    {
+        // Return to the legacy format until the peer answers.
+        protocol_engine::m_negotiated = false;
+        protocol_engine::m_hellos_sent = 0;
+        protocol_engine::send_hello(false);
+    }
+    ///
+    /// \brief send_hello Sends a hello offering the local features.
+    /// \param reply Indicates that the hello answers the peer's hello.
+    ///
+    void send_hello(bool reply)
+    {
+        // Write version(1), reply flag(1), features(1), and max data length(2).
+        uint8_t hello[5];
+        hello[0] = protocol_engine::m_protocol_version;
+        hello[1] = reply ? 1 : 0;
+        hello[2] = protocol_engine::local_features();
+        store_big_endian(&hello[3], protocol_engine::m_max_data_length);
+        protocol_engine::send_control(protocol_engine::control_type::HELLO, hello, 5);
+
+        // Track unanswered hellos for retries.
+        if(!reply)
+        {
+            protocol_engine::m_hellos_sent++;
+            protocol_engine::m_hello_timestamp = protocol_engine::now();
+        }
+    }
+    ///
+    /// \brief heartbeat Checks that the peer has been heard recently, and pings it.
+    ///
+    void heartbeat()
+    {
+        // Declare the link down once the peer has been silent for too long.
+        if(protocol_engine::now() - protocol_engine::m_last_heard > std::chrono::milliseconds(protocol_engine::m_heartbeat_misses * protocol_engine::m_heartbeat_interval))
+        {
+            protocol_engine::set_link(false);
+        }
+
+        // Ping the peer with the current time.
+        uint8_t ping[9];
+        ping[0] = static_cast<uint8_t>(protocol_engine::heartbeat_kind::PING);
+        store_big_endian(&ping[1], static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(protocol_engine::now().time_since_epoch()).count()));
+        protocol_engine::send_control(protocol_engine::control_type::HEARTBEAT, ping, 9);
+    }
+    ///
+    /// \brief acknowledge Queues a receipt, and sends it unless it can be held for an outbound frame to carry.
+    /// \param sequence_number The sequence number of the frame being acknowledged.
+    /// \param id The message ID of the frame being acknowledged.
+    /// \param priority The priority of the frame being acknowledged.
+    /// \param type The receipt type.
+    ///
+    void acknowledge(uint32_t sequence_number, uint16_t id, uint8_t priority, receipt_type type)
+    {
+        // Queue the receipt.
+        protocol_engine::pending_receipt receipt;
+        receipt.sequence_number = sequence_number;
+        receipt.id = id;
+        receipt.priority = priority;
+        receipt.type = type;
+        protocol_engine::m_pending_receipts.push_back(receipt);
+
+        // Without an acknowledgement delay, or a peer that reads piggybacked receipts, receipts are sent immediately.
+        if(protocol_engine::m_ack_delay == 0 || !protocol_engine::uses(feature::EXTENSIONS))
+        {
+            protocol_engine::flush_receipts();
+        }
+        // Otherwise, start the delay for the oldest pending receipt.
+        else if(!protocol_engine::m_ack_pending)
+        {
+            protocol_engine::m_ack_pending = true;
+            protocol_engine::m_ack_due = protocol_engine::now() + std::chrono::milliseconds(protocol_engine::m_ack_delay);
+            protocol_engine::host().wake(protocol_engine::m_ack_delay);
+        }
+    }
+    ///
+    /// \brief flush_receipts Sends every pending receipt.
+    ///
+    void flush_receipts()
+    {
+        protocol_engine::m_ack_pending = false;
+
+        while(!protocol_engine::m_pending_receipts.empty())
+        {
+            // Send a receipt frame for the oldest pending receipt.  Further pending receipts ride in its extension block.
+            protocol_engine::pending_receipt first = protocol_engine::m_pending_receipts.front();
+            protocol_engine::m_pending_receipts.pop_front();
+            protocol_engine::send_frame(first.sequence_number, first.type, first.id, first.priority, nullptr, 0);
+        }
+    }
+    ///
+    /// \brief send_frame Sends an untracked frame, such as a receipt or a control frame.
+    /// \param sequence_number The sequence number field.
+    /// \param type The receipt field.
+    /// \param id The ID field.
+    /// \param priority The priority field.
+    /// \param data The data, or nullptr.
+    /// \param length The length of the data.
+    ///
+    void send_frame(uint32_t sequence_number, receipt_type type, uint16_t id, uint8_t priority, const uint8_t* data, uint16_t length)
+    {
+        // Draft the frame outside of the typical outbound/tx_queue, since it does not need to be tracked.
+        uint32_t header_length = protocol_engine::header_length();
+
+        // Carry any pending receipts and credits in the frame's extension block.
+        byte_vector extensions(protocol_engine::m_allocator);
+        protocol_engine::write_extensions(extensions, nullptr);
+        uint32_t packet_size = header_length + length + 1 + (extensions.empty() ? 0 : 2 + static_cast<uint32_t>(extensions.size()));
+        uint8_t* frame = protocol_engine::allocate(packet_size);
+
+        // Write header(1), sequence(4), receipt(1), header checksum(0-1), id(2), priority(1), data length(2), and data.
+        frame[0] = protocol_engine::m_frames.p_header_byte();
+        store_big_endian(&frame[1], sequence_number);
+        frame[5] = static_cast<uint8_t>(type);
+        store_big_endian(&frame[header_length - 5], id);
+        frame[header_length - 3] = priority;
+        store_big_endian(&frame[header_length - 2], length);
+        if(length > 0)
+        {
+            std::memcpy(&frame[header_length], data, length);
+        }
+        if(!extensions.empty())
+        {
+            protocol_engine::append_extensions(frame, header_length + length, extensions);
+        }
+        // Set header checksum and checksum.
+        protocol_engine::seal_header(frame);
+        frame[packet_size - 1] = framing::checksum(frame, packet_size - 1);
+        // Write frame.
+        protocol_engine::tx(frame, packet_size);
+        protocol_engine::deallocate(frame, packet_size);
+    }
+    ///
+    /// \brief send_control Sends a control frame.
+    /// \param type The control type.
+    /// \param data The control data, or nullptr.
+    /// \param length The length of the control data.
+    ///
+    void send_control(control_type type, const uint8_t* data, uint16_t length)
+    {
+        // Control frames are never acknowledged, so they carry no sequence number and the highest priority.
+        protocol_engine::send_frame(0, protocol_engine::receipt_type::CONTROL, static_cast<uint16_t>(type), 0xFF, data, length);
+    }
+    ///
+    /// \brief control Handles a received control frame.
+    /// \param type The control type.
+    /// \param data The control data.
+    /// \param length The length of the control data.
+    ///
+    void control(control_type type, const uint8_t* data, uint16_t length)
+    {
+        switch(type)
+        {
+        case protocol_engine::control_type::CREDITS:
+        {
+            // The credits were already applied from the frame's extension block.
+            break;
+        }
+        case protocol_engine::control_type::HEARTBEAT:
+        {
+            if(length < 9)
+            {
+                break;
+            }
+            if(data[0] == static_cast<uint8_t>(protocol_engine::heartbeat_kind::PING))
+            {
+                // Answer the ping at once, echoing its timestamp.
+                uint8_t pong[9];
+                pong[0] = static_cast<uint8_t>(protocol_engine::heartbeat_kind::PONG);
+                std::memcpy(&pong[1], &data[1], 8);
+                protocol_engine::send_control(protocol_engine::control_type::HEARTBEAT, pong, 9);
+            }
+            else
+            {
+                // Measure the round trip from the echoed timestamp, and smooth it over roughly the last 8 answers.
+                uint64_t sent = load_big_endian<uint64_t>(&data[1]);
+                uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(protocol_engine::now().time_since_epoch()).count());
+                double sample = static_cast<double>(now - sent) / 1000.0;
+                if(protocol_engine::m_link_quality.round_trip_time == 0)
+                {
+                    protocol_engine::m_link_quality.round_trip_time = sample;
+                }
+                else
+                {
+                    protocol_engine::m_link_quality.round_trip_time += (sample - protocol_engine::m_link_quality.round_trip_time) / 8.0;
+                }
+                protocol_engine::host().link_quality_updated(protocol_engine::m_link_quality);
+            }
+            break;
+        }
+        case protocol_engine::control_type::HELLO:
+        {
+            if(length < 5 || data[0] < 1)
+            {
+                break;
+            }
+            // Learn the peer's features and limits.
+            protocol_engine::m_peer_features = data[2];
+            protocol_engine::m_peer_max_data_length = load_big_endian<uint16_t>(&data[3]);
+            // Answer a new hello before switching formats, so that the peer can still read the answer.
+            if(!(data[1] & 1))
+            {
+                protocol_engine::send_hello(true);
+            }
+            // Use the negotiated features from now on.
+            if(protocol_engine::m_negotiation)
+            {
+                protocol_engine::m_negotiated = true;
+            }
+            break;
+        }
+        }
+    }
+    ///
+    /// \brief receipt Applies a receipt to the transmit queue.
+    /// \param sequence_number The sequence number of the acknowledged message.
+    /// \param type The receipt type.
+    ///
+    void receipt(uint32_t sequence_number, receipt_type type)
+    {
+        // Find the associated message based on sequence number.
+        auto entry = protocol_engine::m_tx_index.find(sequence_number);
+        if(entry == protocol_engine::m_tx_index.end())
+        {
+            return;
+        }
+        outbound_message* current = protocol_engine::m_tx_queue.at(entry->second);
+
+        if(type == protocol_engine::receipt_type::RECEIVED)
+        {
+            // Keep the payload as the delta base for its ID, if the receiver was told to cache it.
+            if(current->p_delta_base())
+            {
+                protocol_engine::m_delta_bases.store(current->p_message()->p_id(), sequence_number, current->p_message()->p_data(), current->p_message()->p_data_length());
+            }
+            // Record the round trip time from the last transmission.
+            protocol_engine::m_latency.record(latency_metric::RECEIPT, current->p_message()->p_priority(), current->p_message()->p_id(), protocol_engine::elapsed_us(current->p_transmit_timestamp()));
+            // Remove it from the queue with its final status.
+            protocol_engine::retire(current, message_status::RECEIVED);
+        }
+        else
+        {
+            // The receiver may have lacked the delta base, so resend in full.
+            protocol_engine::m_delta_bases.erase(current->p_message()->p_id());
+            // Resend immediately, if the message can be resent.
+            protocol_engine::unschedule(current);
+            protocol_engine::transmit(current);
+        }
+    }
+    ///
+    /// \brief write_extensions Gathers the extension entries to carry in an outbound frame.
+    /// \param block The extension block to append to.
+    /// \param message The outbound message of the frame, or nullptr for an untracked frame.
+    ///
+    void write_extensions(byte_vector& block, const outbound_message* message)
+    {
+        // Carry as many pending receipts as fit in one entry.
+        if(!protocol_engine::m_pending_receipts.empty())
+        {
+            uint32_t n_receipts = std::min<uint32_t>(static_cast<uint32_t>(protocol_engine::m_pending_receipts.size()), 255 / 5);
+            block.push_back(static_cast<uint8_t>(protocol_engine::extension_type::RECEIPTS));
+            block.push_back(static_cast<uint8_t>(n_receipts * 5));
+            for(uint32_t i = 0; i < n_receipts; i++)
+            {
+                protocol_engine::pending_receipt& receipt = protocol_engine::m_pending_receipts.front();
+                for(int8_t shift = 24; shift >= 0; shift -= 8)
+                {
+                    block.push_back(static_cast<uint8_t>(receipt.sequence_number >> shift));
+                }
+                block.push_back(static_cast<uint8_t>(receipt.type));
+                protocol_engine::m_pending_receipts.pop_front();
+            }
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_PIGGYBACKED_RECEIPTS, n_receipts);
+            if(protocol_engine::m_pending_receipts.empty())
+            {
+                protocol_engine::m_ack_pending = false;
+            }
+            // Receipts free the sender's credits, so refresh them alongside.
+            if(protocol_engine::m_flow_control && protocol_engine::uses(feature::EXTENSIONS))
+            {
+                protocol_engine::write_credits(block);
+            }
+        }
+        else if(protocol_engine::m_flow_control && protocol_engine::uses(feature::EXTENSIONS) && !message)
+        {
+            // A receipt frame always carries credits.
+            protocol_engine::write_credits(block);
+        }
+
+        // Add the message's own entries, unless the peer cannot read them.
+        // A message admitted before the peer turned out not to offer extension blocks is sent on the default channel.
+        if(message && protocol_engine::uses(feature::EXTENSIONS))
+        {
+            block.insert(block.end(), message->p_extensions().begin(), message->p_extensions().end());
+        }
+        // Mark payloads of delta encoded IDs as bases, so the receiver caches them before the first delta arrives.
+        if(message && message->p_delta_base())
+        {
+            block.push_back(static_cast<uint8_t>(protocol_engine::extension_type::DELTA_BASE));
+            block.push_back(0);
+        }
+    }
+    ///
+    /// \brief append_extensions Appends an extension block to a packet, and flags the packet as extended.
+    /// \param packet The packet.
+    /// \param offset The position just past the packet's data.
+    /// \param block The extension block.
+    ///
+    void append_extensions(uint8_t* packet, uint32_t offset, const byte_vector& block)
+    {
+        // Write the block length followed by the block, and flag the frame as extended.
+        store_big_endian(&packet[offset], static_cast<uint16_t>(block.size()));
+        std::memcpy(&packet[offset + 2], block.data(), block.size());
+        packet[5] |= static_cast<uint8_t>(protocol_engine::frame_flag::EXTENDED);
+    }
+    ///
+    /// \brief read_extensions Applies a received extension block.
+    /// \param block The extension block.
+    /// \param length The length of the extension block.
+    /// \param extensions Returns the entries that concern the frame itself.
+    ///
+    void read_extensions(const uint8_t* block, uint32_t length, frame_extensions& extensions)
+    {
+        // Read each type-length-value entry, skipping unknown types.
+        uint32_t position = 0;
+        while(length - position >= 2)
+        {
+            uint8_t type = block[position];
+            uint8_t entry_length = block[position + 1];
+            position += 2;
+            if(length - position < entry_length)
+            {
+                return;
+            }
+            const uint8_t* value = &block[position];
+            position += entry_length;
+
+            switch(static_cast<protocol_engine::extension_type>(type))
+            {
+            case protocol_engine::extension_type::RECEIPTS:
+            {
+                // Apply each receipt as if it arrived in its own frame.
+                for(uint32_t i = 0; i + 5 <= entry_length; i += 5)
+                {
+                    uint32_t sequence_number = load_big_endian<uint32_t>(&value[i]);
+                    protocol_engine::receipt_type receipt_type = static_cast<protocol_engine::receipt_type>(value[i + 4] & protocol_engine::m_receipt_mask);
+                    if(receipt_type == protocol_engine::receipt_type::RECEIVED || receipt_type == protocol_engine::receipt_type::CHECKSUM_MISMATCH)
+                    {
+                        protocol_engine::receipt(sequence_number, receipt_type);
+                    }
+                }
+                break;
+            }
+            case protocol_engine::extension_type::CORRELATION:
+            {
+                // Note the call this frame belongs to.
+                if(entry_length >= 5)
+                {
+                    extensions.correlated = true;
+                    extensions.kind = static_cast<protocol_engine::call_kind>(value[0]);
+                    extensions.correlation = load_big_endian<uint32_t>(&value[1]);
+                }
+                break;
+            }
+            case protocol_engine::extension_type::CREDITS:
+            {
+                // Replace the peer's credits for the default channel with the latest advertisement.
+                if(entry_length >= 6)
+                {
+                    protocol_engine::channel_state& state = protocol_engine::channel(0);
+                    state.peer_messages = load_big_endian<uint16_t>(&value[0]);
+                    state.peer_bytes = load_big_endian<uint32_t>(&value[2]);
+                }
+                break;
+            }
+            case protocol_engine::extension_type::CHANNEL:
+            {
+                // Note the channel of the frame's message.
+                if(entry_length >= 1)
+                {
+                    extensions.channel = value[0];
+                }
+                break;
+            }
+            case protocol_engine::extension_type::DELTA_BASE:
+            {
+                // Note that the payload should be cached as a delta base.
+                extensions.delta_base = true;
+                break;
+            }
+            case protocol_engine::extension_type::CHANNEL_CREDITS:
+            {
+                // Replace the peer's credits for each listed channel.
+                for(uint32_t i = 0; i + 7 <= entry_length; i += 7)
+                {
+                    protocol_engine::channel_state& state = protocol_engine::channel(value[i]);
+                    state.peer_messages = load_big_endian<uint16_t>(&value[i + 1]);
+                    state.peer_bytes = load_big_endian<uint32_t>(&value[i + 3]);
+                }
+                break;
+            }
+            }
+        }
+    }
+    ///
+    /// \brief write_credits Appends the free capacity of every channel's receive queue to an extension block.
+    /// \param block The extension block.
+    ///
+    void write_credits(byte_vector& block)
+    {
+        // The default channel uses the entry understood by communicators without channels.
+        // Other channels are listed in as many channel credit entries as needed.
+        uint32_t n_listed = 0;
+        uint32_t entry_length = 0;
+        timestamp current = protocol_engine::now();
+        for(auto state = protocol_engine::m_channels.begin(); state != protocol_engine::m_channels.end(); ++state)
+        {
+            uint16_t messages;
+            uint32_t bytes;
+            protocol_engine::free_capacity(state->second, messages, bytes);
+
+            // Start the channel's part of the entry.
+            if(state->first == 0)
+            {
+                block.push_back(static_cast<uint8_t>(protocol_engine::extension_type::CREDITS));
+                block.push_back(6);
+            }
+            else
+            {
+                if(n_listed % (255 / 7) == 0)
+                {
+                    block.push_back(static_cast<uint8_t>(protocol_engine::extension_type::CHANNEL_CREDITS));
+                    entry_length = static_cast<uint32_t>(block.size());
+                    block.push_back(0);
+                }
+                block[entry_length] += 7;
+                block.push_back(state->first);
+                n_listed++;
+            }
+            block.push_back(static_cast<uint8_t>(messages >> 8));
+            block.push_back(static_cast<uint8_t>(messages));
+            for(int8_t shift = 24; shift >= 0; shift -= 8)
+            {
+                block.push_back(static_cast<uint8_t>(bytes >> shift));
+            }
+
+            // Raising credits that were advertised as full must be confirmed, since a stalled peer sends nothing to acknowledge.
+            if(protocol_engine::credits_full(messages, bytes))
+            {
+                state->second.credits_unconfirmed = false;
+            }
+            else if(protocol_engine::credits_full(state->second.advertised_messages, state->second.advertised_bytes))
+            {
+                state->second.credits_unconfirmed = true;
+            }
+            state->second.credits_timestamp = current;
+
+            // Note what the peer now believes.
+            state->second.advertised_messages = messages;
+            state->second.advertised_bytes = bytes;
+        }
+    }
+    ///
+    /// \brief update_credits Sends a credit update if the peer may be stalled on credits that have since been freed.
+    ///
+    void update_credits()
+    {
+        if(!protocol_engine::m_flow_control || !protocol_engine::uses(feature::EXTENSIONS))
+        {
+            return;
+        }
+
+        // While the peer believes there is room for another message, its receipts keep its credits current.
+        // Only a peer told that a channel's queue is full may be stalled waiting for an update.
+        bool stale = false;
+        timestamp current = protocol_engine::now();
+        for(auto state = protocol_engine::m_channels.begin(); state != protocol_engine::m_channels.end(); ++state)
+        {
+            if(!protocol_engine::credits_full(state->second.advertised_messages, state->second.advertised_bytes))
+            {
+                // The update that raised the credits may have been lost, so repeat it every receipt timeout until the peer sends again.
+                uint32_t receipt_timeout = state->second.config.receipt_timeout ? state->second.config.receipt_timeout : protocol_engine::m_receipt_timeout;
+                if(state->second.credits_unconfirmed && current - state->second.credits_timestamp >= std::chrono::milliseconds(receipt_timeout))
+                {
+                    stale = true;
+                }
+                continue;
+            }
+            uint16_t messages;
+            uint32_t bytes;
+            protocol_engine::free_capacity(state->second, messages, bytes);
+            if(messages > state->second.advertised_messages || bytes > state->second.advertised_bytes)
+            {
+                stale = true;
+            }
+        }
+        if(!stale)
+        {
+            return;
+        }
+
+        // Send the new credits in a control frame.
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_CREDIT_UPDATES);
+        protocol_engine::send_control(protocol_engine::control_type::CREDITS, nullptr, 0);
+    }
+    ///
+    /// \brief credits_full Checks if advertised credits leave the peer unable to send another message.
+    /// \param messages The free messages advertised.
+    /// \param bytes The free bytes advertised.
+    /// \return TRUE if the peer is stalled by the credits, otherwise FALSE.
+    ///
+    bool credits_full(uint16_t messages, uint32_t bytes) const
+    {
+        // Credits that cannot fit one more message of the largest size leave the peer stalled.
+        return messages == 0 || bytes < static_cast<uint32_t>(protocol_engine::m_max_data_length) + 5;
+    }
+    ///
+    /// \brief has_credit Checks if the peer has advertised room for a message.
+    /// \param channel The channel of the message.
+    /// \param message The message.
+    /// \return TRUE if the message may be sent, otherwise FALSE.
+    ///
+    bool has_credit(const channel_state& channel, const outbound_message* message) const
+    {
+        // Only the first transmission of a receipt-required message consumes credit.
+        if(!message->p_receipt_required() || message->p_n_transmissions() > 0)
+        {
+            return true;
+        }
+        return channel.tx_unacknowledged < channel.peer_messages &&
+               channel.tx_unacknowledged_bytes + message->p_message()->p_message_length() <= channel.peer_bytes;
+    }
+    ///
+    /// \brief can_transmit Checks if the link, the channel's window, and the peer's credits allow a message to be sent.
+    /// \param channel The channel of the message.
+    /// \param message The message.
+    /// \return TRUE if the message may be sent, otherwise FALSE.
+    ///
+    bool can_transmit(const channel_state& channel, const outbound_message* message) const
+    {
+        // Park receipt-required messages while the link is down, rather than retransmitting into it.
+        if(message->p_receipt_required() && !protocol_engine::m_link_quality.up)
+        {
+            return false;
+        }
+        // Hold back new receipt-required messages while the channel's window is full.
+        if(message->p_receipt_required() && message->p_n_transmissions() == 0 && channel.config.window > 0 && channel.tx_unacknowledged >= channel.config.window)
+        {
+            return false;
+        }
+        return protocol_engine::has_credit(channel, message);
+    }
+    ///
+    /// \brief observe_frame Updates the link quality with a received frame.
+    /// \param valid Indicates that the frame was intact.
+    ///
+    void observe_frame(bool valid)
+    {
+        // Smooth the frame error rate over roughly the last 16 frames.
+        protocol_engine::m_link_quality.frame_error_rate += ((valid ? 0.0 : 1.0) - protocol_engine::m_link_quality.frame_error_rate) / 16.0;
+
+        // Any intact frame shows that the peer is alive.
+        if(valid)
+        {
+            protocol_engine::m_last_heard = protocol_engine::now();
+            protocol_engine::set_link(true);
+        }
+    }
+    ///
+    /// \brief set_link Marks the link as up or down.
+    /// \param up TRUE if the link is up, otherwise FALSE.
+    ///
+    void set_link(bool up)
+    {
+        if(up == protocol_engine::m_link_quality.up)
+        {
+            return;
+        }
+        protocol_engine::m_link_quality.up = up;
+        if(!up)
+        {
+            protocol_engine::m_link_quality.link_downs++;
+            if(protocol_engine::m_fail_on_link_down)
+            {
+                protocol_engine::fail_unacknowledged();
+            }
+        }
+        else if(protocol_engine::m_negotiation)
+        {
+            // The peer may have restarted while the link was down, so negotiate again.
+            protocol_engine::negotiate();
+        }
+        protocol_engine::host().link_changed(protocol_engine::m_link_quality);
+    }
+    ///
+    /// \brief fail_unacknowledged Retires every receipt-required message as NOTRECEIVED.
+    ///
+    void fail_unacknowledged()
+    {
+        // Collect sequence numbers first, since completing one message may withdraw others.
+        std::vector<uint32_t, sequence_allocator> sequence_numbers(protocol_engine::m_allocator);
+        for(auto entry = protocol_engine::m_tx_index.begin(); entry != protocol_engine::m_tx_index.end(); ++entry)
+        {
+            if(protocol_engine::m_tx_queue.at(entry->second)->p_receipt_required())
+            {
+                sequence_numbers.push_back(entry->first);
+            }
+        }
+        for(auto sequence_number = sequence_numbers.begin(); sequence_number != sequence_numbers.end(); ++sequence_number)
+        {
+            auto entry = protocol_engine::m_tx_index.find(*sequence_number);
+            if(entry != protocol_engine::m_tx_index.end())
+            {
+                protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_NOT_RECEIVED);
+                protocol_engine::retire(protocol_engine::m_tx_queue.at(entry->second), message_status::NOTRECEIVED);
+            }
+        }
+    }
+    ///
+    /// \brief free_capacity Gets the free capacity of a channel's receive queue.
+    /// \param channel The channel.
+    /// \param messages Returns the free messages.
+    /// \param bytes Returns the free bytes.
+    ///
+    void free_capacity(const channel_state& channel, uint16_t& messages, uint32_t& bytes) const
+    {
+        // FIXED queues are bounded by messages, and ELASTIC queues by bytes.  The other dimension is unbounded.
+        messages = 0xFFFF;
+        bytes = 0xFFFFFFFF;
+        if(protocol_engine::m_queue_mode == queue_mode::ELASTIC)
+        {
+            uint32_t limit = channel.config.queue_memory_limit ? channel.config.queue_memory_limit : protocol_engine::m_queue_memory_limit;
+            bytes = channel.rx_bytes < limit ? static_cast<uint32_t>(limit - channel.rx_bytes) : 0;
+        }
+        else
+        {
+            uint16_t size = channel.config.queue_size ? channel.config.queue_size : protocol_engine::m_queue_size;
+            messages = channel.rx_size < size ? static_cast<uint16_t>(size - channel.rx_size) : 0;
+        }
+    }
+    ///
+    /// \brief channel Gets the state of a channel, creating it if needed.
+    /// \param channel The channel.
+    /// \return A reference to the channel's state.
+    ///
+    channel_state& channel(uint8_t channel)
+    {
+        auto state = protocol_engine::m_channels.find(channel);
+        if(state == protocol_engine::m_channels.end())
+        {
+            state = protocol_engine::m_channels.emplace(channel, channel_state(protocol_engine::m_allocator)).first;
+        }
+        return state->second;
+    }
+    ///
+    /// \brief transmit Transmits or retransmits a message, or retires it once it has been sent as often as allowed.
+    /// \param message The message.
+    ///
+    void transmit(outbound_message* message)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(message->p_message()->p_channel());
+
+        // Check if this is the first time the message is being sent.
+        if(message->p_n_transmissions() == 0)
+        {
+            // Message has not been sent yet.
+            // Send the message.
+            protocol_engine::tx(message);
+            // Check if receipt is required.
+            if(message->p_receipt_required())
+            {
+                // Receipt is required.
+                // Count the message against the receiver's credits and the channel's window until it is retired.
+                state.tx_unacknowledged++;
+                state.tx_unacknowledged_bytes += message->p_message()->p_message_length();
+                // Leave in the tx queue, wait for the receipt, and update status.
+                state.tx_waiting.insert(std::make_pair(message->p_transmit_timestamp(), message->p_sequence_number()));
+                message->update_status(message_status::VERIFYING);
+            }
+            else
+            {
+                // Receipt is not required.
+                // Update status to sent and delete from queue.
+                protocol_engine::retire(message, message_status::SENT);
+            }
+        }
+        // Message has been sent at least once and has timed out or been rejected.
+        // Check if message can be resent.
+        else if(message->can_retransmit(state.config.max_transmissions ? state.config.max_transmissions : protocol_engine::m_max_transmissions))
+        {
+            // Message can be resent.
+            protocol_engine::tx(message);
+            state.tx_waiting.insert(std::make_pair(message->p_transmit_timestamp(), message->p_sequence_number()));
+        }
+        else
+        {
+            // Message has already been sent the maximum number of times.
+            // Update status and delete.
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_NOT_RECEIVED);
+            protocol_engine::retire(message, message_status::NOTRECEIVED);
+        }
+    }
+    ///
+    /// \brief unschedule Removes a message from its channel's ready and waiting sets.
+    /// \param message The message.
+    ///
+    void unschedule(outbound_message* message)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(message->p_message()->p_channel());
+        state.tx_ready.erase(message);
+        state.tx_waiting.erase(std::make_pair(message->p_transmit_timestamp(), message->p_sequence_number()));
+    }
+    ///
+    /// \brief retire Removes a message from the transmit queue with its final status, and deletes it.
+    /// \param message The message.
+    /// \param status The final status.
+    ///
+    void retire(outbound_message* message, message_status status)
+    {
+        // Remove the message from the scheduler, index, and queue.
+        protocol_engine::unschedule(message);
+        auto entry = protocol_engine::m_tx_index.find(message->p_sequence_number());
+        protocol_engine::m_tx_queue.remove(entry->second);
+        protocol_engine::m_tx_index.erase(entry);
+        protocol_engine::channel_state& state = protocol_engine::channel(message->p_message()->p_channel());
+        state.tx_age.erase(std::make_pair(message->p_enqueue_timestamp(), message->p_sequence_number()));
+        state.tx_size--;
+        state.tx_bytes -= message->p_message()->p_message_length();
+        // Return the message's credit.
+        if(message->p_receipt_required() && message->p_n_transmissions() > 0)
+        {
+            state.tx_unacknowledged--;
+            state.tx_unacknowledged_bytes -= message->p_message()->p_message_length();
+        }
+        // Let the host release anything it kept for the message.
+        protocol_engine::host().retired(message->p_sequence_number());
+        // Publish the final status only once the message can no longer be found, then delete it.
+        message->update_status(status);
+        protocol_engine::destroy(message);
+    }
+    ///
+    /// \brief find Finds a message in the transmit queue.
+    /// \param sequence_number The sequence number of the message.
+    /// \param observer The observer the message was queued with.
+    /// \return The message, or nullptr if it is not queued with that observer.
+    ///
+    outbound_message* find(uint32_t sequence_number, const status_observer* observer) const
+    {
+        auto entry = protocol_engine::m_tx_index.find(sequence_number);
+        if(entry == protocol_engine::m_tx_index.end() || protocol_engine::m_tx_queue.at(entry->second)->p_observer() != observer)
+        {
+            return nullptr;
+        }
+        return protocol_engine::m_tx_queue.at(entry->second);
+    }
+    ///
+    /// \brief queue_full Checks if a channel's queue would overflow with another message.
+    /// \param channel The channel.
+    /// \param size The number of messages in the queue.
+    /// \param bytes The total message length in the queue.
+    /// \param length The length of the new message.
+    /// \return TRUE if the queue is full, otherwise FALSE.
+    ///
+    bool queue_full(const channel_state& channel, uint32_t size, uint64_t bytes, uint32_t length) const
+    {
+        if(protocol_engine::m_queue_mode == queue_mode::ELASTIC)
+        {
+            return bytes + length > (channel.config.queue_memory_limit ? channel.config.queue_memory_limit : protocol_engine::m_queue_memory_limit);
+        }
+        return size >= (channel.config.queue_size ? channel.config.queue_size : protocol_engine::m_queue_size);
+    }
+    ///
+    /// \brief make_room_rx Makes room in a channel's receive queue according to the overflow policy.
+    /// \param channel The channel of the message.
+    /// \param length The length of the message.
+    /// \param priority The priority of the message.
+    /// \return TRUE if there is now room for the message, otherwise FALSE.
+    ///
+    bool make_room_rx(uint8_t channel, uint32_t length, uint8_t priority)
+    {
+        protocol_engine::channel_state& state = protocol_engine::channel(channel);
+
+        // Refuse a message that would not fit even in an empty queue, rather than dropping everything for it.
+        if(protocol_engine::queue_full(state, 0, 0, length))
+        {
+            return false;
+        }
+
+        while(protocol_engine::queue_full(state, state.rx_size, state.rx_bytes, length))
+        {
+            if(protocol_engine::m_overflow_policy == overflow_policy::REJECT)
+            {
+                return false;
+            }
+
+            // Pick the message to drop according to the overflow policy.
+            inbound_message* victim = nullptr;
+            uint32_t location = 0;
+            for(uint32_t i = 0; i < protocol_engine::m_rx_queue.p_capacity(); i++)
+            {
+                inbound_message* current = protocol_engine::m_rx_queue.at(i);
+                if(current == nullptr || current->p_channel() != channel)
+                {
+                    continue;
+                }
+                bool better = false;
+                if(protocol_engine::m_overflow_policy == overflow_policy::DROP_OLDEST)
+                {
+                    // Find the oldest message.
+                    better = victim == nullptr || sequence_before(current->p_sequence_number(), victim->p_sequence_number());
+                }
+                else if(current->p_priority() < priority)
+                {
+                    // Find the newest message of the lowest priority, which take() would return last.
+                    better = victim == nullptr ||
+                             current->p_priority() < victim->p_priority() ||
+                             (current->p_priority() == victim->p_priority() && sequence_before(victim->p_sequence_number(), current->p_sequence_number()));
+                }
+                if(better)
+                {
+                    victim = current;
+                    location = i;
+                }
+            }
+            if(!victim)
+            {
+                return false;
+            }
+
+            // Drop the victim.
+            protocol_engine::m_statistics.increment(statistics_tracker::counter::RX_EVICTED);
+            protocol_engine::m_rx_queue.remove(location);
+            state.rx_size--;
+            state.rx_bytes -= victim->p_message_length();
+            protocol_engine::destroy(victim);
+        }
+        return true;
+    }
+    ///
+    /// \brief compress Compresses a packet's data in place, if it is worthwhile.
+    /// \param packet The packet.
+    /// \param header_length The length of the packet's header.
+    /// \return The new data length.
+    ///
+    uint16_t compress(uint8_t* packet, uint32_t header_length)
+    {
+        uint16_t data_length = load_big_endian<uint16_t>(&packet[header_length - 2]);
+
+        // The compressed data must save at least one byte after its 2 byte uncompressed length.
+        if(data_length <= 3)
+        {
+            return data_length;
+        }
+        uint8_t* compressed = protocol_engine::allocate(data_length);
+        uint32_t block_length = lz77_compress(&packet[header_length], data_length, &compressed[2], data_length - 3);
+        if(block_length == 0)
+        {
+            // The data does not compress.  Send it as is.
+            protocol_engine::deallocate(compressed, data_length);
+            return data_length;
+        }
+
+        // Replace the data with the uncompressed length and the compressed block.
+        store_big_endian(compressed, data_length);
+        uint16_t compressed_length = static_cast<uint16_t>(block_length + 2);
+        std::memcpy(&packet[header_length], compressed, compressed_length);
+        protocol_engine::deallocate(compressed, data_length);
+
+        // Update the data length and flag the frame as compressed.
+        store_big_endian(&packet[header_length - 2], compressed_length);
+        packet[5] |= static_cast<uint8_t>(protocol_engine::frame_flag::COMPRESSED);
+
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_COMPRESSED);
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_COMPRESSION_SAVED, data_length - compressed_length);
+        return compressed_length;
+    }
+    ///
+    /// \brief decompress Expands a packet's compressed data.
+    /// \param packet The packet.
+    /// \param header_length The length of the packet's header.
+    /// \return The expanded message byte array, or nullptr if the data is corrupt.  The caller takes ownership.
+    ///
+    uint8_t* decompress(const uint8_t* packet, uint32_t header_length)
+    {
+        uint16_t compressed_length = load_big_endian<uint16_t>(&packet[header_length - 2]);
+        if(compressed_length < 2)
+        {
+            return nullptr;
+        }
+        uint16_t data_length = load_big_endian<uint16_t>(&packet[header_length]);
+
+        // Build a message byte array from the ID, priority, uncompressed length, and expanded data.
+        uint8_t* expanded = protocol_engine::allocate(5u + data_length);
+        std::memcpy(expanded, &packet[header_length - 5], 3);
+        std::memcpy(&expanded[3], &packet[header_length], 2);
+        int64_t result = lz77_decompress(&packet[header_length + 2], compressed_length - 2u, &expanded[5], data_length);
+        if(result != data_length)
+        {
+            protocol_engine::deallocate(expanded, 5u + data_length);
+            return nullptr;
+        }
+        return expanded;
+    }
+    ///
+    /// \brief encode_delta Replaces a packet's data with a diff against its ID's delta base, if it is worthwhile.
+    /// \param packet The packet.
+    /// \param header_length The length of the packet's header.
+    /// \return The new data length.
+    ///
+    uint16_t encode_delta(uint8_t* packet, uint32_t header_length)
+    {
+        uint16_t id = load_big_endian<uint16_t>(&packet[header_length - 5]);
+        uint16_t data_length = load_big_endian<uint16_t>(&packet[header_length - 2]);
+
+        // A base is needed, and the diff must save at least one byte after its 4 byte base sequence and 2 byte data length.
+        uint32_t base_sequence;
+        const std::vector<uint8_t>* base = protocol_engine::m_delta_bases.latest(id, base_sequence);
+        if(!base || data_length <= 7)
+        {
+            return data_length;
+        }
+        uint8_t* diff = protocol_engine::allocate(data_length);
+        uint32_t diff_length = delta_encode(base->data(), static_cast<uint32_t>(base->size()), &packet[header_length], data_length, &diff[6], data_length - 7);
+        if(diff_length == 0)
+        {
+            // The data changed too much.  Send it as is.
+            protocol_engine::deallocate(diff, data_length);
+            return data_length;
+        }
+
+        // Replace the data with the base sequence, data length, and diff.
+        store_big_endian(diff, base_sequence);
+        store_big_endian(&diff[4], data_length);
+        uint16_t encoded_length = static_cast<uint16_t>(diff_length + 6);
+        std::memcpy(&packet[header_length], diff, encoded_length);
+        protocol_engine::deallocate(diff, data_length);
+
+        // Update the data length and flag the frame as delta encoded.
+        store_big_endian(&packet[header_length - 2], encoded_length);
+        packet[5] |= static_cast<uint8_t>(protocol_engine::frame_flag::DELTA);
+
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_DELTA);
+        protocol_engine::m_statistics.increment(statistics_tracker::counter::TX_DELTA_SAVED, data_length - encoded_length);
+        return encoded_length;
+    }
+    ///
+    /// \brief decode_delta Reconstructs a delta encoded message from its cached base.
+    /// \param bytes The delta encoded message byte array.
+    /// \return The reconstructed message byte array, or nullptr if the base is not cached.  The caller takes ownership.
+    ///
+    uint8_t* decode_delta(const uint8_t* bytes)
+    {
+        uint16_t id = load_big_endian<uint16_t>(&bytes[0]);
+        uint16_t encoded_length = load_big_endian<uint16_t>(&bytes[3]);
+        if(encoded_length < 6)
+        {
+            return nullptr;
+        }
+        uint32_t base_sequence = load_big_endian<uint32_t>(&bytes[5]);
+        uint16_t data_length = load_big_endian<uint16_t>(&bytes[9]);
+
+        // Look up the base the sender diffed against.
+        const std::vector<uint8_t>* base = protocol_engine::m_delta_history.find(id, base_sequence);
+        if(!base)
+        {
+            return nullptr;
+        }
+
+        // Build a message byte array from the ID, priority, data length, and reconstructed data.
+        uint8_t* reconstructed = protocol_engine::allocate(5u + data_length);
+        std::memcpy(reconstructed, bytes, 3);
+        std::memcpy(&reconstructed[3], &bytes[9], 2);
+        if(!delta_decode(base->data(), static_cast<uint32_t>(base->size()), &bytes[11], encoded_length - 6u, &reconstructed[5], data_length))
+        {
+            protocol_engine::deallocate(reconstructed, 5u + data_length);
+            return nullptr;
+        }
+        return reconstructed;
+    }
+    ///
+    /// \brief seal_header Adds the header checksum to a packet, if headers carry one.
+    /// \param packet The packet.
+    ///
+    void seal_header(uint8_t* packet)
+    {
+        if(protocol_engine::header_length() == 12)
+        {
+            // When negotiating, flag the header checksum so that the peer can parse the frame whatever its current format.
+            if(protocol_engine::m_negotiation)
+            {
+                packet[5] |= static_cast<uint8_t>(protocol_engine::frame_flag::HEADER_CHECKSUM);
+            }
+            packet[6] = framing::header_checksum(packet, 12);
+        }
+    }
+};
+}}
+
+#endif // PROTOCOL_ENGINE_H
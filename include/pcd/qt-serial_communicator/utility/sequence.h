@@ -0,0 +1,24 @@
+/// \file sequence.h
+/// \brief Defines the serial_communicator::utility sequence number comparison.
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <cstdint>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief sequence_before Checks if one sequence number was assigned before another.
+/// \param a The first sequence number.
+/// \param b The second sequence number.
+/// \return TRUE if a is older than b, otherwise FALSE.
+/// \details Sequence numbers wrap around, so they are compared with serial number arithmetic:
+/// a is older if it is less than half the sequence space behind b.
+///
+inline bool sequence_before(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) < 0;
+}
+}}
+
+#endif // SEQUENCE_H
@@ -0,0 +1,200 @@
+/// \file slot_pool.h
+/// \brief Defines the serial_communicator::utility::slot_pool class.
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Stores pointers in numbered slots that grow in fixed size chunks.
+/// \details Growing appends a new chunk, so existing entries are never copied or moved and their
+/// slot numbers stay valid until they are removed.  Freed slots are reused before the pool grows.
+/// The pool does not own the pointers it stores.  Allocator is rebound for the chunks and the slot lists.
+///
+template <typename T, typename Allocator = std::allocator<T*>>
+class slot_pool
+{
+public:
+    // CONSTRUCTORS
+    ///
+    /// \brief slot_pool Creates a new, empty slot_pool instance.
+    /// \param chunk_size The number of slots added each time the pool grows.
+    /// \param allocator The allocator for the chunks and the slot lists.
+    ///
+    slot_pool(uint32_t chunk_size, const Allocator& allocator = Allocator())
+        : m_allocator(allocator),
+          m_chunks(chunk_list_allocator(allocator)),
+          m_free(free_list_allocator(allocator))
+    {
+        slot_pool::m_chunk_size = chunk_size;
+        slot_pool::m_size = 0;
+    }
+    ~slot_pool()
+    {
+        // Clean up chunks.  The stored pointers belong to the caller.
+        for(auto chunk = slot_pool::m_chunks.begin(); chunk != slot_pool::m_chunks.end(); ++chunk)
+        {
+            std::allocator_traits<chunk_allocator>::deallocate(slot_pool::m_allocator, *chunk, slot_pool::m_chunk_size);
+        }
+    }
+
+    // METHODS
+    ///
+    /// \brief insert Stores a pointer in a free slot, growing the pool by one chunk if none is free.
+    /// \param item The pointer to store.
+    /// \return The slot the pointer was stored in.
+    ///
+    uint32_t insert(T* item)
+    {
+        // Add a chunk if every slot is taken.
+        if(slot_pool::m_free.empty())
+        {
+            uint32_t first = slot_pool::p_capacity();
+            T** chunk = std::allocator_traits<chunk_allocator>::allocate(slot_pool::m_allocator, slot_pool::m_chunk_size);
+            for(uint32_t i = 0; i < slot_pool::m_chunk_size; i++)
+            {
+                chunk[i] = nullptr;
+            }
+            slot_pool::m_chunks.push_back(chunk);
+            // Push the new slots in reverse so the lowest is used first.
+            for(uint32_t i = slot_pool::m_chunk_size; i > 0; i--)
+            {
+                slot_pool::m_free.push_back(first + i - 1);
+            }
+        }
+
+        // Take a free slot.
+        uint32_t slot = slot_pool::m_free.back();
+        slot_pool::m_free.pop_back();
+        slot_pool::m_chunks[slot / slot_pool::m_chunk_size][slot % slot_pool::m_chunk_size] = item;
+        slot_pool::m_size++;
+        return slot;
+    }
+    ///
+    /// \brief at Gets the pointer stored in a slot.
+    /// \param slot The slot.
+    /// \return The stored pointer, or nullptr if the slot is free.
+    ///
+    T* at(uint32_t slot) const
+    {
+        return slot_pool::m_chunks[slot / slot_pool::m_chunk_size][slot % slot_pool::m_chunk_size];
+    }
+    ///
+    /// \brief remove Frees a slot.
+    /// \param slot The slot, which must be occupied.
+    /// \return The pointer that was stored in the slot.
+    ///
+    T* remove(uint32_t slot)
+    {
+        T*& entry = slot_pool::m_chunks[slot / slot_pool::m_chunk_size][slot % slot_pool::m_chunk_size];
+        T* item = entry;
+        entry = nullptr;
+        slot_pool::m_free.push_back(slot);
+        slot_pool::m_size--;
+        return item;
+    }
+    ///
+    /// \brief trim Releases chunks at the end of the pool that hold no pointers.
+    ///
+    void trim()
+    {
+        // Find the number of chunks up to the last occupied one.
+        uint32_t n_chunks = static_cast<uint32_t>(slot_pool::m_chunks.size());
+        while(n_chunks > 0 && slot_pool::chunk_empty(n_chunks - 1))
+        {
+            n_chunks--;
+        }
+        if(n_chunks == slot_pool::m_chunks.size())
+        {
+            return;
+        }
+
+        // Release the empty chunks and forget their slots.
+        for(uint32_t i = n_chunks; i < slot_pool::m_chunks.size(); i++)
+        {
+            std::allocator_traits<chunk_allocator>::deallocate(slot_pool::m_allocator, slot_pool::m_chunks[i], slot_pool::m_chunk_size);
+        }
+        slot_pool::m_chunks.resize(n_chunks);
+        uint32_t capacity = slot_pool::p_capacity();
+        std::vector<uint32_t, free_list_allocator> free(slot_pool::m_free.get_allocator());
+        for(auto slot = slot_pool::m_free.begin(); slot != slot_pool::m_free.end(); ++slot)
+        {
+            if(*slot < capacity)
+            {
+                free.push_back(*slot);
+            }
+        }
+        slot_pool::m_free.swap(free);
+    }
+
+    // PROPERTIES
+    ///
+    /// \brief p_size Gets the number of occupied slots.
+    /// \return The number of occupied slots.
+    ///
+    uint32_t p_size() const
+    {
+        return slot_pool::m_size;
+    }
+    ///
+    /// \brief p_capacity Gets the number of slots currently allocated.
+    /// \return The number of allocated slots, which is also one past the highest slot.
+    ///
+    uint32_t p_capacity() const
+    {
+        return static_cast<uint32_t>(slot_pool::m_chunks.size()) * slot_pool::m_chunk_size;
+    }
+
+private:
+    // TYPES
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T*> chunk_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T**> chunk_list_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint32_t> free_list_allocator;
+
+    // VARIABLES
+    ///
+    /// \brief m_allocator Stores the allocator for the chunks.
+    ///
+    chunk_allocator m_allocator;
+    ///
+    /// \brief m_chunk_size Stores the number of slots per chunk.
+    ///
+    uint32_t m_chunk_size;
+    ///
+    /// \brief m_chunks Stores the chunks of slots.
+    ///
+    std::vector<T**, chunk_list_allocator> m_chunks;
+    ///
+    /// \brief m_free Stores the free slots, with the next to use at the back.
+    ///
+    std::vector<uint32_t, free_list_allocator> m_free;
+    ///
+    /// \brief m_size Stores the number of occupied slots.
+    ///
+    uint32_t m_size;
+
+    // METHODS
+    ///
+    /// \brief chunk_empty Checks if a chunk holds no pointers.
+    /// \param chunk The index of the chunk.
+    /// \return TRUE if every slot in the chunk is free, otherwise FALSE.
+    ///
+    bool chunk_empty(uint32_t chunk) const
+    {
+        for(uint32_t i = 0; i < slot_pool::m_chunk_size; i++)
+        {
+            if(slot_pool::m_chunks[chunk][i] != nullptr)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+}}
+
+#endif // SLOT_POOL_H
@@ -0,0 +1,132 @@
+/// \file statistics_tracker.h
+/// \brief Defines the serial_communicator::utility::statistics_tracker class.
+#ifndef STATISTICS_TRACKER_H
+#define STATISTICS_TRACKER_H
+
+#include "pcd/qt-serial_communicator/statistics.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief Collects runtime counters for a communicator.
+/// \details All counters are relaxed atomics so that they may be incremented from the I/O path
+/// and read from any thread without locking.
+///
+class statistics_tracker
+{
+public:
+    // ENUMERATIONS
+    ///
+    /// \brief Enumerates the cumulative counters.
+    ///
+    enum class counter
+    {
+        TX_FRAMES = 0,
+        TX_BYTES,
+        TX_ESCAPED_BYTES,
+        TX_RETRANSMISSIONS,
+        TX_REJECTED,
+        TX_NOT_RECEIVED,
+        TX_CANCELLED,
+        TX_EVICTED,
+        TX_SPOOLED,
+        TX_COMPRESSED,
+        TX_COMPRESSION_SAVED,
+        TX_DELTA,
+        TX_DELTA_SAVED,
+        TX_PIGGYBACKED_RECEIPTS,
+        TX_CREDIT_STALLS,
+        TX_CREDIT_UPDATES,
+        RX_FRAMES,
+        RX_BYTES,
+        RX_DISCARDED_BYTES,
+        RX_CHECKSUM_FAILURES,
+        RX_HEADER_FAILURES,
+        RX_OVERSIZE,
+        RX_TRUNCATED,
+        RX_DROPPED,
+        RX_EVICTED,
+        RX_DECOMPRESSION_FAILURES,
+        RX_DELTA_MISSES,
+        RX_UNMATCHED_RESPONSES,
+        RX_FILTERED,
+        COUNT
+    };
+    ///
+    /// \brief Enumerates the high-water gauges.
+    ///
+    enum class gauge
+    {
+        TX_QUEUE = 0,
+        RX_QUEUE,
+        COUNT
+    };
+
+    // CONSTRUCTORS
+    ///
+    /// \brief statistics_tracker Creates a new statistics_tracker instance with all counters at zero.
+    ///
+    statistics_tracker();
+
+    // METHODS
+    ///
+    /// \brief increment Adds to a cumulative counter.
+    /// \param counter The counter to add to.
+    /// \param amount OPTIONAL The amount to add.
+    ///
+    void increment(counter counter, uint64_t amount = 1);
+    ///
+    /// \brief high_water Raises a high-water gauge if the given level exceeds it.
+    /// \param gauge The gauge to update.
+    /// \param level The current level to compare against the gauge.
+    ///
+    void high_water(gauge gauge, uint32_t level);
+    ///
+    /// \brief sample Closes the current rate interval and computes new per-second rates.
+    /// \details Call this periodically.  Rates reported by snapshot() are those of the most
+    /// recently closed interval.
+    ///
+    void sample();
+    ///
+    /// \brief snapshot Reads all counters into a statistics structure.
+    /// \return The current statistics.
+    ///
+    statistics snapshot() const;
+
+private:
+    // VARIABLES
+    ///
+    /// \brief m_counters Stores the cumulative counters.
+    ///
+    std::atomic<uint64_t> m_counters[static_cast<int>(counter::COUNT)];
+    ///
+    /// \brief m_gauges Stores the high-water gauges.
+    ///
+    std::atomic<uint32_t> m_gauges[static_cast<int>(gauge::COUNT)];
+    ///
+    /// \brief m_rates Stores the tx frame, tx byte, rx frame, and rx byte rates of the last interval.
+    ///
+    std::atomic<double> m_rates[4];
+    ///
+    /// \brief m_sample_counters Stores the tx frame, tx byte, rx frame, and rx byte counters at the last sample.
+    ///
+    uint64_t m_sample_counters[4];
+    ///
+    /// \brief m_sample_timestamp Stores the time of the last sample.
+    ///
+    std::chrono::steady_clock::time_point m_sample_timestamp;
+
+    // METHODS
+    ///
+    /// \brief read Reads a cumulative counter.
+    /// \param counter The counter to read.
+    /// \return The current value of the counter.
+    ///
+    uint64_t read(counter counter) const;
+};
+}}
+
+#endif // STATISTICS_TRACKER_H
@@ -0,0 +1,30 @@
+/// \file status_observer.h
+/// \brief Defines the serial_communicator::utility::status_observer class.
+#ifndef STATUS_OBSERVER_H
+#define STATUS_OBSERVER_H
+
+#include "pcd/qt-serial_communicator/message_status.h"
+
+namespace serial_communicator {
+namespace utility {
+///
+/// \brief An interface for following the status of an outbound message.
+/// \details Outbound messages report each status change to their observer, so that the queues
+/// need not know how the status is published.
+///
+class status_observer
+{
+public:
+    // CONSTRUCTORS
+    virtual ~status_observer() {}
+
+    // METHODS
+    ///
+    /// \brief update Receives the message's new status.
+    /// \param status The new status.
+    ///
+    virtual void update(message_status status) = 0;
+};
+}}
+
+#endif // STATUS_OBSERVER_H
@@ -0,0 +1,63 @@
+INCLUDEPATH += $$PWD/include
+
+SOURCES += \
+    $$PWD/src/byte_swap.cpp \
+    $$PWD/src/capture.cpp \
+    $$PWD/src/capture_reader.cpp \
+    $$PWD/src/communicator.cpp \
+    $$PWD/src/delta.cpp \
+    $$PWD/src/delta_cache.cpp \
+    $$PWD/src/decode_pool.cpp \
+    $$PWD/src/delivery.cpp \
+    $$PWD/src/emulated_device.cpp \
+    $$PWD/src/emulated_link.cpp \
+    $$PWD/src/latency_histogram.cpp \
+    $$PWD/src/latency_recorder.cpp \
+    $$PWD/src/loopback.cpp \
+    $$PWD/src/loopback_device.cpp \
+    $$PWD/src/lz77.cpp \
+    $$PWD/src/message.cpp \
+    $$PWD/src/replayer.cpp \
+    $$PWD/src/reply.cpp \
+    $$PWD/src/spool.cpp \
+    $$PWD/src/statistics_tracker.cpp
+
+HEADERS += \
+    $$PWD/include/pcd/qt-serial_communicator/capture.h \
+    $$PWD/include/pcd/qt-serial_communicator/capture_reader.h \
+    $$PWD/include/pcd/qt-serial_communicator/channel_config.h \
+    $$PWD/include/pcd/qt-serial_communicator/communicator.h \
+    $$PWD/include/pcd/qt-serial_communicator/decode_pool.h \
+    $$PWD/include/pcd/qt-serial_communicator/delivery.h \
+    $$PWD/include/pcd/qt-serial_communicator/emulated_link.h \
+    $$PWD/include/pcd/qt-serial_communicator/latency_histogram.h \
+    $$PWD/include/pcd/qt-serial_communicator/latency_metric.h \
+    $$PWD/include/pcd/qt-serial_communicator/link_quality.h \
+    $$PWD/include/pcd/qt-serial_communicator/loopback.h \
+    $$PWD/include/pcd/qt-serial_communicator/message.h \
+    $$PWD/include/pcd/qt-serial_communicator/message_status.h \
+    $$PWD/include/pcd/qt-serial_communicator/overflow_policy.h \
+    $$PWD/include/pcd/qt-serial_communicator/queue_mode.h \
+    $$PWD/include/pcd/qt-serial_communicator/replayer.h \
+    $$PWD/include/pcd/qt-serial_communicator/reply.h \
+    $$PWD/include/pcd/qt-serial_communicator/reply_status.h \
+    $$PWD/include/pcd/qt-serial_communicator/schema.h \
+    $$PWD/include/pcd/qt-serial_communicator/spool.h \
+    $$PWD/include/pcd/qt-serial_communicator/statistics.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/byte_order.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/byte_swap.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/delta.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/delta_cache.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/emulated_device.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/frame_engine.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/inbound.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/latency_recorder.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/loopback_device.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/lz77.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/mpmc_queue.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/outbound.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/protocol_engine.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/sequence.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/slot_pool.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/statistics_tracker.h \
+    $$PWD/include/pcd/qt-serial_communicator/utility/status_observer.h
@@ -0,0 +1,134 @@
+#include "pcd/qt-serial_communicator/utility/byte_swap.h"
+#include "pcd/qt-serial_communicator/utility/byte_order.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SERIAL_COMMUNICATOR_X86_SHUFFLE
+#include <immintrin.h>
+#endif
+
+namespace {
+// SCALAR KERNEL
+template <typename T>
+void swap_scalar(uint8_t* destination, const uint8_t* source, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        T value = serial_communicator::utility::load_big_endian<T>(source + i * sizeof(T));
+        std::memcpy(destination + i * sizeof(T), &value, sizeof(T));
+    }
+}
+void swap_scalar(uint8_t* destination, const uint8_t* source, uint32_t element_size, uint32_t count)
+{
+    switch(element_size)
+    {
+    case 2:
+    {
+        swap_scalar<uint16_t>(destination, source, count);
+        break;
+    }
+    case 4:
+    {
+        swap_scalar<uint32_t>(destination, source, count);
+        break;
+    }
+    case 8:
+    {
+        swap_scalar<uint64_t>(destination, source, count);
+        break;
+    }
+    }
+}
+
+#ifdef SERIAL_COMMUNICATOR_X86_SHUFFLE
+// SHUFFLE KERNELS
+///
+/// \brief shuffle_mask Builds the pshufb mask that reverses each element within a 16 byte lane.
+///
+void shuffle_mask(uint32_t element_size, int8_t* mask)
+{
+    for(uint32_t i = 0; i < 16; i++)
+    {
+        uint32_t element = i / element_size;
+        mask[i] = static_cast<int8_t>(element * element_size + (element_size - 1 - i % element_size));
+    }
+}
+__attribute__((target("ssse3")))
+void swap_ssse3(uint8_t* destination, const uint8_t* source, uint32_t element_size, uint32_t count)
+{
+    int8_t mask_bytes[16];
+    shuffle_mask(element_size, mask_bytes);
+    __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask_bytes));
+
+    // Swap 16 bytes at a time, then finish the remaining elements with the scalar kernel.
+    uint32_t length = element_size * count;
+    uint32_t i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_shuffle_epi8(block, mask));
+    }
+    swap_scalar(destination + i, source + i, element_size, (length - i) / element_size);
+}
+__attribute__((target("avx2")))
+void swap_avx2(uint8_t* destination, const uint8_t* source, uint32_t element_size, uint32_t count)
+{
+    int8_t mask_bytes[16];
+    shuffle_mask(element_size, mask_bytes);
+    __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask_bytes));
+    __m256i mask = _mm256_broadcastsi128_si256(lane);
+
+    // Swap 32 bytes at a time, then 16, then finish the remaining elements with the scalar kernel.
+    uint32_t length = element_size * count;
+    uint32_t i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_shuffle_epi8(block, mask));
+    }
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_shuffle_epi8(block, lane));
+    }
+    swap_scalar(destination + i, source + i, element_size, (length - i) / element_size);
+}
+typedef void (*swap_kernel)(uint8_t*, const uint8_t*, uint32_t, uint32_t);
+swap_kernel select_kernel()
+{
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return swap_avx2;
+    }
+    if(__builtin_cpu_supports("ssse3"))
+    {
+        return swap_ssse3;
+    }
+    return swap_scalar;
+}
+#endif
+}
+
+void serial_communicator::utility::copy_big_endian(uint8_t* destination, const uint8_t* source, uint32_t element_size, uint32_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    // Host order is already big endian.
+    std::memcpy(destination, source, element_size * count);
+#else
+    // Single bytes have no order.
+    if(element_size == 1)
+    {
+        std::memcpy(destination, source, count);
+        return;
+    }
+#ifdef SERIAL_COMMUNICATOR_X86_SHUFFLE
+    // Select the widest supported kernel once.
+    static const swap_kernel kernel = select_kernel();
+    kernel(destination, source, element_size, count);
+#else
+    swap_scalar(destination, source, element_size, count);
+#endif
+#endif
+}
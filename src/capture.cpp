@@ -0,0 +1,115 @@
+#include "pcd/qt-serial_communicator/capture.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+capture::capture(const std::string& path, uint32_t max_pending)
+{
+    // Store locals.
+    capture::m_max_pending = max_pending;
+    capture::m_stop = false;
+    capture::m_dropped.store(0, std::memory_order_relaxed);
+    capture::m_last_timestamp = std::chrono::steady_clock::now();
+
+    // Open the file and write the file header.
+    capture::m_file = std::fopen(path.c_str(), "wb");
+    if(capture::m_file)
+    {
+        const uint8_t header[8] = {'S', 'C', 'C', 'P', 0, 1, 0, 0};
+        std::fwrite(header, 1, 8, capture::m_file);
+
+        // Start the background writer.
+        capture::m_writer = std::thread(&capture::writer, this);
+    }
+}
+capture::~capture()
+{
+    if(capture::m_file)
+    {
+        // Instruct the writer to flush remaining records and exit.
+        {
+            std::lock_guard<std::mutex> lock(capture::m_mutex);
+            capture::m_stop = true;
+        }
+        capture::m_condition.notify_one();
+        capture::m_writer.join();
+
+        // Close the file.
+        std::fclose(capture::m_file);
+    }
+}
+
+// METHODS
+void capture::record(direction direction, const uint8_t* data, uint32_t length)
+{
+    if(!capture::m_file || length == 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(capture::m_mutex);
+
+        // Drop the record if the writer has fallen too far behind.
+        if(capture::m_pending.size() + length > capture::m_max_pending)
+        {
+            capture::m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Calculate the time since the previous record.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        uint64_t delta = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - capture::m_last_timestamp).count());
+        capture::m_last_timestamp = now;
+
+        // Encode the record.
+        capture::m_pending.push_back(static_cast<uint8_t>(direction));
+        capture::write_varint(delta);
+        capture::write_varint(length);
+        capture::m_pending.insert(capture::m_pending.end(), data, data + length);
+    }
+    capture::m_condition.notify_one();
+}
+
+// PROPERTIES
+bool capture::p_is_open() const
+{
+    return capture::m_file != nullptr;
+}
+uint64_t capture::p_dropped() const
+{
+    return capture::m_dropped.load(std::memory_order_relaxed);
+}
+
+// PRIVATE METHODS
+void capture::write_varint(uint64_t value)
+{
+    // Write 7 bits at a time, least significant first, with the high bit marking continuation.
+    while(value >= 0x80)
+    {
+        capture::m_pending.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    capture::m_pending.push_back(static_cast<uint8_t>(value));
+}
+void capture::writer()
+{
+    // Swap the pending buffer out under the lock and write it without the lock held.
+    std::vector<uint8_t> writing;
+    std::unique_lock<std::mutex> lock(capture::m_mutex);
+    while(true)
+    {
+        capture::m_condition.wait(lock, [this]{return capture::m_stop || !capture::m_pending.empty();});
+        if(capture::m_pending.empty() && capture::m_stop)
+        {
+            break;
+        }
+        writing.swap(capture::m_pending);
+
+        lock.unlock();
+        std::fwrite(writing.data(), 1, writing.size(), capture::m_file);
+        writing.clear();
+        lock.lock();
+    }
+    std::fflush(capture::m_file);
+}
@@ -0,0 +1,97 @@
+#include "pcd/qt-serial_communicator/capture_reader.h"
+
+#include <cstring>
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+capture_reader::capture_reader(const std::string& path)
+{
+    capture_reader::m_timestamp = 0;
+    capture_reader::m_first = true;
+
+    // Open the file and validate the file header.
+    capture_reader::m_file = std::fopen(path.c_str(), "rb");
+    if(capture_reader::m_file)
+    {
+        uint8_t header[8];
+        if(std::fread(header, 1, 8, capture_reader::m_file) != 8 || std::memcmp(header, "SCCP", 4) != 0 || header[4] != 0 || header[5] != 1)
+        {
+            std::fclose(capture_reader::m_file);
+            capture_reader::m_file = nullptr;
+        }
+    }
+}
+capture_reader::~capture_reader()
+{
+    if(capture_reader::m_file)
+    {
+        std::fclose(capture_reader::m_file);
+    }
+}
+
+// METHODS
+bool capture_reader::next(capture::direction& direction, uint64_t& timestamp_ns, std::vector<uint8_t>& data)
+{
+    if(!capture_reader::m_file)
+    {
+        return false;
+    }
+
+    // Read the direction.
+    int direction_byte = std::fgetc(capture_reader::m_file);
+    if(direction_byte == EOF)
+    {
+        return false;
+    }
+    direction = static_cast<capture::direction>(direction_byte);
+
+    // Read the time delta and length.
+    uint64_t delta = 0;
+    uint64_t length = 0;
+    if(!capture_reader::read_varint(delta) || !capture_reader::read_varint(length))
+    {
+        return false;
+    }
+
+    // Accumulate the timestamp, measuring from the first record.
+    if(capture_reader::m_first)
+    {
+        capture_reader::m_first = false;
+    }
+    else
+    {
+        capture_reader::m_timestamp += delta;
+    }
+    timestamp_ns = capture_reader::m_timestamp;
+
+    // Read the bytes.
+    data.resize(length);
+    return std::fread(data.data(), 1, length, capture_reader::m_file) == length;
+}
+
+// PROPERTIES
+bool capture_reader::p_is_open() const
+{
+    return capture_reader::m_file != nullptr;
+}
+
+// PRIVATE METHODS
+bool capture_reader::read_varint(uint64_t& value)
+{
+    value = 0;
+    for(uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        int byte = std::fgetc(capture_reader::m_file);
+        if(byte == EOF)
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
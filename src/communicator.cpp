@@ -3,19 +3,26 @@
 #include <QDateTime>
 #include <QThread>
 #include <QCoreApplication>
-#include <QtEndian>
-#include <cstring>
 
 using namespace serial_communicator;
 
 // CONSTRUCTORS
-communicator::communicator(QSerialPort *serial_port)
+communicator::communicator(QIODevice* device)
+    : m_engine(engine_host{this})
 {
-    // Set up the serial port.
-    communicator::m_serial_port = serial_port;
-    communicator::m_serial_port->flush();
-    communicator::connect(communicator::m_serial_port, &QSerialPort::readyRead, this, &communicator::data_ready);
-    communicator::m_escape_next = false;
+    // Set up the transport device.
+    communicator::m_device = device;
+    // Serial ports may have stale output pending from a previous user.
+    QSerialPort* serial_port = qobject_cast<QSerialPort*>(device);
+    if(serial_port)
+    {
+        serial_port->flush();
+    }
+    communicator::connect(communicator::m_device, &QIODevice::readyRead, this, &communicator::data_ready);
+    communicator::m_capture = nullptr;
+    communicator::m_spool = nullptr;
+    communicator::m_decode_pool = nullptr;
+    communicator::m_collect_pending.store(false);
 
     // Set up the spin timer.
     communicator::m_timer = new QTimer();
@@ -23,22 +30,23 @@ communicator::communicator(QSerialPort *serial_port)
     communicator::m_timer->setInterval(20);
     communicator::m_timer->start();
 
+    // Set up the wake timer, which spins early when the engine has a deadline before the next spin.
+    communicator::m_wake_timer = new QTimer();
+    communicator::m_wake_timer->setSingleShot(true);
+    communicator::m_wake_timer->setTimerType(Qt::PreciseTimer);
+    communicator::connect(communicator::m_wake_timer, &QTimer::timeout, this, &communicator::timer);
+
     // Initialize parameters to default values.
-    communicator::m_queue_size = 10;
-    communicator::m_receipt_timeout = 100;
-    communicator::m_max_transmissions = 5;
+    communicator::m_statistics_interval = 1000;
 
-    // Initialize sequence counter.
-    communicator::m_sequence_counter = 0;
+    // Set up the statistics timer.
+    communicator::m_statistics_timer = new QTimer();
+    communicator::connect(communicator::m_statistics_timer, &QTimer::timeout, this, &communicator::statistics_timer);
+    communicator::m_statistics_timer->setInterval(static_cast<int>(communicator::m_statistics_interval));
+    communicator::m_statistics_timer->start();
 
-    // Initialize queues.
-    communicator::m_tx_queue = new utility::outbound*[communicator::m_queue_size];
-    communicator::m_rx_queue = new utility::inbound*[communicator::m_queue_size];
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
-    {
-        communicator::m_tx_queue[i] = nullptr;
-        communicator::m_rx_queue[i] = nullptr;
-    }
+    // Initialize correlation counter.
+    communicator::m_correlation_counter = 0;
 }
 communicator::~communicator()
 {
@@ -46,548 +54,513 @@ communicator::~communicator()
     communicator::m_timer->stop();
     delete communicator::m_timer;
 
-    // Clean up queues.
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+    // Stop wake timer.
+    communicator::m_wake_timer->stop();
+    delete communicator::m_wake_timer;
+
+    // Stop statistics timer.
+    communicator::m_statistics_timer->stop();
+    delete communicator::m_statistics_timer;
+
+    // Fail any calls still waiting for a response.
+    while(!communicator::m_pending_calls.empty())
     {
-        if(communicator::m_tx_queue[i] != nullptr)
-        {
-            delete communicator::m_tx_queue[i];
-        }
-        if(communicator::m_rx_queue[i] != nullptr)
+        communicator::finish_call(communicator::m_pending_calls.begin()->first, reply_status::NOT_DELIVERED, nullptr);
+    }
+
+    // Abandon the deliveries of messages still waiting in the spool, which keeps their records.
+    for(auto spooled = communicator::m_spooled.begin(); spooled != communicator::m_spooled.end(); ++spooled)
+    {
+        if(spooled->second.delivery)
         {
-            delete communicator::m_rx_queue[i];
+            spooled->second.delivery->update(message_status::NOTRECEIVED);
         }
     }
-    delete [] communicator::m_tx_queue;
-    delete [] communicator::m_rx_queue;
+
+    // The engine is destroyed first, and waits for the decode pool before cleaning up its queues.
 }
 
 // PUBLIC METHODS
 bool communicator::send(message* message, bool receipt_required, message_status* tracker)
 {
-    // Find an open spot in the transmit queue.
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
-    {
-        if(communicator::m_tx_queue[i] == nullptr)
-        {
-            // Open space found. Add outbound message and increment sequence counter.
-            communicator::m_tx_queue[i] = new utility::outbound(message, communicator::m_sequence_counter++, receipt_required, tracker);
-            // Quit here.
-            return true;
-        }
-    }
-
-    // If this point reached, a spot was not found.
-    delete message;
-    return false;
+    return communicator::enqueue(message, receipt_required, tracker, nullptr, std::vector<uint8_t>());
 }
-uint16_t communicator::messages_available() const
+std::shared_ptr<delivery> communicator::send_async(message* message, bool receipt_required)
 {
-    // Count and return total number of messages in receive queue.
-    uint16_t n_messages = 0;
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+    // Create a delivery shared with the outbound message.
+    std::shared_ptr<delivery> handle = std::make_shared<delivery>(communicator::m_engine.p_next_sequence());
+    if(!communicator::enqueue(message, receipt_required, nullptr, handle, std::vector<uint8_t>()))
     {
-        if(communicator::m_rx_queue[i] != nullptr)
-        {
-            n_messages++;
-        }
+        return nullptr;
     }
-    return n_messages;
+    return handle;
 }
-message* communicator::receive(uint16_t id)
+std::shared_ptr<reply> communicator::call(message* request, uint32_t timeout, bool receipt_required)
 {
-    // Find a message with the matching ID that has the highest priority, followed by oldest age.
-    utility::inbound* to_read = nullptr;
-    uint16_t location = 0;
-
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+    // Tag the request with a new correlation ID.
+    uint32_t correlation = communicator::m_correlation_counter++;
+    std::shared_ptr<reply> handle = std::make_shared<reply>(correlation);
+    // The correlation ID travels in the extension block, so a peer that cannot read one could never answer.
+    if(!communicator::m_engine.uses(engine::feature::EXTENSIONS))
     {
-        // Check if there is a valid message at this location.
-        if(communicator::m_rx_queue[i] != nullptr)
-        {
-            // Store local reference to this message.
-            utility::inbound* current = communicator::m_rx_queue[i];
-
-            // Check if the message has a matching id.
-            if(id == 0xFFFF || current->p_message()->p_id() == id)
-            {
-                // If to_read is currently empty, initialize it.
-                if(to_read == nullptr)
-                {
-                    to_read = current;
-                    location = i;
-                }
-                else
-                {
-                    // Check to see if the current message beats the to_read message in priority.
-                    if(current->p_message()->p_priority() > to_read->p_message()->p_priority())
-                    {
-                        // Replace the to_read message with the current message.
-                        to_read = current;
-                        location = i;
-                    }
-                    // Otherwise, check if priorities are equal.
-                    else if(current->p_message()->p_priority() == to_read->p_message()->p_priority())
-                    {
-                        // Compare age.
-                        if(current->p_sequence_number() < to_read->p_sequence_number())
-                        {
-                            // Replace to_read message with current message.
-                            to_read = current;
-                            location = i;
-                        }
-                    }
-                }
-
-            }
-        }
+        delete request;
+        handle->complete(reply_status::NOT_DELIVERED, nullptr);
+        return handle;
     }
-
-    // Check if a message was actually found.
-    if(to_read == nullptr)
+    std::shared_ptr<delivery> request_delivery = std::make_shared<delivery>(communicator::m_engine.p_next_sequence());
+    if(!communicator::enqueue(request, receipt_required, nullptr, request_delivery, engine::correlation_entry(engine::call_kind::REQUEST, correlation)))
     {
-        return nullptr;
+        handle->complete(reply_status::NOT_DELIVERED, nullptr);
+        return handle;
     }
 
-    // If this point has been reached, a valid message has been found to read.
+    // Track the call until its response arrives or it times out.
+    communicator::pending_call entry;
+    entry.reply = handle;
+    entry.deadline = communicator::m_call_deadlines.emplace(communicator::clock::now() + std::chrono::milliseconds(timeout), correlation);
+    communicator::m_pending_calls[correlation] = entry;
 
-    // Extract the message from the inbound instance before it is deleted.
-    message* output = to_read->p_message();
+    // Fail the call early if the request is not delivered.
+    request_delivery->on_complete([this, correlation](message_status status)
+    {
+        if(status == message_status::NOTRECEIVED || status == message_status::CANCELLED || status == message_status::DROPPED)
+        {
+            communicator::finish_call(correlation, reply_status::NOT_DELIVERED, nullptr);
+        }
+    });
 
-    // Remove the inbound entry from the receive queue.
-    delete communicator::m_rx_queue[location];
-    communicator::m_rx_queue[location] = nullptr;
+    return handle;
+}
+void communicator::serve(uint16_t id, std::function<message*(const message&)> handler)
+{
+    if(handler)
+    {
+        communicator::m_handlers[id] = handler;
+    }
+    else
+    {
+        communicator::m_handlers.erase(id);
+    }
+}
+bool communicator::cancel(const delivery& handle)
+{
+    // Withdraw the message whether it is queued or awaiting a receipt.
+    return communicator::m_engine.cancel(handle.p_sequence_number(), &handle);
+}
+bool communicator::set_priority(const delivery& handle, uint8_t priority)
+{
+    return communicator::m_engine.set_priority(handle.p_sequence_number(), &handle, priority);
+}
+uint32_t communicator::messages_available() const
+{
+    return communicator::m_engine.messages_available();
+}
+uint32_t communicator::messages_available(uint8_t channel) const
+{
+    return communicator::m_engine.messages_available(channel);
+}
+message* communicator::receive(uint16_t id)
+{
+    return communicator::m_engine.take(-1, id);
+}
+message* communicator::receive(uint8_t channel, uint16_t id)
+{
+    return communicator::m_engine.take(channel, id);
+}
 
-    // Return the read message.
-    return output;
+const latency_histogram* communicator::latency(latency_metric metric) const
+{
+    return communicator::m_engine.p_latency().histogram(metric);
+}
+const latency_histogram* communicator::latency(latency_metric metric, uint8_t priority) const
+{
+    return communicator::m_engine.p_latency().histogram_by_priority(metric, priority);
+}
+const latency_histogram* communicator::latency_by_id(latency_metric metric, uint16_t id) const
+{
+    return communicator::m_engine.p_latency().histogram_by_id(metric, id);
+}
+void communicator::reset_delta()
+{
+    communicator::m_engine.reset_delta();
 }
 
 // PUBLIC PROPERTIES
 uint16_t communicator::p_queue_size()
 {
-    return communicator::m_queue_size;
+    return communicator::m_engine.p_queue_size();
 }
 void communicator::p_queue_size(uint16_t value)
 {
-    // Check if a resize is necessary.
-    if(value != communicator::m_queue_size)
-    {
-        // Resize the queues.
-        // Create new queues.
-        utility::outbound** new_tx = new utility::outbound*[value];
-        utility::inbound** new_rx = new utility::inbound*[value];
-
-        // Copy current queues into new queues.
-        for(uint16_t i = 0; i < communicator::m_queue_size; i++)
-        {
-            new_tx[i] = communicator::m_tx_queue[i];
-            new_rx[i] = communicator::m_rx_queue[i];
-        }
-
-        // Fill any remaining space with nullptrs.
-        for(uint16_t i = communicator::m_queue_size; i < value; i++)
-        {
-            new_tx[i] = nullptr;
-            new_rx[i] = nullptr;
-        }
-
-        // Delete old queues and replace them.
-        delete [] communicator::m_tx_queue;
-        delete [] communicator::m_rx_queue;
-        communicator::m_tx_queue = new_tx;
-        communicator::m_rx_queue = new_rx;
-
-        // Update the queue size variable.
-        communicator::m_queue_size = value;
-    }
+    communicator::m_engine.p_queue_size(value);
+}
+serial_communicator::queue_mode communicator::p_queue_mode() const
+{
+    return communicator::m_engine.p_queue_mode();
+}
+void communicator::p_queue_mode(serial_communicator::queue_mode value)
+{
+    communicator::m_engine.p_queue_mode(value);
+}
+uint32_t communicator::p_queue_memory_limit() const
+{
+    return communicator::m_engine.p_queue_memory_limit();
+}
+void communicator::p_queue_memory_limit(uint32_t value)
+{
+    communicator::m_engine.p_queue_memory_limit(value);
+}
+serial_communicator::overflow_policy communicator::p_overflow_policy() const
+{
+    return communicator::m_engine.p_overflow_policy();
+}
+void communicator::p_overflow_policy(serial_communicator::overflow_policy value)
+{
+    communicator::m_engine.p_overflow_policy(value);
 }
 uint32_t communicator::p_receipt_timeout()
 {
-    return communicator::m_receipt_timeout;
+    return communicator::m_engine.p_receipt_timeout();
 }
 void communicator::p_receipt_timeout(uint32_t value)
 {
-    communicator::m_receipt_timeout = value;
+    communicator::m_engine.p_receipt_timeout(value);
 }
 uint8_t communicator::p_max_transmissions()
 {
-    return communicator::m_max_transmissions;
+    return communicator::m_engine.p_max_transmissions();
 }
 void communicator::p_max_transmissions(uint8_t value)
 {
-    communicator::m_max_transmissions = value;
+    communicator::m_engine.p_max_transmissions(value);
 }
-
-// PRIVATE METHODS
-void communicator::spin_tx()
+serial_communicator::channel_config communicator::p_channel(uint8_t channel) const
 {
-    // Send the message with the highest priority or age.
-
-    // First, find the message with the highest priority or age.
-    utility::outbound* to_send = nullptr;
-    uint16_t location = 0;
-    for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+    return communicator::m_engine.p_channel(channel);
+}
+void communicator::p_channel(uint8_t channel, const serial_communicator::channel_config& value)
+{
+    communicator::m_engine.p_channel(channel, value);
+}
+statistics communicator::p_statistics() const
+{
+    return communicator::m_engine.p_statistics().snapshot();
+}
+bool communicator::p_latency_by_id() const
+{
+    return communicator::m_engine.p_latency().p_track_ids();
+}
+void communicator::p_latency_by_id(bool value)
+{
+    communicator::m_engine.p_latency().p_track_ids(value);
+}
+bool communicator::p_header_checksum() const
+{
+    return communicator::m_engine.p_header_checksum();
+}
+void communicator::p_header_checksum(bool value)
+{
+    communicator::m_engine.p_header_checksum(value);
+}
+bool communicator::p_compression(uint16_t id) const
+{
+    return communicator::m_engine.p_compression(id);
+}
+void communicator::p_compression(uint16_t id, bool value)
+{
+    communicator::m_engine.p_compression(id, value);
+}
+uint16_t communicator::p_compression_threshold() const
+{
+    return communicator::m_engine.p_compression_threshold();
+}
+void communicator::p_compression_threshold(uint16_t value)
+{
+    communicator::m_engine.p_compression_threshold(value);
+}
+uint32_t communicator::p_ack_delay() const
+{
+    return communicator::m_engine.p_ack_delay();
+}
+void communicator::p_ack_delay(uint32_t value)
+{
+    communicator::m_engine.p_ack_delay(value);
+}
+bool communicator::p_flow_control() const
+{
+    return communicator::m_engine.p_flow_control();
+}
+void communicator::p_flow_control(bool value)
+{
+    communicator::m_engine.p_flow_control(value);
+}
+uint32_t communicator::p_heartbeat_interval() const
+{
+    return communicator::m_engine.p_heartbeat_interval();
+}
+void communicator::p_heartbeat_interval(uint32_t value)
+{
+    communicator::m_engine.p_heartbeat_interval(value);
+}
+bool communicator::p_fail_on_link_down() const
+{
+    return communicator::m_engine.p_fail_on_link_down();
+}
+void communicator::p_fail_on_link_down(bool value)
+{
+    communicator::m_engine.p_fail_on_link_down(value);
+}
+serial_communicator::link_quality communicator::p_link_quality() const
+{
+    return communicator::m_engine.p_link_quality();
+}
+bool communicator::p_negotiation() const
+{
+    return communicator::m_engine.p_negotiation();
+}
+void communicator::p_negotiation(bool value)
+{
+    communicator::m_engine.p_negotiation(value);
+}
+bool communicator::p_negotiated() const
+{
+    return communicator::m_engine.p_negotiated();
+}
+bool communicator::p_delta(uint16_t id) const
+{
+    return communicator::m_engine.p_delta(id);
+}
+void communicator::p_delta(uint16_t id, bool value)
+{
+    communicator::m_engine.p_delta(id, value);
+}
+bool communicator::p_receive_filter() const
+{
+    return communicator::m_engine.p_receive_filter();
+}
+void communicator::p_receive_filter(bool value)
+{
+    communicator::m_engine.p_receive_filter(value);
+}
+bool communicator::p_subscribed(uint16_t id) const
+{
+    return communicator::m_engine.p_subscribed(id);
+}
+void communicator::p_subscribed(uint16_t id, bool value)
+{
+    communicator::m_engine.p_subscribed(id, value);
+}
+uint16_t communicator::p_max_data_length() const
+{
+    return communicator::m_engine.p_max_data_length();
+}
+void communicator::p_max_data_length(uint16_t value)
+{
+    communicator::m_engine.p_max_data_length(value);
+}
+capture* communicator::p_capture() const
+{
+    return communicator::m_capture;
+}
+void communicator::p_capture(capture* value)
+{
+    communicator::m_capture = value;
+}
+std::shared_ptr<decode_pool> communicator::p_decode_pool() const
+{
+    return communicator::m_decode_pool;
+}
+void communicator::p_decode_pool(std::shared_ptr<decode_pool> value)
+{
+    communicator::m_decode_pool = std::move(value);
+}
+spool* communicator::p_spool() const
+{
+    return communicator::m_spool;
+}
+void communicator::p_spool(spool* value)
+{
+    // Messages waiting in the previous spool stay in its file, and are no longer followed here.
+    communicator::drop_spooled();
+    // Queued messages are still sent from memory, so the previous spool no longer needs to recover them.
+    for(auto record = communicator::m_spool_records.begin(); record != communicator::m_spool_records.end(); ++record)
     {
-        // Check if this address has a valid outbound message in it.
-        if(communicator::m_tx_queue[i] != nullptr)
-        {
-            // Get local reference to the current message.
-            utility::outbound* current = communicator::m_tx_queue[i];
-
-            // Check if this outbound is actively awaiting for receipt (e.g. hasn't yet timed out)
-            if(current->p_status() == message_status::VERIFYING && current->timeout_elapsed(communicator::m_receipt_timeout) == false)
-            {
-                // Message timeout hasn't expired for receipt yet, so no need to resend at this time.
-                // Skip this message.
-                continue;
-            }
-
-            // Check if to_send has a value yet.
-            if(to_send == nullptr)
-            {
-                // Update to_send with current value.
-                to_send = current;
-                location = i;
-            }
-            else
-            {
-                // Check if current message has greater priority.
-                if(current->p_message()->p_priority() > to_send->p_message()->p_priority())
-                {
-                    // Update to_send with current value.
-                    to_send = current;
-                    location = i;
-                }
-                // Check if current message has equal priority.
-                else if(current->p_message()->p_priority() == to_send->p_message()->p_priority())
-                {
-                    // Check if current message has older age.
-                    if(current->p_sequence_number() < to_send->p_sequence_number())
-                    {
-                        // Update to_send with current value.
-                        to_send = current;
-                        location = i;
-                    }
-                }
-            }
-        }
+        communicator::m_spool->release(record->second);
     }
+    communicator::m_spool_records.clear();
 
-    // Check that a message was actually found to send.
-    if(to_send == nullptr)
-    {
-        return;
-    }
+    communicator::m_spool = value;
+}
+uint32_t communicator::p_statistics_interval()
+{
+    return communicator::m_statistics_interval;
+}
+void communicator::p_statistics_interval(uint32_t value)
+{
+    communicator::m_statistics_interval = value;
 
-    // At this point, to_send contains the appropriate message to send.
-    // Check if this is the first time the message is being sent.
-    if(to_send->p_n_transmissions() == 0)
+    // Restart the statistics timer with the new interval, or stop it if disabled.
+    if(value > 0)
     {
-        // Message has not been sent yet.
-        // Send the message.
-        communicator::tx(to_send);
-        // Check if receipt is required.
-        if(to_send->p_receipt_required())
-        {
-            // Receipt is required.
-            // Leave in the tx queue and update status.
-            to_send->update_status(message_status::VERIFYING);
-        }
-        else
-        {
-            // Receipt is not required.
-            // Update status to sent and delete from queue.
-            to_send->update_status(message_status::SENT);
-            delete communicator::m_tx_queue[location];
-            communicator::m_tx_queue[location] = nullptr;
-        }
+        communicator::m_statistics_timer->setInterval(static_cast<int>(value));
+        communicator::m_statistics_timer->start();
     }
     else
     {
-        // Message has been sent at least once and has timed out waiting for a receipt.
-        // Check if message can be resent.
-        if(to_send->can_retransmit(communicator::m_max_transmissions))
-        {
-            // Message can be resent.
-            communicator::tx(to_send);
-        }
-        else
-        {
-            // Message has already been sent the maximum number of times.
-            // Update status and delete.
-            to_send->update_status(message_status::NOTRECEIVED);
-            delete communicator::m_tx_queue[location];
-            communicator::m_tx_queue[location] = nullptr;
-        }
+        communicator::m_statistics_timer->stop();
     }
 }
-void communicator::spin_rx()
+
+// PRIVATE METHODS
+bool communicator::spin_rx()
+{
+    return communicator::m_engine.spin_rx();
+}
+void communicator::ingest(const uint8_t* data, uint32_t length, communicator::clock::time_point timestamp)
+{
+    communicator::m_engine.ingest(data, length, timestamp);
+}
+bool communicator::enqueue(message* message, bool receipt_required, message_status* tracker, std::shared_ptr<delivery> delivery, std::vector<uint8_t> extensions)
 {
-    // Pop bytes until the header byte is found.
-    bool header_found = false;
-    while(!communicator::m_serial_buffer.empty() && header_found == false)
+    // Overflow into the spool rather than rejecting or evicting, and stay behind any of the channel's messages already there.
+    // Calls are never spooled, since their correlation does not survive a restart.
+    bool spooled = communicator::m_spool && communicator::m_spool->p_is_open() && extensions.empty();
+    uint8_t channel = message->p_channel();
+    uint32_t length = message->p_message_length();
+    if(spooled && communicator::m_engine.accepts(*message) && communicator::m_engine.fits(channel, length) &&
+       (communicator::m_spool->p_waiting(channel) > 0 || !communicator::m_engine.has_room(channel, length)))
     {
-        if(communicator::m_serial_buffer.front() == communicator::m_header_byte)
+        uint64_t record = communicator::m_spool->append(*message, receipt_required, true);
+        if(record != 0)
         {
-            header_found = true;
-        }
-        else
-        {
-            communicator::m_serial_buffer.pop_front();
+            // Reserve the message's sequence number now, so that its delivery handle can find it once it is queued.
+            communicator::spooled_message entry;
+            entry.sequence_number = communicator::m_engine.reserve();
+            entry.tracker = tracker;
+            entry.delivery = delivery;
+            communicator::m_spooled[record] = entry;
+            if(tracker)
+            {
+                *tracker = message_status::QUEUED;
+            }
+            if(delivery)
+            {
+                delivery->update(message_status::QUEUED);
+            }
+            communicator::m_engine.p_statistics().increment(utility::statistics_tracker::counter::TX_SPOOLED);
+            delete message;
+            return true;
         }
     }
 
-    // Check if header was found.
-    if(!header_found)
+    // Make room in the transmit queue according to the overflow policy.
+    if(!communicator::m_engine.accepts(*message) || !communicator::m_engine.make_room(channel, length, message->p_priority()))
     {
-        // No valid header found, quit.
-        return;
+        communicator::m_engine.p_statistics().increment(utility::statistics_tracker::counter::TX_REJECTED);
+        delete message;
+        return false;
     }
 
-    // Start packet size tracking.
-    // Initialize with 1 header, 4 sequence, 1 receipt, 2 message id, 1 priority, 2 data length.
-    uint32_t packet_length = 11;
-
-    // If this point reached, a valid header has been found.
-    // Message data length is needed.
-    if(communicator::m_serial_buffer.size() < packet_length)
+    // Write receipt-required messages ahead to the spool, so that they are recovered if a restart interrupts them.
+    // The record is released once the engine retires the message.
+    uint32_t sequence_number = communicator::m_engine.reserve();
+    if(spooled && receipt_required)
     {
-        return;
+        uint64_t record = communicator::m_spool->append(*message, true, false);
+        if(record != 0)
+        {
+            communicator::m_spool_records[sequence_number] = record;
+        }
     }
-    // Read bytes 9 and 10 to get the data length.
-    uint8_t data_length_bytes[2];
-    data_length_bytes[0] = communicator::m_serial_buffer[9];
-    data_length_bytes[1] = communicator::m_serial_buffer[10];
-
-    // Extract the data length from the end of packet_front.
-    uint16_t data_length = qFromBigEndian(*reinterpret_cast<uint16_t*>(&data_length_bytes));
-
-    // Finalize packet size with data length and checksum.
-    packet_length += data_length + 1;
 
-    // Check if packet length exists in the buffer.
-    if(communicator::m_serial_buffer.size() < packet_length)
+    communicator::m_engine.admit(message, sequence_number, receipt_required, tracker, delivery, std::move(extensions));
+    return true;
+}
+void communicator::drain_spool()
+{
+    // A spool that closed after failing to map its file again has lost its waiting records.
+    if(communicator::m_spool && !communicator::m_spool->p_is_open() && !communicator::m_spooled.empty())
     {
-        return;
+        communicator::drop_spooled();
     }
-
-    // Create packet array.
-    uint8_t* packet = new uint8_t[packet_length];
-    // Read packet from buffer.
-    for(uint32_t i = 0; i < packet_length; ++i)
+    if(!communicator::m_spool || communicator::m_spool->p_waiting() == 0)
     {
-        packet[i] = communicator::m_serial_buffer.front();
-        communicator::m_serial_buffer.pop_front();
+        return;
     }
 
-    // If this point is reached, a full packet has been read.
-
-    // Validate the checksum.
-    bool checksum_ok = packet[packet_length-1] == communicator::checksum(packet, packet_length-1);
-    // Extract sequence number from the packet.
-    uint32_t sequence_number = qFromBigEndian(*reinterpret_cast<uint32_t*>(&packet[1]));
-
-    // Handle receipts
-    switch(static_cast<communicator::receipt_type>(packet[5]))
-    {
-    case communicator::receipt_type::NOT_REQUIRED:
-    {
-        // Do nothing
-        break;
-    }
-    case communicator::receipt_type::REQUIRED:
+    // Take each channel's waiting records, highest priority and oldest first, while its queue has room.
+    for(uint16_t channel = 0; channel <= 0xFF; channel++)
     {
-        // Draft and send a receipt message outside of the typical outbound/tx_queue.
-        // Receipt messages do not need to be tracked.
-        uint8_t receipt[12];
-        // Copy header(1), sequence(4), receipt(1), id(2), and priority(1) back into receipt.  Then add zero data length (2) and checksum (1).
-        std::memcpy(receipt, packet, 9);
-        // Update the receipt field.
-        if(checksum_ok)
-        {
-            receipt[5] = static_cast<uint8_t>(communicator::receipt_type::RECEIVED);
-        }
-        else
+        uint32_t length;
+        while(communicator::m_spool->peek(static_cast<uint8_t>(channel), length) && communicator::m_engine.has_room(static_cast<uint8_t>(channel), length))
         {
-            receipt[5] = static_cast<uint8_t>(communicator::receipt_type::CHECKSUM_MISMATCH);
-        }
-        // No data fields.
-        receipt[9] = 0;
-        receipt[10] = 0;
-        // Set checksum.
-        receipt[11] = communicator::checksum(receipt, 11);
-        // Write message.
-        communicator::tx(receipt, 12);
-        break;
-    }
-    case communicator::receipt_type::RECEIVED:
-    {
-        // If checksum is ok, remove the associated message from the TXQ if it is still in there.
-        if(checksum_ok)
-        {
-            for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+            uint64_t record;
+            bool receipt_required;
+            message* message = communicator::m_spool->take(static_cast<uint8_t>(channel), record, receipt_required);
+
+            // Messages spooled by this communicator keep their handles, and recovered messages get a new sequence number.
+            uint32_t sequence_number;
+            message_status* tracker = nullptr;
+            std::shared_ptr<delivery> delivery;
+            auto spooled = communicator::m_spooled.find(record);
+            if(spooled != communicator::m_spooled.end())
             {
-                if(communicator::m_tx_queue[i] != nullptr)
-                {
-                    utility::outbound* current = communicator::m_tx_queue[i];
-                    if(current->p_sequence_number() == sequence_number)
-                    {
-                        // Update the message's status.
-                        current->update_status(message_status::RECEIVED);
-                        // Remove it from the queue.
-                        delete communicator::m_tx_queue[i];
-                        communicator::m_tx_queue[i] = nullptr;
-                        // Quit the for loop.
-                        break;
-                    }
-                }
+                sequence_number = spooled->second.sequence_number;
+                tracker = spooled->second.tracker;
+                delivery = spooled->second.delivery;
+                communicator::m_spooled.erase(spooled);
             }
-        }
-        break;
-    }
-    case communicator::receipt_type::CHECKSUM_MISMATCH:
-    {
-        // Find the associated message based on sequence number and immediately resend it.
-        if(checksum_ok)
-        {
-            for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+            else
             {
-                if(communicator::m_tx_queue[i] != nullptr)
-                {
-                    utility::outbound* current = communicator::m_tx_queue[i];
-                    if(current->p_sequence_number() == sequence_number)
-                    {
-                        // Check if message can be resent.
-                        if(current->can_retransmit(communicator::m_max_transmissions))
-                        {
-                            // Message can be resent.
-                            communicator::tx(current);
-                        }
-                        else
-                        {
-                            // Message has already been sent the maximum number of times.
-                            // Update status and delete.
-                            current->update_status(message_status::NOTRECEIVED);
-                            delete communicator::m_tx_queue[i];
-                            communicator::m_tx_queue[i] = nullptr;
-                        }
-                        // Quit the for loop.
-                        break;
-                    }
-                }
+                sequence_number = communicator::m_engine.reserve();
             }
+            // Remember the message's spool record, so that it is released once the message is retired.
+            communicator::m_spool_records[sequence_number] = record;
+            communicator::m_engine.admit(message, sequence_number, receipt_required, tracker, delivery, std::vector<uint8_t>());
         }
-        break;
     }
-    }
-
-    // Lastly, put packet into inbound message in the rx_queue.
-    if(checksum_ok)
+}
+void communicator::drop_spooled()
+{
+    // Report every message waiting in the spool as dropped.
+    for(auto spooled = communicator::m_spooled.begin(); spooled != communicator::m_spooled.end(); ++spooled)
     {
-        // Find an open position in the RXQ.
-        for(uint16_t i = 0; i < communicator::m_queue_size; i++)
+        if(spooled->second.tracker)
         {
-            if(communicator::m_rx_queue[i] == nullptr)
-            {
-                // Extract the message from the packet.
-                message* msg = new message(&packet[6]);
-                // Add new inbound to the rx_queue.
-                communicator::m_rx_queue[i] = new utility::inbound(msg, sequence_number);
-
-                // Exit for loop.
-                break;
-            }
+            *spooled->second.tracker = message_status::DROPPED;
         }
-    }
-
-    // Delete the packet.
-    delete [] packet;
-}
-void communicator::tx(utility::outbound* message)
-{
-    // Serialize the packet without escapes.
-    // First, get total packet length = message length + 7 (1 header, 4 sequence, 1 receipt, 1 checksum)
-    uint32_t packet_size = message->p_message()->p_message_length() + 7;
-    // Create packet.
-    uint8_t* packet = new uint8_t[packet_size];
-    // Write the header, sequence, and receipt.
-    packet[0] = communicator::m_header_byte;
-    uint32_t be_sequence = qToBigEndian(message->p_sequence_number());
-    std::memcpy(&packet[1], &be_sequence, 4);
-    packet[5] = message->p_receipt_required();
-    // Write the message bytes.
-    message->p_message()->serialize(&packet[6]);
-    // Calculate and add CRC.
-    packet[packet_size-1] = communicator::checksum(packet, packet_size - 1);
-
-    // Write to the serial port.
-    communicator::tx(packet, packet_size);
-
-    // Mark that the message has been sent.
-    message->mark_transmitted();
-
-    // Delete the packet.
-    delete [] packet;
-}
-void communicator::tx(uint8_t* buffer, uint32_t length)
-{
-    // Check if escapes are needed.
-    uint32_t n_escapes = 0;
-    // Only check after the header.
-    for(uint32_t i = 1; i < length; i++)
-    {
-        if(buffer[i] == communicator::m_header_byte || buffer[i] == communicator::m_escape_byte)
+        if(spooled->second.delivery)
         {
-            n_escapes++;
+            spooled->second.delivery->update(message_status::DROPPED);
         }
     }
-
-    // Handle escapes.
-    if(n_escapes > 0)
-    {
-        // Escapes needed.
-        uint8_t* esc_buffer = new uint8_t[length + n_escapes];
-        uint32_t esc_write_position = 0;
-        // Copy the header byte first since it should not be escaped.
-        esc_buffer[esc_write_position++] = buffer[0];
-        // Only check after the header.
-        for(uint32_t i = 1; i < length; i++)
-        {
-            if(buffer[i] == communicator::m_header_byte || buffer[i] == communicator::m_escape_byte)
-            {
-                // Insert escape.
-                esc_buffer[esc_write_position++] = communicator::m_escape_byte;
-                // Copy in byte decremented by one.
-                esc_buffer[esc_write_position++] = buffer[i] - 1;
-            }
-            else
-            {
-                // Copy buffer byte in.
-                esc_buffer[esc_write_position++] = buffer[i];
-            }
-        }
-
-        // Write the escaped buffer.
-        communicator::m_serial_port->write((char*)esc_buffer, length + n_escapes);
-        // Delete the escaped buffer.
-        delete [] esc_buffer;
-    }
-    else
+    communicator::m_spooled.clear();
+}
+bool communicator::finish_call(uint32_t correlation, reply_status status, message* response)
+{
+    // Find the call.
+    auto call = communicator::m_pending_calls.find(correlation);
+    if(call == communicator::m_pending_calls.end())
     {
-        // Escapes not needed.  Write buffer as is.
-        communicator::m_serial_port->write((char*)buffer, length);
+        delete response;
+        return false;
     }
-    // Since writing is asynchronous, wait for the bytes to begin writing.
-    communicator::m_serial_port->waitForBytesWritten(-1);
+
+    // Stop tracking the call before completing it, since completion may start new calls.
+    std::shared_ptr<reply> handle = call->second.reply;
+    communicator::m_call_deadlines.erase(call->second.deadline);
+    communicator::m_pending_calls.erase(call);
+    handle->complete(status, response);
+    return true;
 }
-uint8_t communicator::checksum(uint8_t* data, uint32_t length)
+void communicator::expire_calls()
 {
-    uint8_t checksum = 0;
-    for(uint32_t i = 0 ; i < length; i++)
+    // Deadlines are ordered, so only the earliest need checking.
+    communicator::clock::time_point now = communicator::clock::now();
+    while(!communicator::m_call_deadlines.empty() && communicator::m_call_deadlines.begin()->first <= now)
     {
-        checksum ^= data[i];
+        communicator::finish_call(communicator::m_call_deadlines.begin()->second, reply_status::TIMED_OUT, nullptr);
     }
-    return checksum;
 }
 uint64_t communicator::serial_read(uint8_t *buffer, uint32_t length, uint32_t timeout_ms)
 {
@@ -595,7 +568,7 @@ uint64_t communicator::serial_read(uint8_t *buffer, uint32_t length, uint32_t ti
     // Grab starting timestamp.
     uint64_t start_time = QDateTime::currentMSecsSinceEpoch();
     // Initialize bytes_available.
-    uint64_t bytes_available = communicator::m_serial_port->bytesAvailable();
+    uint64_t bytes_available = communicator::m_device->bytesAvailable();
     // Wait while checking timeout.
     while(bytes_available < length)
     {
@@ -610,40 +583,138 @@ uint64_t communicator::serial_read(uint8_t *buffer, uint32_t length, uint32_t ti
         QThread::usleep(100);
 
         // Update bytes available.
-        bytes_available = communicator::m_serial_port->bytesAvailable();
+        bytes_available = communicator::m_device->bytesAvailable();
     }
 
     // If this point is reached, either enough bytes are available or timeout has occured.
     // Read the smaller of length or bytes_available and return bytes read.
-    return communicator::m_serial_port->read((char*)(buffer), qMin(static_cast<uint64_t>(length), bytes_available));
+    return communicator::m_device->read((char*)(buffer), qMin(static_cast<uint64_t>(length), bytes_available));
+}
+
+// ENGINE HOST
+void communicator::engine_host::write(const uint8_t* data, uint32_t length)
+{
+    // Write the escaped packet.
+    engine_host::owner->m_device->write(reinterpret_cast<const char*>(data), length);
+    // Capture the escaped packet.
+    if(engine_host::owner->m_capture)
+    {
+        engine_host::owner->m_capture->record(capture::direction::TX, data, length);
+    }
+    // The device buffers the write and drains it from the event loop.
+    // Serial ports can fall far behind the engine, so once the backlog is large give the port a bounded chance to drain.
+    QSerialPort* serial_port = qobject_cast<QSerialPort*>(engine_host::owner->m_device);
+    if(serial_port && serial_port->bytesToWrite() > communicator::m_write_backlog)
+    {
+        serial_port->waitForBytesWritten(communicator::m_write_timeout);
+    }
+}
+void communicator::engine_host::wake(uint32_t milliseconds)
+{
+    // Keep the earliest of the requested wake ups.
+    QTimer* timer = engine_host::owner->m_wake_timer;
+    if(!timer->isActive() || timer->remainingTime() > static_cast<int>(milliseconds))
+    {
+        timer->start(static_cast<int>(milliseconds));
+    }
+}
+void communicator::engine_host::link_changed(const serial_communicator::link_quality& quality)
+{
+    emit engine_host::owner->link_changed(quality.up);
+    emit engine_host::owner->link_quality_updated(quality);
+}
+void communicator::engine_host::link_quality_updated(const serial_communicator::link_quality& quality)
+{
+    emit engine_host::owner->link_quality_updated(quality);
+}
+bool communicator::engine_host::correlated(bool response, uint32_t correlation, const uint8_t* bytes, uint8_t channel, bool receipt_required, communicator::clock::time_point arrival)
+{
+    if(response)
+    {
+        // Responses that arrive after their call has finished are discarded.
+        message* reply = new message(bytes);
+        reply->p_receive_timestamp(arrival);
+        if(!engine_host::owner->finish_call(correlation, reply_status::RECEIVED, reply))
+        {
+            engine_host::owner->m_engine.p_statistics().increment(utility::statistics_tracker::counter::RX_UNMATCHED_RESPONSES);
+        }
+        return true;
+    }
+
+    // Requests without a handler are queued like any other message.
+    auto handler = engine_host::owner->m_handlers.find(utility::load_big_endian<uint16_t>(bytes));
+    if(handler == engine_host::owner->m_handlers.end())
+    {
+        return false;
+    }
+    // Answer the request on its channel, with the same receipt requirement it was sent with.
+    message request(bytes);
+    request.p_channel(channel);
+    request.p_receive_timestamp(arrival);
+    message* answer = handler->second(request);
+    if(answer)
+    {
+        answer->p_channel(channel);
+        engine_host::owner->enqueue(answer, receipt_required, nullptr, nullptr, engine::correlation_entry(engine::call_kind::RESPONSE, correlation));
+    }
+    return true;
+}
+void communicator::engine_host::retired(uint32_t sequence_number)
+{
+    // Release the message's spool record, since it no longer needs to be recovered.
+    auto record = engine_host::owner->m_spool_records.find(sequence_number);
+    if(record != engine_host::owner->m_spool_records.end())
+    {
+        engine_host::owner->m_spool->release(record->second);
+        engine_host::owner->m_spool_records.erase(record);
+    }
+}
+bool communicator::engine_host::offloads() const
+{
+    return engine_host::owner->m_decode_pool != nullptr;
+}
+bool communicator::engine_host::submit(std::function<void()> work)
+{
+    return engine_host::owner->m_decode_pool && engine_host::owner->m_decode_pool->submit(std::move(work));
+}
+void communicator::engine_host::decoded()
+{
+    // Have the communicator's thread collect the frame, unless a collection is already on its way.
+    communicator* owner = engine_host::owner;
+    if(!owner->m_collect_pending.exchange(true))
+    {
+        QMetaObject::invokeMethod(owner, [owner]() { owner->m_collect_pending.store(false); owner->m_engine.collect(); }, Qt::QueuedConnection);
+    }
 }
 
 // PRIVATE SLOTS
 void communicator::timer()
 {
-    communicator::spin_tx();
-    communicator::spin_rx();
+    communicator::expire_calls();
+    // Refill the transmit queues from the spool.
+    communicator::drain_spool();
+    communicator::m_engine.poll();
 }
 void communicator::data_ready()
 {
+    // Timestamp the data before reading it, as close as possible to its arrival.
+    communicator::clock::time_point timestamp = communicator::clock::now();
+
     // Read the new data from the port.
-    QByteArray new_data = communicator::m_serial_port->readAll();
+    QByteArray new_data = communicator::m_device->readAll();
 
-    // Add to the internal buffer, handling escapes.
-    for(auto current_byte = new_data.cbegin(); current_byte != new_data.cend(); ++current_byte)
+    // Capture the raw data.
+    if(communicator::m_capture)
     {
-        // Check for escape byte.
-        if(*current_byte == communicator::m_escape_byte)
-        {
-            // Mark next byte as escaped.
-            communicator::m_escape_next = true;
-        }
-        else
-        {
-            // Add byte to buffer with escape.
-            communicator::m_serial_buffer.push_back(*current_byte + static_cast<uint8_t>(communicator::m_escape_next));
-            // Mark next byte as not escaped.
-            communicator::m_escape_next = false;
-        }
+        communicator::m_capture->record(capture::direction::RX, reinterpret_cast<const uint8_t*>(new_data.constData()), static_cast<uint32_t>(new_data.size()));
     }
+
+    // Add the raw data to the internal buffer.
+    communicator::ingest(reinterpret_cast<const uint8_t*>(new_data.constData()), static_cast<uint32_t>(new_data.size()), timestamp);
+}
+void communicator::statistics_timer()
+{
+    // Close the rate interval and publish the latest statistics.
+    communicator::m_engine.p_statistics().sample();
+    emit statistics_updated(communicator::m_engine.p_statistics().snapshot());
 }
@@ -0,0 +1,91 @@
+#include "pcd/qt-serial_communicator/decode_pool.h"
+
+#include <algorithm>
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+decode_pool::decode_pool(uint32_t n_threads, uint32_t capacity)
+    : m_tasks(capacity)
+{
+    // Store locals.
+    decode_pool::m_n_tasks.store(0);
+    decode_pool::m_n_idle.store(0);
+    decode_pool::m_stop.store(false);
+
+    // Start the workers.
+    if(n_threads == 0)
+    {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for(uint32_t i = 0; i < n_threads; i++)
+    {
+        decode_pool::m_workers.push_back(std::thread(&decode_pool::worker, this));
+    }
+}
+decode_pool::~decode_pool()
+{
+    // Instruct the workers to finish the waiting tasks and exit.
+    {
+        std::lock_guard<std::mutex> lock(decode_pool::m_mutex);
+        decode_pool::m_stop.store(true);
+    }
+    decode_pool::m_condition.notify_all();
+    for(auto worker = decode_pool::m_workers.begin(); worker != decode_pool::m_workers.end(); ++worker)
+    {
+        worker->join();
+    }
+}
+
+// METHODS
+bool decode_pool::submit(std::function<void()> task)
+{
+    // Count the task only once it is queued, so that sleeping workers never wake for a task that was refused.
+    if(!decode_pool::m_tasks.push(std::move(task)))
+    {
+        return false;
+    }
+    decode_pool::m_n_tasks.fetch_add(1);
+
+    // Only take the lock to wake a worker if one is asleep.
+    // A worker counts itself idle before checking for tasks, so either it sees this task or it is seen here.
+    if(decode_pool::m_n_idle.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(decode_pool::m_mutex);
+        decode_pool::m_condition.notify_one();
+    }
+    return true;
+}
+
+// PROPERTIES
+uint32_t decode_pool::p_threads() const
+{
+    return static_cast<uint32_t>(decode_pool::m_workers.size());
+}
+
+// PRIVATE METHODS
+void decode_pool::worker()
+{
+    std::function<void()> task;
+    while(true)
+    {
+        // Run tasks for as long as there are any.
+        if(decode_pool::m_tasks.pop(task))
+        {
+            decode_pool::m_n_tasks.fetch_sub(1);
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        // Sleep until a task arrives, or exit once stopped with nothing left to do.
+        std::unique_lock<std::mutex> lock(decode_pool::m_mutex);
+        decode_pool::m_n_idle.fetch_add(1);
+        decode_pool::m_condition.wait(lock, [this]{return decode_pool::m_n_tasks.load() > 0 || decode_pool::m_stop.load();});
+        decode_pool::m_n_idle.fetch_sub(1);
+        if(decode_pool::m_n_tasks.load() <= 0 && decode_pool::m_stop.load())
+        {
+            break;
+        }
+    }
+}
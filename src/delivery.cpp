@@ -0,0 +1,89 @@
+#include "pcd/qt-serial_communicator/delivery.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+delivery::delivery(uint32_t sequence_number)
+{
+    delivery::m_sequence_number = sequence_number;
+    delivery::m_status = message_status::QUEUED;
+    delivery::m_future = delivery::m_promise.get_future().share();
+}
+
+// METHODS
+message_status delivery::wait() const
+{
+    return delivery::m_future.get();
+}
+void delivery::on_complete(std::function<void(message_status)> callback)
+{
+    // Invoke immediately if already complete, otherwise hold until completion.
+    message_status status;
+    {
+        std::lock_guard<std::mutex> lock(delivery::m_mutex);
+        status = delivery::m_status;
+        if(!delivery::is_final(status))
+        {
+            delivery::m_callbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(status);
+}
+void delivery::update(message_status status)
+{
+    // Store the new status, and take the callbacks if it is final.
+    bool final = delivery::is_final(status);
+    std::vector<std::function<void(message_status)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(delivery::m_mutex);
+        // A completed delivery never changes.
+        if(delivery::is_final(delivery::m_status))
+        {
+            return;
+        }
+        delivery::m_status = status;
+        if(final)
+        {
+            callbacks.swap(delivery::m_callbacks);
+        }
+    }
+
+    // Publish the change outside of the lock.
+    emit status_changed(status);
+    if(final)
+    {
+        delivery::m_promise.set_value(status);
+        for(auto& callback : callbacks)
+        {
+            callback(status);
+        }
+        emit completed(status);
+    }
+}
+
+// PROPERTIES
+uint32_t delivery::p_sequence_number() const
+{
+    return delivery::m_sequence_number;
+}
+message_status delivery::p_status() const
+{
+    std::lock_guard<std::mutex> lock(delivery::m_mutex);
+    return delivery::m_status;
+}
+bool delivery::p_complete() const
+{
+    std::lock_guard<std::mutex> lock(delivery::m_mutex);
+    return delivery::is_final(delivery::m_status);
+}
+std::shared_future<message_status> delivery::p_future() const
+{
+    return delivery::m_future;
+}
+
+// PRIVATE METHODS
+bool delivery::is_final(message_status status)
+{
+    return status == message_status::SENT || status == message_status::RECEIVED || status == message_status::NOTRECEIVED || status == message_status::CANCELLED || status == message_status::DROPPED;
+}
@@ -0,0 +1,101 @@
+#include "pcd/qt-serial_communicator/utility/delta.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint32_t serial_communicator::utility::delta_encode(const uint8_t* base, uint32_t base_length, const uint8_t* data, uint32_t length, uint8_t* destination, uint32_t capacity)
+{
+    // Treat the base as zero beyond its length.
+    auto difference = [&](uint32_t i) -> uint8_t { return i < base_length ? data[i] ^ base[i] : data[i]; };
+
+    uint32_t written = 0;
+    uint32_t position = 0;
+    while(position < length)
+    {
+        // Count unchanged bytes.
+        uint32_t n_unchanged = 0;
+        while(position < length && n_unchanged < 255 && difference(position) == 0)
+        {
+            n_unchanged++;
+            position++;
+        }
+        // Trailing unchanged bytes are implied.
+        if(position == length)
+        {
+            break;
+        }
+
+        // Count changed bytes, absorbing single unchanged bytes since a new run would cost more.
+        uint32_t start = position;
+        uint32_t n_changed = 0;
+        while(position < length && n_changed < 255)
+        {
+            if(difference(position) == 0 && (position + 1 == length || difference(position + 1) == 0))
+            {
+                break;
+            }
+            n_changed++;
+            position++;
+        }
+
+        // Write the run.
+        if(capacity - written < 2 + n_changed)
+        {
+            return 0;
+        }
+        destination[written++] = static_cast<uint8_t>(n_unchanged);
+        destination[written++] = static_cast<uint8_t>(n_changed);
+        for(uint32_t i = start; i < start + n_changed; i++)
+        {
+            destination[written++] = difference(i);
+        }
+    }
+
+    // An identical payload still needs one run so that the diff is not empty.
+    if(written == 0)
+    {
+        if(capacity < 2)
+        {
+            return 0;
+        }
+        destination[written++] = 0;
+        destination[written++] = 0;
+    }
+    return written;
+}
+bool serial_communicator::utility::delta_decode(const uint8_t* base, uint32_t base_length, const uint8_t* diff, uint32_t diff_length, uint8_t* destination, uint32_t length)
+{
+    // Start from the base, resized to the data length.
+    uint32_t n_copied = std::min(base_length, length);
+    if(n_copied > 0)
+    {
+        std::memcpy(destination, base, n_copied);
+    }
+    if(length > n_copied)
+    {
+        std::memset(destination + n_copied, 0, length - n_copied);
+    }
+
+    // Apply each run.
+    uint32_t position = 0;
+    uint32_t read = 0;
+    while(read < diff_length)
+    {
+        if(diff_length - read < 2)
+        {
+            return false;
+        }
+        uint32_t n_unchanged = diff[read++];
+        uint32_t n_changed = diff[read++];
+        if(diff_length - read < n_changed || length - position < n_unchanged + n_changed)
+        {
+            return false;
+        }
+        position += n_unchanged;
+        for(uint32_t i = 0; i < n_changed; i++)
+        {
+            destination[position++] ^= diff[read++];
+        }
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#include "pcd/qt-serial_communicator/utility/delta_cache.h"
+
+using namespace serial_communicator::utility;
+
+// CONSTRUCTORS
+delta_cache::delta_cache(uint8_t depth)
+{
+    delta_cache::m_depth = depth;
+}
+
+// METHODS
+void delta_cache::store(uint16_t id, uint32_t sequence_number, const uint8_t* data, uint16_t length)
+{
+    std::deque<entry>& entries = delta_cache::m_entries[id];
+
+    // Evict the oldest payload if the ID is full.
+    if(entries.size() >= delta_cache::m_depth)
+    {
+        entries.pop_front();
+    }
+    entry new_entry;
+    new_entry.sequence_number = sequence_number;
+    new_entry.data.assign(data, data + length);
+    entries.push_back(std::move(new_entry));
+}
+const std::vector<uint8_t>* delta_cache::find(uint16_t id, uint32_t sequence_number) const
+{
+    auto entries = delta_cache::m_entries.find(id);
+    if(entries == delta_cache::m_entries.end())
+    {
+        return nullptr;
+    }
+    for(const entry& current : entries->second)
+    {
+        if(current.sequence_number == sequence_number)
+        {
+            return &current.data;
+        }
+    }
+    return nullptr;
+}
+const std::vector<uint8_t>* delta_cache::latest(uint16_t id, uint32_t& sequence_number) const
+{
+    auto entries = delta_cache::m_entries.find(id);
+    if(entries == delta_cache::m_entries.end() || entries->second.empty())
+    {
+        return nullptr;
+    }
+    sequence_number = entries->second.back().sequence_number;
+    return &entries->second.back().data;
+}
+void delta_cache::erase(uint16_t id)
+{
+    delta_cache::m_entries.erase(id);
+}
+void delta_cache::clear()
+{
+    delta_cache::m_entries.clear();
+}
@@ -0,0 +1,18 @@
+#include "pcd/qt-serial_communicator/utility/emulated_device.h"
+#include "pcd/qt-serial_communicator/emulated_link.h"
+
+using namespace serial_communicator::utility;
+
+// CONSTRUCTORS
+emulated_device::emulated_device(emulated_link* link, uint32_t direction)
+{
+    emulated_device::m_link = link;
+    emulated_device::m_direction = direction;
+}
+
+// QIODEVICE OVERRIDES
+qint64 emulated_device::writeData(const char* data, qint64 length)
+{
+    emulated_device::m_link->transmit(emulated_device::m_direction, reinterpret_cast<const uint8_t*>(data), static_cast<uint32_t>(length));
+    return length;
+}
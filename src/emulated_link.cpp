@@ -0,0 +1,170 @@
+#include "pcd/qt-serial_communicator/emulated_link.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+emulated_link::emulated_link(uint32_t seed)
+    : m_random(seed)
+{
+    // Create and open both ends.  Each end writes into the direction of its own index.
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        emulated_link::m_ends[i] = new utility::emulated_device(this, i);
+        emulated_link::m_ends[i]->open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+        emulated_link::m_line_free[i] = std::chrono::steady_clock::now();
+        emulated_link::m_in_burst[i] = false;
+    }
+
+    // Initialize an unimpaired link.
+    emulated_link::m_baud = 0;
+    emulated_link::m_latency = 0;
+    emulated_link::m_bit_error_rate = 0;
+    emulated_link::m_drop_rate = 0;
+    emulated_link::m_burst_enter = 0;
+    emulated_link::m_burst_exit = 1;
+
+    // Set up the delivery timer.
+    emulated_link::m_timer = new QTimer();
+    emulated_link::connect(emulated_link::m_timer, &QTimer::timeout, this, &emulated_link::deliver);
+    emulated_link::m_timer->setInterval(1);
+    emulated_link::m_timer->start();
+}
+emulated_link::~emulated_link()
+{
+    emulated_link::m_timer->stop();
+    delete emulated_link::m_timer;
+    delete emulated_link::m_ends[0];
+    delete emulated_link::m_ends[1];
+}
+
+// METHODS
+void emulated_link::transmit(uint32_t direction, const uint8_t* data, uint32_t length)
+{
+    // Apply byte impairments.
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    QByteArray carried;
+    carried.reserve(static_cast<int>(length));
+    for(uint32_t i = 0; i < length; i++)
+    {
+        // Update the burst state.
+        if(emulated_link::m_burst_enter > 0)
+        {
+            if(emulated_link::m_in_burst[direction])
+            {
+                emulated_link::m_in_burst[direction] = uniform(emulated_link::m_random) >= emulated_link::m_burst_exit;
+            }
+            else
+            {
+                emulated_link::m_in_burst[direction] = uniform(emulated_link::m_random) < emulated_link::m_burst_enter;
+            }
+        }
+
+        // Drop the byte if in a burst or randomly dropped.
+        if(emulated_link::m_in_burst[direction] || (emulated_link::m_drop_rate > 0 && uniform(emulated_link::m_random) < emulated_link::m_drop_rate))
+        {
+            continue;
+        }
+
+        // Flip bits randomly.
+        uint8_t byte = data[i];
+        if(emulated_link::m_bit_error_rate > 0)
+        {
+            for(uint8_t bit = 0; bit < 8; bit++)
+            {
+                if(uniform(emulated_link::m_random) < emulated_link::m_bit_error_rate)
+                {
+                    byte ^= static_cast<uint8_t>(1 << bit);
+                }
+            }
+        }
+        carried.append(static_cast<char>(byte));
+    }
+
+    // Serialize the whole write behind anything still on the line, then add the propagation latency.
+    // Dropped bytes still occupied the line.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point start = emulated_link::m_line_free[direction] > now ? emulated_link::m_line_free[direction] : now;
+    if(emulated_link::m_baud > 0)
+    {
+        emulated_link::m_line_free[direction] = start + std::chrono::nanoseconds(static_cast<uint64_t>(length) * 10000000000ULL / emulated_link::m_baud);
+    }
+    else
+    {
+        emulated_link::m_line_free[direction] = start;
+    }
+    if(!carried.isEmpty())
+    {
+        in_flight block;
+        block.due = emulated_link::m_line_free[direction] + std::chrono::microseconds(emulated_link::m_latency);
+        block.data = carried;
+        emulated_link::m_in_flight[direction].push_back(block);
+    }
+}
+
+// PROPERTIES
+QIODevice* emulated_link::p_a() const
+{
+    return emulated_link::m_ends[0];
+}
+QIODevice* emulated_link::p_b() const
+{
+    return emulated_link::m_ends[1];
+}
+uint32_t emulated_link::p_baud() const
+{
+    return emulated_link::m_baud;
+}
+void emulated_link::p_baud(uint32_t value)
+{
+    emulated_link::m_baud = value;
+}
+uint32_t emulated_link::p_latency() const
+{
+    return emulated_link::m_latency;
+}
+void emulated_link::p_latency(uint32_t value)
+{
+    emulated_link::m_latency = value;
+}
+double emulated_link::p_bit_error_rate() const
+{
+    return emulated_link::m_bit_error_rate;
+}
+void emulated_link::p_bit_error_rate(double value)
+{
+    emulated_link::m_bit_error_rate = value;
+}
+double emulated_link::p_drop_rate() const
+{
+    return emulated_link::m_drop_rate;
+}
+void emulated_link::p_drop_rate(double value)
+{
+    emulated_link::m_drop_rate = value;
+}
+void emulated_link::p_burst(double& enter, double& exit) const
+{
+    enter = emulated_link::m_burst_enter;
+    exit = emulated_link::m_burst_exit;
+}
+void emulated_link::p_burst(double enter, double exit)
+{
+    emulated_link::m_burst_enter = enter;
+    emulated_link::m_burst_exit = exit;
+}
+
+// PRIVATE SLOTS
+void emulated_link::deliver()
+{
+    // Deliver every block whose arrival time has passed to the opposite end.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for(uint32_t direction = 0; direction < 2; direction++)
+    {
+        std::deque<in_flight>& queue = emulated_link::m_in_flight[direction];
+        while(!queue.empty() && queue.front().due <= now)
+        {
+            emulated_link::m_ends[1 - direction]->deliver(queue.front().data);
+            queue.pop_front();
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include "pcd/qt-serial_communicator/latency_histogram.h"
+
+using namespace serial_communicator;
+
+namespace {
+// BIT SCANNING
+uint32_t highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+    // Halve the search window until the highest set bit is isolated.
+    uint32_t position = 0;
+    for(uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+        if(value >> shift)
+        {
+            value >>= shift;
+            position += shift;
+        }
+    }
+    return position;
+#endif
+}
+}
+
+// CONSTRUCTORS
+latency_histogram::latency_histogram()
+{
+    latency_histogram::reset();
+}
+
+// METHODS
+void latency_histogram::record(uint64_t microseconds)
+{
+    latency_histogram::m_buckets[latency_histogram::bucket_index(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    latency_histogram::m_count.fetch_add(1, std::memory_order_relaxed);
+    latency_histogram::m_sum.fetch_add(microseconds, std::memory_order_relaxed);
+
+    // Raise the maximum, retrying if another thread raced the update.
+    uint64_t observed = latency_histogram::m_max.load(std::memory_order_relaxed);
+    while(microseconds > observed && !latency_histogram::m_max.compare_exchange_weak(observed, microseconds, std::memory_order_relaxed))
+    {
+    }
+}
+uint64_t latency_histogram::percentile(double percentile) const
+{
+    // Determine the rank of the requested percentile.
+    uint64_t count = latency_histogram::m_count.load(std::memory_order_relaxed);
+    if(count == 0)
+    {
+        return 0;
+    }
+    if(percentile < 0)
+    {
+        percentile = 0;
+    }
+    else if(percentile > 100)
+    {
+        percentile = 100;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    if(rank == 0)
+    {
+        rank = 1;
+    }
+
+    // Walk buckets until the rank is reached.
+    uint64_t cumulative = 0;
+    for(uint32_t i = 0; i < latency_histogram::m_n_buckets; i++)
+    {
+        cumulative += latency_histogram::m_buckets[i].load(std::memory_order_relaxed);
+        if(cumulative >= rank)
+        {
+            // Never report beyond the largest value actually seen.
+            uint64_t value = latency_histogram::bucket_value(i);
+            uint64_t max = latency_histogram::m_max.load(std::memory_order_relaxed);
+            return value < max ? value : max;
+        }
+    }
+
+    // Buckets were updated while walking; fall back to the maximum.
+    return latency_histogram::m_max.load(std::memory_order_relaxed);
+}
+void latency_histogram::reset()
+{
+    for(uint32_t i = 0; i < latency_histogram::m_n_buckets; i++)
+    {
+        latency_histogram::m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    latency_histogram::m_count.store(0, std::memory_order_relaxed);
+    latency_histogram::m_sum.store(0, std::memory_order_relaxed);
+    latency_histogram::m_max.store(0, std::memory_order_relaxed);
+}
+
+// PROPERTIES
+uint64_t latency_histogram::p_count() const
+{
+    return latency_histogram::m_count.load(std::memory_order_relaxed);
+}
+double latency_histogram::p_mean() const
+{
+    uint64_t count = latency_histogram::m_count.load(std::memory_order_relaxed);
+    if(count == 0)
+    {
+        return 0;
+    }
+    return static_cast<double>(latency_histogram::m_sum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+}
+uint64_t latency_histogram::p_max() const
+{
+    return latency_histogram::m_max.load(std::memory_order_relaxed);
+}
+
+// PRIVATE METHODS
+uint32_t latency_histogram::bucket_index(uint64_t value)
+{
+    // Values below the first power of two with sub-buckets map directly.
+    const uint64_t n_sub_buckets = 1ULL << latency_histogram::m_sub_bucket_bits;
+    if(value < n_sub_buckets)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    // Find the power of two, then the linear sub-bucket within it.
+    // NOTE: value is nonzero here, so the highest set bit is defined.
+    uint32_t magnitude = highest_bit(value);
+    uint32_t sub_bucket = static_cast<uint32_t>(value >> (magnitude - latency_histogram::m_sub_bucket_bits)) & (n_sub_buckets - 1);
+    return ((magnitude - latency_histogram::m_sub_bucket_bits + 1) << latency_histogram::m_sub_bucket_bits) + sub_bucket;
+}
+uint64_t latency_histogram::bucket_value(uint32_t index)
+{
+    // Direct buckets hold exactly one value.
+    const uint32_t n_sub_buckets = 1U << latency_histogram::m_sub_bucket_bits;
+    if(index < n_sub_buckets)
+    {
+        return index;
+    }
+
+    // Reconstruct the bucket's lower bound and width, then report its midpoint.
+    uint32_t magnitude = (index >> latency_histogram::m_sub_bucket_bits) + latency_histogram::m_sub_bucket_bits - 1;
+    uint64_t sub_bucket = index & (n_sub_buckets - 1);
+    uint32_t shift = magnitude - latency_histogram::m_sub_bucket_bits;
+    uint64_t lower = (static_cast<uint64_t>(n_sub_buckets) | sub_bucket) << shift;
+    return lower + ((1ULL << shift) >> 1);
+}
@@ -0,0 +1,90 @@
+#include "pcd/qt-serial_communicator/utility/latency_recorder.h"
+
+using namespace serial_communicator;
+using namespace serial_communicator::utility;
+
+// CONSTRUCTORS
+latency_recorder::latency_recorder()
+{
+    for(int m = 0; m < latency_recorder::m_n_metrics; m++)
+    {
+        for(int p = 0; p < 256; p++)
+        {
+            latency_recorder::m_priorities[m][p].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    latency_recorder::m_track_ids.store(false, std::memory_order_relaxed);
+}
+latency_recorder::~latency_recorder()
+{
+    // Clean up lazily allocated histograms.
+    for(int m = 0; m < latency_recorder::m_n_metrics; m++)
+    {
+        for(int p = 0; p < 256; p++)
+        {
+            delete latency_recorder::m_priorities[m][p].load(std::memory_order_relaxed);
+        }
+        for(auto entry = latency_recorder::m_ids[m].begin(); entry != latency_recorder::m_ids[m].end(); ++entry)
+        {
+            delete entry->second;
+        }
+    }
+}
+
+// METHODS
+void latency_recorder::record(latency_metric metric, uint8_t priority, uint16_t id, uint64_t microseconds)
+{
+    int m = static_cast<int>(metric);
+
+    // Record against the metric total.
+    latency_recorder::m_totals[m].record(microseconds);
+
+    // Record against the priority, allocating its histogram on first use.
+    latency_histogram* by_priority = latency_recorder::m_priorities[m][priority].load(std::memory_order_acquire);
+    if(by_priority == nullptr)
+    {
+        by_priority = new latency_histogram();
+        latency_recorder::m_priorities[m][priority].store(by_priority, std::memory_order_release);
+    }
+    by_priority->record(microseconds);
+
+    // Record against the ID if enabled.
+    if(latency_recorder::m_track_ids.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(latency_recorder::m_ids_mutex);
+        latency_histogram*& by_id = latency_recorder::m_ids[m][id];
+        if(by_id == nullptr)
+        {
+            by_id = new latency_histogram();
+        }
+        by_id->record(microseconds);
+    }
+}
+const latency_histogram* latency_recorder::histogram(latency_metric metric) const
+{
+    return &latency_recorder::m_totals[static_cast<int>(metric)];
+}
+const latency_histogram* latency_recorder::histogram_by_priority(latency_metric metric, uint8_t priority) const
+{
+    return latency_recorder::m_priorities[static_cast<int>(metric)][priority].load(std::memory_order_acquire);
+}
+const latency_histogram* latency_recorder::histogram_by_id(latency_metric metric, uint16_t id) const
+{
+    std::lock_guard<std::mutex> lock(latency_recorder::m_ids_mutex);
+    auto entry = latency_recorder::m_ids[static_cast<int>(metric)].find(id);
+    if(entry == latency_recorder::m_ids[static_cast<int>(metric)].end())
+    {
+        return nullptr;
+    }
+    return entry->second;
+}
+
+// PROPERTIES
+bool latency_recorder::p_track_ids() const
+{
+    return latency_recorder::m_track_ids.load(std::memory_order_relaxed);
+}
+void latency_recorder::p_track_ids(bool value)
+{
+    latency_recorder::m_track_ids.store(value, std::memory_order_relaxed);
+}
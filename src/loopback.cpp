@@ -0,0 +1,32 @@
+#include "pcd/qt-serial_communicator/loopback.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+loopback::loopback()
+{
+    // Create both ends and connect them to each other.
+    loopback::m_a = new utility::loopback_device();
+    loopback::m_b = new utility::loopback_device();
+    loopback::m_a->connect_peer(loopback::m_b);
+    loopback::m_b->connect_peer(loopback::m_a);
+
+    // Open both ends.
+    loopback::m_a->open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    loopback::m_b->open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+loopback::~loopback()
+{
+    delete loopback::m_a;
+    delete loopback::m_b;
+}
+
+// PROPERTIES
+QIODevice* loopback::p_a() const
+{
+    return loopback::m_a;
+}
+QIODevice* loopback::p_b() const
+{
+    return loopback::m_b;
+}
@@ -0,0 +1,95 @@
+#include "pcd/qt-serial_communicator/utility/loopback_device.h"
+
+#include <cstring>
+
+using namespace serial_communicator::utility;
+
+// CONSTRUCTORS
+loopback_device::loopback_device(QObject* parent)
+    : QIODevice(parent)
+{
+    loopback_device::m_peer = nullptr;
+    loopback_device::m_read_offset = 0;
+    loopback_device::m_available = 0;
+    loopback_device::m_notify_pending = false;
+}
+
+// METHODS
+void loopback_device::connect_peer(loopback_device* peer)
+{
+    loopback_device::m_peer = peer;
+}
+void loopback_device::deliver(const QByteArray& chunk)
+{
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(loopback_device::m_mutex);
+        loopback_device::m_chunks.push_back(chunk);
+        loopback_device::m_available += chunk.size();
+        // Only one notification is needed for any number of chunks delivered before it runs.
+        schedule = !loopback_device::m_notify_pending;
+        loopback_device::m_notify_pending = true;
+    }
+    if(schedule)
+    {
+        QMetaObject::invokeMethod(this, "notify", Qt::QueuedConnection);
+    }
+}
+
+// QIODEVICE OVERRIDES
+bool loopback_device::isSequential() const
+{
+    return true;
+}
+qint64 loopback_device::bytesAvailable() const
+{
+    std::lock_guard<std::mutex> lock(loopback_device::m_mutex);
+    return loopback_device::m_available + QIODevice::bytesAvailable();
+}
+bool loopback_device::waitForBytesWritten(int msecs)
+{
+    // Writes are handed to the peer immediately, so there is never anything left to wait for.
+    Q_UNUSED(msecs);
+    return true;
+}
+qint64 loopback_device::readData(char* data, qint64 max_length)
+{
+    std::lock_guard<std::mutex> lock(loopback_device::m_mutex);
+
+    // Copy out of as many chunks as needed, releasing each chunk once it is fully read.
+    qint64 n_read = 0;
+    while(n_read < max_length && !loopback_device::m_chunks.empty())
+    {
+        const QByteArray& front = loopback_device::m_chunks.front();
+        qint64 n_copy = qMin(max_length - n_read, static_cast<qint64>(front.size() - loopback_device::m_read_offset));
+        std::memcpy(data + n_read, front.constData() + loopback_device::m_read_offset, static_cast<size_t>(n_copy));
+        n_read += n_copy;
+        loopback_device::m_read_offset += static_cast<int>(n_copy);
+        if(loopback_device::m_read_offset == front.size())
+        {
+            loopback_device::m_chunks.pop_front();
+            loopback_device::m_read_offset = 0;
+        }
+    }
+    loopback_device::m_available -= n_read;
+    return n_read;
+}
+qint64 loopback_device::writeData(const char* data, qint64 length)
+{
+    // Hand the bytes to the peer as one chunk, or discard them if there is no peer.
+    if(loopback_device::m_peer)
+    {
+        loopback_device::m_peer->deliver(QByteArray(data, static_cast<int>(length)));
+    }
+    return length;
+}
+
+// PRIVATE SLOTS
+void loopback_device::notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(loopback_device::m_mutex);
+        loopback_device::m_notify_pending = false;
+    }
+    emit readyRead();
+}
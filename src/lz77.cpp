@@ -0,0 +1,201 @@
+#include "pcd/qt-serial_communicator/utility/lz77.h"
+
+#include <cstring>
+
+namespace {
+// CONSTANTS
+const uint32_t min_match = 4;
+const uint32_t hash_bits = 12;
+const uint32_t max_offset = 0xFFFF;
+
+uint32_t hash(const uint8_t* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, 4);
+    return (value * 2654435761U) >> (32 - hash_bits);
+}
+bool write_length(uint8_t*& output, const uint8_t* end, uint32_t length)
+{
+    // Write the part of a length beyond the token's nibble as a run of 255s and a remainder.
+    while(length >= 255)
+    {
+        if(output >= end)
+        {
+            return false;
+        }
+        *output++ = 255;
+        length -= 255;
+    }
+    if(output >= end)
+    {
+        return false;
+    }
+    *output++ = static_cast<uint8_t>(length);
+    return true;
+}
+bool write_sequence(uint8_t*& output, const uint8_t* end, const uint8_t* literals, uint32_t n_literals, uint32_t offset, uint32_t match_length)
+{
+    // Write the token.
+    if(output >= end)
+    {
+        return false;
+    }
+    uint8_t* token = output++;
+    *token = static_cast<uint8_t>((n_literals >= 15 ? 15 : n_literals) << 4);
+    if(n_literals >= 15 && !write_length(output, end, n_literals - 15))
+    {
+        return false;
+    }
+
+    // Write the literals.
+    if(static_cast<uint32_t>(end - output) < n_literals)
+    {
+        return false;
+    }
+    if(n_literals > 0)
+    {
+        std::memcpy(output, literals, n_literals);
+        output += n_literals;
+    }
+
+    // Write the match, if this is not the final sequence.
+    if(match_length > 0)
+    {
+        if(end - output < 2)
+        {
+            return false;
+        }
+        *output++ = static_cast<uint8_t>(offset);
+        *output++ = static_cast<uint8_t>(offset >> 8);
+        uint32_t extra = match_length - min_match;
+        *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+        if(extra >= 15 && !write_length(output, end, extra - 15))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+bool read_length(const uint8_t*& input, const uint8_t* end, uint32_t& length)
+{
+    // Accumulate extension bytes until one below 255 is read.
+    uint8_t byte;
+    do
+    {
+        if(input >= end)
+        {
+            return false;
+        }
+        byte = *input++;
+        length += byte;
+    } while(byte == 255);
+    return true;
+}
+}
+
+uint32_t serial_communicator::utility::lz77_compress(const uint8_t* source, uint32_t length, uint8_t* destination, uint32_t capacity)
+{
+    uint32_t table[1 << hash_bits];
+    std::memset(table, 0xFF, sizeof(table));
+
+    uint8_t* output = destination;
+    const uint8_t* end = destination + capacity;
+    uint32_t anchor = 0;
+    uint32_t position = 0;
+
+    // Search for matches while at least one full match fits before the end.
+    while(length >= min_match && position <= length - min_match)
+    {
+        // Look up the most recent position with the same 4 byte hash.
+        uint32_t slot = hash(source + position);
+        uint32_t candidate = table[slot];
+        table[slot] = position;
+        if(candidate == 0xFFFFFFFF || position - candidate > max_offset || std::memcmp(source + candidate, source + position, min_match) != 0)
+        {
+            position++;
+            continue;
+        }
+
+        // Extend the match as far as it goes.
+        uint32_t match_length = min_match;
+        while(position + match_length < length && source[candidate + match_length] == source[position + match_length])
+        {
+            match_length++;
+        }
+
+        // Emit the literals since the last match, followed by the match.
+        if(!write_sequence(output, end, source + anchor, position - anchor, position - candidate, match_length))
+        {
+            return 0;
+        }
+        position += match_length;
+        anchor = position;
+    }
+
+    // Emit the remaining literals as the final sequence.
+    if(!write_sequence(output, end, source + anchor, length - anchor, 0, 0))
+    {
+        return 0;
+    }
+    return static_cast<uint32_t>(output - destination);
+}
+int64_t serial_communicator::utility::lz77_decompress(const uint8_t* source, uint32_t length, uint8_t* destination, uint32_t capacity)
+{
+    const uint8_t* input = source;
+    const uint8_t* input_end = source + length;
+    uint32_t written = 0;
+
+    while(input < input_end)
+    {
+        // Read the token and literal length.
+        uint8_t token = *input++;
+        uint32_t n_literals = token >> 4;
+        if(n_literals == 15 && !read_length(input, input_end, n_literals))
+        {
+            return -1;
+        }
+
+        // Copy the literals.
+        if(static_cast<uint32_t>(input_end - input) < n_literals || capacity - written < n_literals)
+        {
+            return -1;
+        }
+        std::memcpy(destination + written, input, n_literals);
+        input += n_literals;
+        written += n_literals;
+
+        // The final sequence ends after its literals.
+        if(input == input_end)
+        {
+            break;
+        }
+
+        // Read the match offset and length.
+        if(input_end - input < 2)
+        {
+            return -1;
+        }
+        uint32_t offset = static_cast<uint32_t>(input[0]) | (static_cast<uint32_t>(input[1]) << 8);
+        input += 2;
+        uint32_t match_length = token & 0x0F;
+        if(match_length == 15 && !read_length(input, input_end, match_length))
+        {
+            return -1;
+        }
+        match_length += min_match;
+
+        // Copy the match byte by byte, since it may overlap the bytes it produces.
+        if(offset == 0 || offset > written || capacity - written < match_length)
+        {
+            return -1;
+        }
+        const uint8_t* match = destination + written - offset;
+        for(uint32_t i = 0; i < match_length; i++)
+        {
+            destination[written + i] = match[i];
+        }
+        written += match_length;
+    }
+
+    return written;
+}
@@ -1,6 +1,7 @@
 #include "pcd/qt-serial_communicator/message.h"
+#include "pcd/qt-serial_communicator/utility/byte_order.h"
+#include "pcd/qt-serial_communicator/utility/byte_swap.h"
 
-#include <QtEndian>
 #include <cstring>
 
 using namespace serial_communicator;
@@ -10,6 +11,8 @@ message::message(uint16_t id)
 {
     message::m_id = id;
     message::m_priority = 0;
+    message::m_channel = 0;
+    message::m_receive_timestamp = std::chrono::steady_clock::time_point();
     message::m_data_length = 0;
     message::m_data = nullptr;
 }
@@ -17,6 +20,8 @@ message::message(uint16_t id, uint16_t data_length)
 {
     message::m_id = id;
     message::m_priority = 0;
+    message::m_channel = 0;
+    message::m_receive_timestamp = std::chrono::steady_clock::time_point();
     message::m_data_length = data_length;
     message::m_data = new uint8_t[data_length];
 }
@@ -24,11 +29,14 @@ message::message(const uint8_t* byte_array)
 {
     // Deserialize the message from the byte array.
     // Read the ID.
-    message::m_id = qFromBigEndian(*reinterpret_cast<const uint16_t*>(&byte_array[0]));
+    message::m_id = utility::load_big_endian<uint16_t>(&byte_array[0]);
     // Read the priority.
     message::m_priority = byte_array[2];
+    // The channel is carried outside of the serialized message.
+    message::m_channel = 0;
+    message::m_receive_timestamp = std::chrono::steady_clock::time_point();
     // Read the data length.
-    message::m_data_length = qFromBigEndian(*reinterpret_cast<const uint16_t*>(&byte_array[3]));
+    message::m_data_length = utility::load_big_endian<uint16_t>(&byte_array[3]);
     // Read the data.
     message::m_data = new uint8_t[message::m_data_length];
     std::memcpy(message::m_data, &byte_array[5], message::m_data_length);
@@ -70,20 +78,17 @@ void message::set_field(uint16_t address, uint32_t size, void *data)
     }
     case 2:
     {
-        uint16_t value = qToBigEndian(*static_cast<uint16_t*>(data));
-        std::memcpy(&message::m_data[address], & value, 2);
+        utility::store_big_endian(&message::m_data[address], *static_cast<uint16_t*>(data));
         break;
     }
     case 4:
     {
-        uint32_t value = qToBigEndian(*static_cast<uint32_t*>(data));
-        std::memcpy(&message::m_data[address], & value, 4);
+        utility::store_big_endian(&message::m_data[address], *static_cast<uint32_t*>(data));
         break;
     }
     case 8:
     {
-        uint64_t value = qToBigEndian(*static_cast<quint64*>(data));
-        std::memcpy(&message::m_data[address], & value, 8);
+        utility::store_big_endian(&message::m_data[address], *static_cast<uint64_t*>(data));
         break;
     }
     }
@@ -107,6 +112,38 @@ template int64_t message::get_field<int64_t>(uint16_t address) const;
 template float message::get_field<float>(uint16_t address) const;
 template double message::get_field<double>(uint16_t address) const;
 
+template <typename T>
+void message::set_field(uint16_t address, const T* data, uint16_t count)
+{
+    utility::copy_big_endian(&message::m_data[address], reinterpret_cast<const uint8_t*>(data), sizeof(T), count);
+}
+template void message::set_field<uint8_t>(uint16_t address, const uint8_t* data, uint16_t count);
+template void message::set_field<int8_t>(uint16_t address, const int8_t* data, uint16_t count);
+template void message::set_field<uint16_t>(uint16_t address, const uint16_t* data, uint16_t count);
+template void message::set_field<int16_t>(uint16_t address, const int16_t* data, uint16_t count);
+template void message::set_field<uint32_t>(uint16_t address, const uint32_t* data, uint16_t count);
+template void message::set_field<int32_t>(uint16_t address, const int32_t* data, uint16_t count);
+template void message::set_field<uint64_t>(uint16_t address, const uint64_t* data, uint16_t count);
+template void message::set_field<int64_t>(uint16_t address, const int64_t* data, uint16_t count);
+template void message::set_field<float>(uint16_t address, const float* data, uint16_t count);
+template void message::set_field<double>(uint16_t address, const double* data, uint16_t count);
+
+template <typename T>
+void message::get_field(uint16_t address, T* data, uint16_t count) const
+{
+    utility::copy_big_endian(reinterpret_cast<uint8_t*>(data), &message::m_data[address], sizeof(T), count);
+}
+template void message::get_field<uint8_t>(uint16_t address, uint8_t* data, uint16_t count) const;
+template void message::get_field<int8_t>(uint16_t address, int8_t* data, uint16_t count) const;
+template void message::get_field<uint16_t>(uint16_t address, uint16_t* data, uint16_t count) const;
+template void message::get_field<int16_t>(uint16_t address, int16_t* data, uint16_t count) const;
+template void message::get_field<uint32_t>(uint16_t address, uint32_t* data, uint16_t count) const;
+template void message::get_field<int32_t>(uint16_t address, int32_t* data, uint16_t count) const;
+template void message::get_field<uint64_t>(uint16_t address, uint64_t* data, uint16_t count) const;
+template void message::get_field<int64_t>(uint16_t address, int64_t* data, uint16_t count) const;
+template void message::get_field<float>(uint16_t address, float* data, uint16_t count) const;
+template void message::get_field<double>(uint16_t address, double* data, uint16_t count) const;
+
 void message::get_field(uint16_t address, uint32_t size, void *data) const
 {
     switch(size)
@@ -118,19 +155,19 @@ void message::get_field(uint16_t address, uint32_t size, void *data) const
     }
     case 2:
     {
-        uint16_t value = qFromBigEndian(*reinterpret_cast<uint16_t*>(&message::m_data[address]));
+        uint16_t value = utility::load_big_endian<uint16_t>(&message::m_data[address]);
         std::memcpy(data, &value, 2);
         break;
     }
     case 4:
     {
-        uint32_t value = qFromBigEndian(*reinterpret_cast<uint32_t*>(&message::m_data[address]));
+        uint32_t value = utility::load_big_endian<uint32_t>(&message::m_data[address]);
         std::memcpy(data, &value, 4);
         break;
     }
     case 8:
     {
-        uint64_t value = qFromBigEndian(*reinterpret_cast<quint64*>(&message::m_data[address]));
+        uint64_t value = utility::load_big_endian<uint64_t>(&message::m_data[address]);
         std::memcpy(data, &value, 8);
         break;
     }
@@ -140,13 +177,11 @@ void message::get_field(uint16_t address, uint32_t size, void *data) const
 void message::serialize(uint8_t *byte_array) const
 {
     // Serialize the ID first.
-    uint16_t be_id = qToBigEndian(message::m_id);
-    std::memcpy(&byte_array[0], &be_id, 2);
+    utility::store_big_endian(&byte_array[0], message::m_id);
     // Serialize priority.
     byte_array[2] = message::m_priority;
     // Serialize data length.
-    uint16_t be_data_length = qToBigEndian(message::m_data_length);
-    std::memcpy(&byte_array[3], &be_data_length, 2);
+    utility::store_big_endian(&byte_array[3], message::m_data_length);
     // Copy in data, as it is already guaranteed big endian.
     std::memcpy(&byte_array[5], message::m_data, message::m_data_length);
 }
@@ -161,6 +196,26 @@ uint8_t message::p_priority() const
 {
     return message::m_priority;
 }
+void message::p_priority(uint8_t value)
+{
+    message::m_priority = value;
+}
+uint8_t message::p_channel() const
+{
+    return message::m_channel;
+}
+void message::p_channel(uint8_t value)
+{
+    message::m_channel = value;
+}
+std::chrono::steady_clock::time_point message::p_receive_timestamp() const
+{
+    return message::m_receive_timestamp;
+}
+void message::p_receive_timestamp(std::chrono::steady_clock::time_point value)
+{
+    message::m_receive_timestamp = value;
+}
 uint16_t message::p_data_length() const
 {
     return message::m_data_length;
@@ -169,3 +224,11 @@ uint32_t message::p_message_length() const
 {
     return message::m_data_length + 5;
 }
+uint8_t* message::p_data()
+{
+    return message::m_data;
+}
+const uint8_t* message::p_data() const
+{
+    return message::m_data;
+}
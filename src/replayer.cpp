@@ -0,0 +1,85 @@
+#include "pcd/qt-serial_communicator/replayer.h"
+#include "pcd/qt-serial_communicator/capture_reader.h"
+#include "pcd/qt-serial_communicator/communicator.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+replayer::replayer(communicator* communicator)
+{
+    replayer::m_communicator = communicator;
+    replayer::m_bytes = 0;
+    replayer::m_messages = 0;
+    replayer::m_elapsed = 0;
+}
+
+// METHODS
+bool replayer::run(const std::string& path, bool realtime, capture::direction direction)
+{
+    // Reset results.
+    replayer::m_bytes = 0;
+    replayer::m_messages = 0;
+    replayer::m_elapsed = 0;
+
+    // Open the capture.
+    capture_reader reader(path);
+    if(!reader.p_is_open())
+    {
+        return false;
+    }
+
+    // Feed each record of the requested direction into the parser.
+    communicator::clock::time_point start = communicator::clock::now();
+    capture::direction record_direction;
+    uint64_t timestamp_ns;
+    std::vector<uint8_t> data;
+    while(reader.next(record_direction, timestamp_ns, data))
+    {
+        if(record_direction != direction)
+        {
+            continue;
+        }
+
+        // Wait until the record's original offset if reproducing timing.
+        if(realtime)
+        {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestamp_ns));
+        }
+
+        // Hand the bytes to the parser, timestamped at their recorded offset, and consume everything it produces.
+        replayer::m_communicator->ingest(data.data(), static_cast<uint32_t>(data.size()), start + std::chrono::duration_cast<communicator::clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+        replayer::m_bytes += data.size();
+        replayer::drain();
+    }
+
+    replayer::m_elapsed = std::chrono::duration<double>(communicator::clock::now() - start).count();
+    return true;
+}
+
+// PROPERTIES
+uint64_t replayer::p_bytes() const
+{
+    return replayer::m_bytes;
+}
+uint64_t replayer::p_messages() const
+{
+    return replayer::m_messages;
+}
+double replayer::p_elapsed() const
+{
+    return replayer::m_elapsed;
+}
+
+// PRIVATE METHODS
+void replayer::drain()
+{
+    // Parse until no complete frame remains, emptying the receive queue as it fills.
+    while(replayer::m_communicator->spin_rx())
+    {
+        while(message* received = replayer::m_communicator->receive())
+        {
+            delete received;
+            replayer::m_messages++;
+        }
+    }
+}
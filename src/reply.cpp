@@ -0,0 +1,84 @@
+#include "pcd/qt-serial_communicator/reply.h"
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+reply::reply(uint32_t correlation)
+{
+    reply::m_correlation = correlation;
+    reply::m_status = reply_status::PENDING;
+    reply::m_response = nullptr;
+    reply::m_future = reply::m_promise.get_future().share();
+}
+reply::~reply()
+{
+    delete reply::m_response;
+}
+
+// METHODS
+reply_status reply::wait() const
+{
+    return reply::m_future.get();
+}
+message* reply::take()
+{
+    std::lock_guard<std::mutex> lock(reply::m_mutex);
+    message* response = reply::m_response;
+    reply::m_response = nullptr;
+    return response;
+}
+void reply::on_complete(std::function<void(reply_status)> callback)
+{
+    // Invoke immediately if already complete, otherwise hold until completion.
+    reply_status status;
+    {
+        std::lock_guard<std::mutex> lock(reply::m_mutex);
+        status = reply::m_status;
+        if(status == reply_status::PENDING)
+        {
+            reply::m_callbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(status);
+}
+void reply::complete(reply_status status, message* response)
+{
+    // Store the outcome and take the callbacks.
+    std::vector<std::function<void(reply_status)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(reply::m_mutex);
+        // A completed reply never changes.
+        if(reply::m_status != reply_status::PENDING)
+        {
+            delete response;
+            return;
+        }
+        reply::m_status = status;
+        reply::m_response = response;
+        callbacks.swap(reply::m_callbacks);
+    }
+
+    // Publish the outcome outside of the lock.
+    reply::m_promise.set_value(status);
+    for(auto& callback : callbacks)
+    {
+        callback(status);
+    }
+    emit completed(status);
+}
+
+// PROPERTIES
+uint32_t reply::p_correlation() const
+{
+    return reply::m_correlation;
+}
+reply_status reply::p_status() const
+{
+    std::lock_guard<std::mutex> lock(reply::m_mutex);
+    return reply::m_status;
+}
+std::shared_future<reply_status> reply::p_future() const
+{
+    return reply::m_future;
+}
@@ -0,0 +1,393 @@
+#include "pcd/qt-serial_communicator/spool.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <array>
+
+#if defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+using namespace serial_communicator;
+
+// CONSTRUCTORS
+spool::spool(const QString& path)
+    : m_file(path)
+{
+    // Initialize locals.
+    spool::m_data = nullptr;
+    spool::m_size = 0;
+    spool::m_end = 0;
+    spool::m_base = 0;
+    spool::m_n_waiting = 0;
+    spool::m_sync_on_append = false;
+    spool::m_max_size = 64 * 1024 * 1024;
+
+    // Open the file, giving a new file its initial size.
+    if(!spool::m_file.open(QIODevice::ReadWrite))
+    {
+        return;
+    }
+    spool::m_size = spool::m_file.size();
+    if(spool::m_size < spool::m_initial_size)
+    {
+        if(!spool::m_file.resize(spool::m_initial_size))
+        {
+            return;
+        }
+        spool::m_size = spool::m_initial_size;
+    }
+
+    // Map the file and recover pending records.
+    spool::m_data = spool::m_file.map(0, spool::m_size);
+    if(spool::m_data)
+    {
+        spool::recover();
+    }
+}
+spool::~spool()
+{
+    // Unmapping leaves the written records to the operating system.
+    if(spool::m_data)
+    {
+        spool::m_file.unmap(spool::m_data);
+    }
+    spool::m_file.close();
+}
+
+// METHODS
+uint64_t spool::append(const message& message, bool receipt_required, bool waiting)
+{
+    // Make room for the record and the terminator that follows it.
+    uint32_t message_length = message.p_message_length();
+    qint64 record_length = spool::m_prefix_length + message_length + 4;
+    if(!spool::m_data || !spool::reserve(record_length + 1))
+    {
+        return 0;
+    }
+
+    // Write marker(1), state(1), receipt flag(1), channel(1), length(4), message, and CRC(4).
+    uint64_t position = spool::m_base + static_cast<uint64_t>(spool::m_end);
+    uchar* record = &spool::m_data[spool::m_end];
+    record[0] = spool::m_marker;
+    record[1] = 1;
+    record[2] = receipt_required ? 1 : 0;
+    record[3] = message.p_channel();
+    qToBigEndian<quint32>(message_length, &record[4]);
+    message.serialize(&record[spool::m_prefix_length]);
+    qToBigEndian<quint32>(spool::crc32(&record[2], spool::m_prefix_length - 2 + message_length), &record[spool::m_prefix_length + message_length]);
+
+    // End the log after the record.
+    spool::m_end += record_length;
+    spool::m_data[spool::m_end] = 0;
+    spool::m_pending.insert(position);
+
+    // Queue the record if it waits in the spool.
+    if(waiting)
+    {
+        spool::wait(position);
+    }
+
+    if(spool::m_sync_on_append)
+    {
+        spool::sync();
+    }
+    return position + 1;
+}
+bool spool::peek(uint8_t channel, uint32_t& length) const
+{
+    if(!spool::m_data)
+    {
+        return false;
+    }
+    auto waiting = spool::m_waiting.find(channel);
+    if(waiting == spool::m_waiting.end())
+    {
+        return false;
+    }
+    const uchar* record = spool::record(waiting->second.begin()->second);
+    length = qFromBigEndian<quint32>(&record[4]);
+    return true;
+}
+message* spool::take(uint8_t channel, uint64_t& record, bool& receipt_required)
+{
+    if(!spool::m_data)
+    {
+        return nullptr;
+    }
+    auto waiting = spool::m_waiting.find(channel);
+    if(waiting == spool::m_waiting.end())
+    {
+        return nullptr;
+    }
+
+    // Take the channel's first waiting record, leaving it pending in the log.
+    uint64_t position = waiting->second.begin()->second;
+    waiting->second.erase(waiting->second.begin());
+    if(waiting->second.empty())
+    {
+        spool::m_waiting.erase(waiting);
+    }
+    spool::m_n_waiting--;
+    const uchar* bytes = spool::record(position);
+    message* output = new message(&bytes[spool::m_prefix_length]);
+    output->p_channel(bytes[3]);
+    receipt_required = bytes[2] & 1;
+    record = position + 1;
+    return output;
+}
+void spool::release(uint64_t record)
+{
+    // Records before the file's first byte were already released and dropped by compaction.
+    uint64_t position = record - 1;
+    if(!spool::m_data || record == 0 || spool::m_pending.erase(position) == 0)
+    {
+        return;
+    }
+
+    // Clear the record's state in place, and forget it if it was still waiting.
+    uchar* bytes = spool::record(position);
+    bytes[1] = 0;
+    auto waiting = spool::m_waiting.find(bytes[3]);
+    if(waiting != spool::m_waiting.end() && waiting->second.erase(std::make_pair(static_cast<uint8_t>(0xFF - bytes[spool::m_prefix_length + 2]), position)) > 0)
+    {
+        spool::m_n_waiting--;
+        if(waiting->second.empty())
+        {
+            spool::m_waiting.erase(waiting);
+        }
+    }
+
+    // Start the log over once nothing in it is pending.
+    if(spool::m_pending.empty())
+    {
+        spool::m_base += static_cast<uint64_t>(spool::m_end);
+        spool::m_end = 0;
+        spool::m_data[0] = 0;
+    }
+}
+void spool::sync()
+{
+    if(!spool::m_data)
+    {
+        return;
+    }
+#if defined(Q_OS_UNIX)
+    ::msync(spool::m_data, static_cast<size_t>(spool::m_size), MS_SYNC);
+#elif defined(Q_OS_WIN)
+    ::FlushViewOfFile(spool::m_data, static_cast<SIZE_T>(spool::m_size));
+#endif
+    spool::m_file.flush();
+}
+
+// PROPERTIES
+bool spool::p_is_open() const
+{
+    return spool::m_data != nullptr;
+}
+uint32_t spool::p_pending() const
+{
+    return static_cast<uint32_t>(spool::m_pending.size());
+}
+uint32_t spool::p_waiting() const
+{
+    return spool::m_n_waiting;
+}
+uint32_t spool::p_waiting(uint8_t channel) const
+{
+    auto waiting = spool::m_waiting.find(channel);
+    return waiting == spool::m_waiting.end() ? 0 : static_cast<uint32_t>(waiting->second.size());
+}
+bool spool::p_sync_on_append() const
+{
+    return spool::m_sync_on_append;
+}
+void spool::p_sync_on_append(bool value)
+{
+    spool::m_sync_on_append = value;
+}
+qint64 spool::p_max_size() const
+{
+    return spool::m_max_size;
+}
+void spool::p_max_size(qint64 value)
+{
+    spool::m_max_size = value;
+}
+
+// PRIVATE METHODS
+void spool::recover()
+{
+    // Walk the log until the terminator, the end of the file, or a damaged record.
+    qint64 offset = 0;
+    while(offset + spool::m_prefix_length <= spool::m_size && spool::m_data[offset] == spool::m_marker)
+    {
+        const uchar* record = &spool::m_data[offset];
+        uint32_t message_length = qFromBigEndian<quint32>(&record[4]);
+        qint64 record_length = spool::m_prefix_length + static_cast<qint64>(message_length) + 4;
+        if(message_length < 5 || offset + record_length > spool::m_size)
+        {
+            break;
+        }
+        uint32_t crc = qFromBigEndian<quint32>(&record[spool::m_prefix_length + message_length]);
+        if(crc != spool::crc32(&record[2], spool::m_prefix_length - 2 + message_length))
+        {
+            break;
+        }
+
+        // Every record that was not released waits to be sent again.
+        if(record[1] != 0)
+        {
+            spool::m_pending.insert(static_cast<uint64_t>(offset));
+            spool::wait(static_cast<uint64_t>(offset));
+        }
+        offset += record_length;
+    }
+    spool::m_end = offset;
+
+    // Start over if nothing is pending, and otherwise cut off anything after the last intact record.
+    if(spool::m_pending.empty())
+    {
+        spool::m_end = 0;
+    }
+    if(spool::m_end < spool::m_size)
+    {
+        spool::m_data[spool::m_end] = 0;
+    }
+}
+void spool::wait(uint64_t position)
+{
+    // Order the channel's records by highest priority, followed by oldest.
+    const uchar* record = spool::record(position);
+    spool::m_waiting[record[3]].insert(std::make_pair(static_cast<uint8_t>(0xFF - record[spool::m_prefix_length + 2]), position));
+    spool::m_n_waiting++;
+}
+bool spool::reserve(qint64 length)
+{
+    if(spool::m_end + length <= spool::m_size)
+    {
+        return true;
+    }
+
+    // Reclaim the released records at the front if they are at least half of the log, so that the copy pays for itself.
+    qint64 released = spool::m_pending.empty() ? 0 : static_cast<qint64>(*spool::m_pending.begin() - spool::m_base);
+    if(released > 0 && released >= spool::m_end / 2 && spool::compact() && spool::m_end + length <= spool::m_size)
+    {
+        return true;
+    }
+
+    // Otherwise double the file until the record fits, within the size limit, and map it again.
+    qint64 size = spool::m_size;
+    while(spool::m_end + length > size)
+    {
+        size *= 2;
+    }
+    if(spool::m_max_size > 0 && size > spool::m_max_size)
+    {
+        size = spool::m_max_size;
+        if(spool::m_end + length > size)
+        {
+            return false;
+        }
+    }
+    spool::m_file.unmap(spool::m_data);
+    spool::m_data = nullptr;
+    if(spool::m_file.resize(size))
+    {
+        spool::m_size = size;
+    }
+    spool::remap();
+    if(!spool::m_data)
+    {
+        spool::close();
+        return false;
+    }
+    return spool::m_end + length <= spool::m_size;
+}
+bool spool::compact()
+{
+    // Write the pending part of the log to a new file of the same size.
+    qint64 start = static_cast<qint64>(*spool::m_pending.begin() - spool::m_base);
+    qint64 length = spool::m_end - start;
+    QSaveFile output(spool::m_file.fileName());
+    if(!output.open(QIODevice::WriteOnly) ||
+       output.write(reinterpret_cast<const char*>(&spool::m_data[start]), length) != length ||
+       !output.resize(spool::m_size))
+    {
+        return false;
+    }
+
+    // Swap the new file in atomically, so that a crash leaves either the old or the new log intact.
+    spool::m_file.unmap(spool::m_data);
+    spool::m_data = nullptr;
+    spool::m_file.close();
+    bool committed = output.commit();
+    if(spool::m_file.open(QIODevice::ReadWrite))
+    {
+        spool::remap();
+    }
+    // Without a mapping the records can no longer be reached, so the spool closes.
+    if(!spool::m_data)
+    {
+        spool::close();
+        return false;
+    }
+    // A failed commit left the original file in place, which is mapped again unchanged.
+    if(!committed)
+    {
+        return false;
+    }
+
+    // Positions are unchanged, but now begin further into the file.
+    spool::m_base += static_cast<uint64_t>(start);
+    spool::m_end = length;
+    return true;
+}
+void spool::remap()
+{
+    spool::m_data = spool::m_file.map(0, spool::m_size);
+}
+void spool::close()
+{
+    // Forget every record, since none of them can be read or released any more.
+    if(spool::m_data)
+    {
+        spool::m_file.unmap(spool::m_data);
+        spool::m_data = nullptr;
+    }
+    spool::m_file.close();
+    spool::m_pending.clear();
+    spool::m_waiting.clear();
+    spool::m_n_waiting = 0;
+}
+uchar* spool::record(uint64_t position) const
+{
+    return &spool::m_data[position - spool::m_base];
+}
+uint32_t spool::crc32(const uint8_t* data, uint32_t length)
+{
+    // Build the lookup table for the reflected IEEE polynomial once.
+    static const std::array<uint32_t, 256> table = []()
+    {
+        std::array<uint32_t, 256> entries;
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t entry = i;
+            for(uint8_t bit = 0; bit < 8; bit++)
+            {
+                entry = (entry & 1) ? (entry >> 1) ^ 0xEDB88320 : entry >> 1;
+            }
+            entries[i] = entry;
+        }
+        return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for(uint32_t i = 0; i < length; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
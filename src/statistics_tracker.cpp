@@ -0,0 +1,110 @@
+#include "pcd/qt-serial_communicator/utility/statistics_tracker.h"
+
+using namespace serial_communicator;
+using namespace serial_communicator::utility;
+
+// CONSTRUCTORS
+statistics_tracker::statistics_tracker()
+{
+    // Zero all counters and gauges.
+    for(int i = 0; i < static_cast<int>(counter::COUNT); i++)
+    {
+        statistics_tracker::m_counters[i].store(0, std::memory_order_relaxed);
+    }
+    for(int i = 0; i < static_cast<int>(gauge::COUNT); i++)
+    {
+        statistics_tracker::m_gauges[i].store(0, std::memory_order_relaxed);
+    }
+    for(int i = 0; i < 4; i++)
+    {
+        statistics_tracker::m_rates[i].store(0, std::memory_order_relaxed);
+        statistics_tracker::m_sample_counters[i] = 0;
+    }
+
+    // Start the first rate interval.
+    statistics_tracker::m_sample_timestamp = std::chrono::steady_clock::now();
+}
+
+// METHODS
+void statistics_tracker::increment(counter counter, uint64_t amount)
+{
+    statistics_tracker::m_counters[static_cast<int>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+void statistics_tracker::high_water(gauge gauge, uint32_t level)
+{
+    // Raise the gauge only if the level exceeds it, retrying if another thread raced the update.
+    std::atomic<uint32_t>& current = statistics_tracker::m_gauges[static_cast<int>(gauge)];
+    uint32_t observed = current.load(std::memory_order_relaxed);
+    while(level > observed && !current.compare_exchange_weak(observed, level, std::memory_order_relaxed))
+    {
+    }
+}
+void statistics_tracker::sample()
+{
+    // Measure the length of the interval being closed.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - statistics_tracker::m_sample_timestamp).count();
+    if(elapsed <= 0)
+    {
+        return;
+    }
+
+    // Compute the rate of each sampled counter over the interval.
+    const counter sampled[4] = {counter::TX_FRAMES, counter::TX_BYTES, counter::RX_FRAMES, counter::RX_BYTES};
+    for(int i = 0; i < 4; i++)
+    {
+        uint64_t value = statistics_tracker::read(sampled[i]);
+        statistics_tracker::m_rates[i].store((value - statistics_tracker::m_sample_counters[i]) / elapsed, std::memory_order_relaxed);
+        statistics_tracker::m_sample_counters[i] = value;
+    }
+
+    // Start the next interval.
+    statistics_tracker::m_sample_timestamp = now;
+}
+statistics statistics_tracker::snapshot() const
+{
+    statistics output;
+
+    output.tx_frames = statistics_tracker::read(counter::TX_FRAMES);
+    output.tx_bytes = statistics_tracker::read(counter::TX_BYTES);
+    output.tx_escaped_bytes = statistics_tracker::read(counter::TX_ESCAPED_BYTES);
+    output.tx_retransmissions = statistics_tracker::read(counter::TX_RETRANSMISSIONS);
+    output.tx_rejected = statistics_tracker::read(counter::TX_REJECTED);
+    output.tx_not_received = statistics_tracker::read(counter::TX_NOT_RECEIVED);
+    output.tx_cancelled = statistics_tracker::read(counter::TX_CANCELLED);
+    output.tx_evicted = statistics_tracker::read(counter::TX_EVICTED);
+    output.tx_spooled = statistics_tracker::read(counter::TX_SPOOLED);
+    output.tx_compressed = statistics_tracker::read(counter::TX_COMPRESSED);
+    output.tx_compression_saved = statistics_tracker::read(counter::TX_COMPRESSION_SAVED);
+    output.tx_delta = statistics_tracker::read(counter::TX_DELTA);
+    output.tx_delta_saved = statistics_tracker::read(counter::TX_DELTA_SAVED);
+    output.tx_piggybacked_receipts = statistics_tracker::read(counter::TX_PIGGYBACKED_RECEIPTS);
+    output.tx_credit_stalls = statistics_tracker::read(counter::TX_CREDIT_STALLS);
+    output.tx_credit_updates = statistics_tracker::read(counter::TX_CREDIT_UPDATES);
+    output.tx_queue_high_water = statistics_tracker::m_gauges[static_cast<int>(gauge::TX_QUEUE)].load(std::memory_order_relaxed);
+    output.tx_frames_per_second = statistics_tracker::m_rates[0].load(std::memory_order_relaxed);
+    output.tx_bytes_per_second = statistics_tracker::m_rates[1].load(std::memory_order_relaxed);
+
+    output.rx_frames = statistics_tracker::read(counter::RX_FRAMES);
+    output.rx_bytes = statistics_tracker::read(counter::RX_BYTES);
+    output.rx_discarded_bytes = statistics_tracker::read(counter::RX_DISCARDED_BYTES);
+    output.rx_checksum_failures = statistics_tracker::read(counter::RX_CHECKSUM_FAILURES);
+    output.rx_header_failures = statistics_tracker::read(counter::RX_HEADER_FAILURES);
+    output.rx_oversize = statistics_tracker::read(counter::RX_OVERSIZE);
+    output.rx_truncated = statistics_tracker::read(counter::RX_TRUNCATED);
+    output.rx_dropped = statistics_tracker::read(counter::RX_DROPPED);
+    output.rx_evicted = statistics_tracker::read(counter::RX_EVICTED);
+    output.rx_decompression_failures = statistics_tracker::read(counter::RX_DECOMPRESSION_FAILURES);
+    output.rx_delta_misses = statistics_tracker::read(counter::RX_DELTA_MISSES);
+    output.rx_unmatched_responses = statistics_tracker::read(counter::RX_UNMATCHED_RESPONSES);
+    output.rx_filtered = statistics_tracker::read(counter::RX_FILTERED);
+    output.rx_queue_high_water = statistics_tracker::m_gauges[static_cast<int>(gauge::RX_QUEUE)].load(std::memory_order_relaxed);
+    output.rx_frames_per_second = statistics_tracker::m_rates[2].load(std::memory_order_relaxed);
+    output.rx_bytes_per_second = statistics_tracker::m_rates[3].load(std::memory_order_relaxed);
+
+    return output;
+}
+uint64_t statistics_tracker::read(counter counter) const
+{
+    return statistics_tracker::m_counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+QT -= core gui
+
+TEMPLATE = app
+TARGET = engine_harness
+CONFIG -= qt
+CONFIG += console
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD/../../include
+
+SOURCES += \
+    main.cpp \
+    ../../src/byte_swap.cpp \
+    ../../src/delta.cpp \
+    ../../src/delta_cache.cpp \
+    ../../src/latency_histogram.cpp \
+    ../../src/latency_recorder.cpp \
+    ../../src/lz77.cpp \
+    ../../src/message.cpp \
+    ../../src/statistics_tracker.cpp
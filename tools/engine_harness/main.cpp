@@ -0,0 +1,225 @@
+#include "pcd/qt-serial_communicator/utility/protocol_engine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace serial_communicator;
+
+///
+/// \brief A clock that only advances when the harness steps it.
+///
+struct manual_clock
+{
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<manual_clock> time_point;
+    static const bool is_steady = true;
+
+    ///
+    /// \brief now Gets the current manual time.
+    /// \return The current manual time.
+    ///
+    static time_point now()
+    {
+        return time_point(duration(manual_clock::m_now));
+    }
+    ///
+    /// \brief advance Steps the manual time forward.
+    /// \param milliseconds The number of milliseconds to step.
+    ///
+    static void advance(uint32_t milliseconds)
+    {
+        manual_clock::m_now += static_cast<rep>(milliseconds) * 1000000;
+    }
+
+    /// \brief m_now The current manual time in nanoseconds.
+    static rep m_now;
+};
+manual_clock::rep manual_clock::m_now = 1000000000;
+
+///
+/// \brief Connects an engine to an in-memory wire, and can drop whole writes to impair it.
+///
+struct wire_host
+{
+    ///
+    /// \brief wire_host Creates a new wire_host instance.
+    /// \param wire The bytes in flight to the peer.
+    ///
+    explicit wire_host(std::vector<uint8_t>* wire)
+        : wire(wire),
+          drops(0)
+    {
+    }
+
+    void write(const uint8_t* data, uint32_t length)
+    {
+        // Lose the write if drops are pending.
+        if(wire_host::drops > 0)
+        {
+            wire_host::drops--;
+            return;
+        }
+        wire_host::wire->insert(wire_host::wire->end(), data, data + length);
+    }
+    void wake(uint32_t)
+    {
+    }
+    void link_changed(const link_quality&)
+    {
+    }
+    void link_quality_updated(const link_quality&)
+    {
+    }
+    bool correlated(bool, uint32_t, const uint8_t*, uint8_t, bool, manual_clock::time_point)
+    {
+        return false;
+    }
+    void retired(uint32_t)
+    {
+    }
+    bool offloads() const
+    {
+        return false;
+    }
+    bool submit(std::function<void()>)
+    {
+        return false;
+    }
+    void decoded()
+    {
+    }
+
+    /// \brief wire The bytes in flight to the peer.
+    std::vector<uint8_t>* wire;
+    /// \brief drops The number of upcoming writes to lose.
+    uint32_t drops;
+};
+
+typedef utility::protocol_engine<wire_host, manual_clock> engine;
+
+///
+/// \brief Two engines wired back to back, stepped on the manual clock without an event loop.
+///
+struct engine_pair
+{
+    engine_pair()
+        : a(wire_host(&a_to_b)),
+          b(wire_host(&b_to_a))
+    {
+    }
+
+    ///
+    /// \brief step Advances the clock, polls both engines, and delivers the bytes in flight.
+    /// \param milliseconds The number of milliseconds to advance.
+    ///
+    void step(uint32_t milliseconds)
+    {
+        manual_clock::advance(milliseconds);
+        engine_pair::a.poll();
+        if(!engine_pair::a_to_b.empty())
+        {
+            engine_pair::b.ingest(engine_pair::a_to_b.data(), static_cast<uint32_t>(engine_pair::a_to_b.size()));
+            engine_pair::a_to_b.clear();
+        }
+        engine_pair::b.poll();
+        if(!engine_pair::b_to_a.empty())
+        {
+            engine_pair::a.ingest(engine_pair::b_to_a.data(), static_cast<uint32_t>(engine_pair::b_to_a.size()));
+            engine_pair::b_to_a.clear();
+        }
+    }
+    ///
+    /// \brief send Sends a message from a to b and steps until its receipt settles.
+    /// \param id The ID of the message.
+    /// \param value The value carried by the message.
+    /// \param received Stores TRUE if b took the message with the expected value.
+    /// \return The final status of the message.
+    ///
+    message_status send(uint16_t id, uint32_t value, bool& received)
+    {
+        message_status status = message_status::QUEUED;
+        message* outbound = new message(id, 4);
+        outbound->set_field(0, value);
+        received = false;
+        if(!engine_pair::a.enqueue(outbound, true, &status))
+        {
+            return status;
+        }
+
+        // Step for up to ten seconds of manual time.
+        for(uint32_t i = 0; i < 1000 && (status == message_status::QUEUED || status == message_status::VERIFYING || !received); i++)
+        {
+            engine_pair::step(10);
+            if(message* inbound = engine_pair::b.take(-1, id))
+            {
+                received = inbound->get_field<uint32_t>(0) == value;
+                delete inbound;
+            }
+        }
+        return status;
+    }
+
+    std::vector<uint8_t> a_to_b;
+    std::vector<uint8_t> b_to_a;
+    engine a;
+    engine b;
+};
+
+///
+/// \brief check Reports the outcome of one check.
+/// \param name The name of the check.
+/// \param passed TRUE if the check passed.
+/// \return TRUE if the check passed, otherwise FALSE.
+///
+bool check(const char* name, bool passed)
+{
+    std::printf("%-24s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+
+    // Round trip a message and its receipt.
+    {
+        engine_pair link;
+        bool received = false;
+        message_status status = link.send(1, 0x12345678, received);
+        passed &= check("receipt round trip", received && status == message_status::RECEIVED);
+    }
+
+    // Lose the first transmission so the receipt timeout resends it.
+    {
+        engine_pair link;
+        link.a.p_receipt_timeout(50);
+        link.a.p_host().drops = 1;
+        bool received = false;
+        message_status status = link.send(2, 42, received);
+        statistics statistics = link.a.p_statistics().snapshot();
+        passed &= check("retransmit", received && status == message_status::RECEIVED && statistics.tx_retransmissions > 0);
+    }
+
+    // Negotiate the header checksum, then send over the negotiated format.
+    {
+        engine_pair link;
+        link.a.p_header_checksum(true);
+        link.b.p_header_checksum(true);
+        link.a.p_negotiation(true);
+        link.b.p_negotiation(true);
+        for(uint32_t i = 0; i < 100 && !(link.a.p_negotiated() && link.b.p_negotiated()); i++)
+        {
+            link.step(10);
+        }
+        bool negotiated = link.a.p_negotiated() && link.b.p_negotiated() && link.a.uses(engine::feature::HEADER_CHECKSUM) && link.b.uses(engine::feature::HEADER_CHECKSUM);
+        bool received = false;
+        message_status status = link.send(3, 7, received);
+        passed &= check("negotiation", negotiated && received && status == message_status::RECEIVED);
+    }
+
+    return passed ? 0 : 1;
+}
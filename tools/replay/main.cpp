@@ -0,0 +1,65 @@
+#include "pcd/qt-serial_communicator/communicator.h"
+#include "pcd/qt-serial_communicator/replayer.h"
+#include "pcd/qt-serial_communicator/utility/loopback_device.h"
+
+#include <QCoreApplication>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace serial_communicator;
+
+int main(int argc, char** argv)
+{
+    QCoreApplication application(argc, argv);
+
+    // Parse arguments.
+    const char* path = nullptr;
+    bool realtime = false;
+    capture::direction direction = capture::direction::RX;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--realtime") == 0)
+        {
+            realtime = true;
+        }
+        else if(std::strcmp(argv[i], "--tx") == 0)
+        {
+            direction = capture::direction::TX;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if(path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s [--realtime] [--tx] <capture file>\n", argv[0]);
+        return 1;
+    }
+
+    // Replay the capture into a communicator whose receipts are written to an unconnected loopback device and discarded.
+    utility::loopback_device sink;
+    sink.open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    communicator communicator(&sink);
+    communicator.p_queue_size(256);
+    replayer replayer(&communicator);
+    if(!replayer.run(path, realtime, direction))
+    {
+        std::fprintf(stderr, "unable to read capture file %s\n", path);
+        return 1;
+    }
+
+    // Report results.
+    statistics statistics = communicator.p_statistics();
+    double elapsed = replayer.p_elapsed() > 0 ? replayer.p_elapsed() : 1e-9;
+    std::printf("bytes:              %llu\n", static_cast<unsigned long long>(replayer.p_bytes()));
+    std::printf("frames:             %llu\n", static_cast<unsigned long long>(statistics.rx_frames));
+    std::printf("messages:           %llu\n", static_cast<unsigned long long>(replayer.p_messages()));
+    std::printf("checksum failures:  %llu\n", static_cast<unsigned long long>(statistics.rx_checksum_failures));
+    std::printf("discarded bytes:    %llu\n", static_cast<unsigned long long>(statistics.rx_discarded_bytes));
+    std::printf("elapsed:            %.6f s\n", elapsed);
+    std::printf("throughput:         %.3f MB/s, %.0f frames/s\n", replayer.p_bytes() / elapsed / 1e6, statistics.rx_frames / elapsed);
+
+    return 0;
+}